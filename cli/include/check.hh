@@ -0,0 +1,99 @@
+// the work done on each level file: reading it in either format,
+// validating it as the game would (without loading its theme), and
+// optionally measuring, solving and converting it.
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "level.hh"
+#include "solver.hh"
+#include "types.hh"
+
+namespace fs = std::filesystem;
+
+using namespace sbokena::types;
+using sbokena::level::Format;
+using sbokena::level::RawLevel;
+
+namespace sbokena::cli::check {
+
+// the file extension of a format, dot included.
+const char *extension_of(Format format) noexcept;
+
+// what to do with every level.
+struct Options {
+  // measure the level, see `Stats`.
+  bool stats = false;
+  // run the solver on the level.
+  bool solve = false;
+  // the number of states the solver may visit.
+  usize budget = game::solver::NODE_BUDGET;
+  // write the level in this format, into `out`, see
+  // `converted_path`.
+  std::optional<Format> convert;
+  fs::path              out = ".";
+  // keep the level in the outcome, if it is valid.
+  bool keep = false;
+};
+
+// the size of a level.
+struct Stats {
+  // number of cells which aren't walls.
+  usize cells;
+  // number of boxes, unidirectional included.
+  usize boxes;
+  // number of portal pairs.
+  usize portals;
+  // number of doors.
+  usize doors;
+  // number of cells a box can't be pushed to a goal from, see
+  // `game::dead::dead_squares`.
+  usize dead;
+};
+
+// the result of checking a level file.
+struct Outcome {
+  fs::path path;
+  // why the level couldn't be read or played; empty if it can.
+  std::string error;
+  // set if asked for, and the level is valid.
+  std::optional<Stats>                stats;
+  std::optional<game::solver::Result> solution;
+  // the file the level was converted to, if asked for.
+  std::optional<fs::path> converted;
+  // the level, if asked to keep it and it is valid.
+  std::optional<RawLevel> level;
+
+  // whether the level is valid, and solvable if it was solved.
+  bool ok() const noexcept;
+};
+
+// reads a level file, in whichever format it is in.
+//
+// throws `std::runtime_error` if the file can't be opened or read.
+RawLevel read_level(const fs::path &path);
+
+// writes a level file in a format.
+//
+// throws `std::runtime_error` if the file can't be written.
+void write_level(
+  const fs::path &path, const RawLevel &level, Format format
+);
+
+// the file a level is converted into: its `name`, a relative path,
+// under `out`, with the extension of the format converted to.
+fs::path converted_path(const fs::path &name, const Options &options);
+
+// checks a level file, converting it into `converted_path(name)`.
+// never throws: failures are reported in the outcome.
+Outcome check(
+  const fs::path &path, const fs::path &name, const Options &options
+);
+
+// a line describing an outcome, without a trailing newline.
+std::string describe(const Outcome &outcome);
+
+} // namespace sbokena::cli::check
@@ -0,0 +1,27 @@
+// a minimal thread pool, for running the same work over many
+// inputs.
+
+#pragma once
+
+#include <functional>
+
+#include "types.hh"
+
+using namespace sbokena::types;
+
+namespace sbokena::cli::parallel {
+
+// the number of threads the machine runs at once, at least 1.
+usize hardware_threads() noexcept;
+
+// calls `fn(i)` for every `i` in `[0, count)`, over `threads`
+// threads, the calling one included.
+//
+// each thread takes the next index as soon as it is done with its
+// last, so inputs of uneven cost keep every thread busy. `fn` may be
+// called from several threads at once, and must not throw.
+void for_each_index(
+  usize count, usize threads, const std::function<void(usize)> &fn
+);
+
+} // namespace sbokena::cli::parallel
@@ -0,0 +1,162 @@
+#include "check.hh"
+
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "dead.hh"
+#include "level.hh"
+#include "loader.hh"
+#include "solver.hh"
+#include "state.hh"
+
+namespace solver = sbokena::game::solver;
+
+using sbokena::game::dead::dead_squares;
+using sbokena::game::state::State;
+using sbokena::loader::LevelData;
+
+namespace sbokena::cli::check {
+
+const char *extension_of(Format format) noexcept {
+  switch (format) {
+  case Format::Json:
+    return ".sbk";
+  case Format::Cbor:
+    break;
+  }
+  return ".sbkb";
+}
+
+bool Outcome::ok() const noexcept {
+  return error.empty()
+      && (!solution
+          || solution->verdict == solver::Verdict::Solvable);
+}
+
+RawLevel read_level(const fs::path &path) {
+  std::ifstream in {path, std::ios::binary};
+  if (!in)
+    throw std::runtime_error("can't open file");
+  // a level is a JSON object or a CBOR map, and a CBOR map never
+  // starts with `{` or whitespace.
+  in >> std::ws;
+  if (in.peek() == '{')
+    return level::read_json(in);
+  return level::read_cbor(in);
+}
+
+void write_level(
+  const fs::path &path, const RawLevel &level, Format format
+) {
+  std::ofstream out {path, std::ios::binary};
+  if (!out)
+    throw std::runtime_error(
+      std::format("can't write {}", path.string())
+    );
+  switch (format) {
+  case Format::Json:
+    level::write_json(out, level);
+    break;
+  case Format::Cbor:
+    level::write_cbor(out, level);
+    break;
+  }
+  if (!out.flush())
+    throw std::runtime_error(
+      std::format("can't write {}", path.string())
+    );
+}
+
+fs::path
+converted_path(const fs::path &name, const Options &options) {
+  fs::path to = options.out / name;
+  to.replace_extension(extension_of(options.convert.value()));
+  return to;
+}
+
+Outcome check(
+  const fs::path &path, const fs::path &name, const Options &options
+) {
+  Outcome out;
+  out.path = path;
+  // every step may throw, and the first failure is the one reported.
+  try {
+    RawLevel raw = read_level(path);
+
+    if (options.convert) {
+      const fs::path to = converted_path(name, options);
+      write_level(to, raw, *options.convert);
+      out.converted = to;
+    }
+
+    std::optional<State> state;
+    state.emplace(LevelData {raw});
+
+    if (options.stats) {
+      Stats stats {
+        .cells   = raw.tiles.size(),
+        .boxes   = 0,
+        .portals = state->inner().portals.size(),
+        .doors   = 0,
+        .dead    = dead_squares(state->inner()).size(),
+      };
+      for (const auto &[_, object] : raw.objects)
+        stats.boxes += !std::holds_alternative<level::Player>(object);
+      for (const auto &[_, tile] : raw.tiles)
+        stats.doors += std::holds_alternative<level::Door>(tile);
+      out.stats = stats;
+    }
+
+    if (options.solve)
+      out.solution = solver::solve(state->inner(), options.budget);
+
+    if (options.keep)
+      out.level = std::move(raw);
+  } catch (const std::exception &ex) {
+    out.error = ex.what();
+  }
+  return out;
+}
+
+std::string describe(const Outcome &outcome) {
+  std::string line = outcome.path.string();
+  if (!outcome.error.empty())
+    return line + ": invalid: " + outcome.error;
+
+  line += ": ok";
+  if (const auto &s = outcome.stats)
+    line += std::format(
+      ", {} cells, {} boxes, {} portals, {} doors, {} dead",
+      s->cells,
+      s->boxes,
+      s->portals,
+      s->doors,
+      s->dead
+    );
+  if (const auto &res = outcome.solution) {
+    switch (res->verdict) {
+    case solver::Verdict::Solvable:
+      line += std::format(", solvable in {} moves", res->moves);
+      break;
+    case solver::Verdict::Unsolvable:
+      line += ", unsolvable";
+      break;
+    case solver::Verdict::Unknown:
+      line += std::format(", unknown after {} states", res->nodes);
+      break;
+    }
+  }
+  if (outcome.converted)
+    line += ", written to " + outcome.converted->string();
+  return line;
+}
+
+} // namespace sbokena::cli::check
@@ -0,0 +1,254 @@
+// sbokena's command line tool, for checking levels without a window
+// (in CI, for example).
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "check.hh"
+#include "pack.hh"
+#include "parallel.hh"
+#include "types.hh"
+
+namespace fs = std::filesystem;
+
+using namespace sbokena::types;
+using namespace sbokena::cli::check;
+using sbokena::level::RawLevel;
+using sbokena::cli::parallel::for_each_index;
+using sbokena::cli::parallel::hardware_threads;
+
+namespace {
+
+constexpr std::string_view USAGE =
+  R"(usage: sbokena <command> [options] <file or directory>...
+
+commands:
+  validate  check that every level can be played
+  solve     also solve every level
+  stats     also measure every level
+  convert   also write every level in another format
+  pack      also write every level into a single pack file
+
+options:
+  -j, --jobs <n>     threads to use (default: one per core)
+  --budget <n>       states the solver may visit per level
+  --solve            also solve, with `stats`, `convert` or `pack`
+  --to <json|cbor>   format to convert or pack to (default: cbor)
+  -o, --out <path>   directory to convert into (default: .), or
+                     pack file to write
+
+directories are searched for level files (.sbk, .sbkb), which are
+converted to the same path under --out as they have under the
+directory.
+exits with 1 if any level is invalid or unsolvable; a pack is only
+written if none is.
+)";
+
+// a command line error.
+struct UsageError {
+  std::string what;
+};
+
+// parses a positive count.
+usize parse_count(std::string_view flag, std::string_view text) {
+  usize      n   = 0;
+  const auto end = text.data() + text.size();
+  const auto res = std::from_chars(text.data(), end, n);
+  if (res.ec != std::errc {} || res.ptr != end || n == 0)
+    throw UsageError {std::string(flag) + " needs a positive count"};
+  return n;
+}
+
+// whether a path looks like a level file.
+bool is_level_file(const fs::path &path) {
+  const auto ext = path.extension();
+  return ext == extension_of(Format::Json)
+      || ext == extension_of(Format::Cbor);
+}
+
+// a level file to check.
+struct Input {
+  fs::path file;
+  // its path relative to the directory it was found in, or its file
+  // name if it was named directly. see `converted_path`.
+  fs::path name;
+};
+
+// the level files named by the arguments, directories searched
+// recursively; each directory's files are sorted, so the output is
+// the same from one run to the next.
+std::vector<Input> collect(std::span<const fs::path> args) {
+  std::vector<Input> inputs;
+  for (const auto &arg : args) {
+    if (!fs::is_directory(arg)) {
+      inputs.push_back({.file = arg, .name = arg.filename()});
+      continue;
+    }
+    std::vector<fs::path> found;
+    for (const auto &entry : fs::recursive_directory_iterator(arg))
+      if (entry.is_regular_file() && is_level_file(entry.path()))
+        found.push_back(entry.path());
+    std::ranges::sort(found);
+    for (auto &file : found) {
+      fs::path name = file.lexically_relative(arg);
+      inputs.push_back({
+        .file = std::move(file),
+        .name = std::move(name),
+      });
+    }
+  }
+  return inputs;
+}
+
+// creates the directories levels are converted into, and rejects
+// inputs which would be converted into the same file, since they'd
+// be written at once.
+void prepare_out(
+  std::span<const Input> inputs, const Options &options
+) {
+  std::map<fs::path, const fs::path *> targets;
+  for (const auto &input : inputs) {
+    const fs::path to        = converted_path(input.name, options);
+    const auto [iter, fresh] = targets.emplace(to, &input.file);
+    if (!fresh)
+      throw UsageError {
+        iter->second->string() + " and " + input.file.string()
+        + " would both be converted to " + to.string()
+      };
+    fs::create_directories(to.parent_path());
+  }
+}
+
+// writes the levels into a pack file.
+void write_pack_file(
+  const fs::path           &path,
+  std::span<const RawLevel> levels,
+  Format                    format
+) {
+  std::ofstream out {path, std::ios::binary};
+  if (out)
+    sbokena::pack::write_pack(out, levels, format);
+  if (!out || !out.flush())
+    throw std::runtime_error("can't write " + path.string());
+}
+
+int run(std::span<char *const> argv) {
+  if (argv.size() < 2)
+    throw UsageError {"missing command"};
+
+  const std::string_view command = argv[1];
+  Options                options;
+  usize                  threads = hardware_threads();
+  std::vector<fs::path>  inputs;
+  bool                   has_out = false;
+  if (command == "solve")
+    options.solve = true;
+  else if (command == "stats")
+    options.stats = true;
+  else if (command == "convert")
+    options.convert = Format::Cbor;
+  else if (command == "pack")
+    options.keep = true;
+  else if (command != "validate")
+    throw UsageError {"unknown command " + std::string(command)};
+
+  for (usize i = 2; i < argv.size(); ++i) {
+    const std::string_view arg = argv[i];
+    // the value of a flag, which is the next argument.
+    const auto value = [&] {
+      if (++i == argv.size())
+        throw UsageError {std::string(arg) + " needs a value"};
+      return std::string_view {argv[i]};
+    };
+
+    if (arg == "-j" || arg == "--jobs") {
+      threads = parse_count(arg, value());
+    } else if (arg == "--budget") {
+      options.budget = parse_count(arg, value());
+    } else if (arg == "--solve") {
+      options.solve = true;
+    } else if (arg == "--to") {
+      const std::string_view to = value();
+      if (to == "json")
+        options.convert = Format::Json;
+      else if (to == "cbor")
+        options.convert = Format::Cbor;
+      else
+        throw UsageError {"--to must be json or cbor"};
+    } else if (arg == "-o" || arg == "--out") {
+      options.out = value();
+      has_out     = true;
+    } else if (arg.starts_with('-')) {
+      throw UsageError {"unknown option " + std::string(arg)};
+    } else {
+      inputs.emplace_back(arg);
+    }
+  }
+  // a pack holds its levels in the format asked for, and isn't a
+  // conversion of each file.
+  Format pack_format = Format::Cbor;
+  if (options.keep && options.convert) {
+    pack_format = *options.convert;
+    options.convert.reset();
+  }
+  if (options.convert && command != "convert")
+    throw UsageError {"--to is only for convert and pack"};
+  if (options.keep && !has_out)
+    throw UsageError {"pack needs -o"};
+  if (inputs.empty())
+    throw UsageError {"no levels given"};
+
+  const std::vector<Input> files = collect(inputs);
+  if (options.convert)
+    prepare_out(files, options);
+  std::vector<Outcome> outcomes(files.size());
+  for_each_index(files.size(), threads, [&](usize i) {
+    outcomes[i] = check(files[i].file, files[i].name, options);
+  });
+
+  usize failed = 0;
+  for (const auto &outcome : outcomes) {
+    std::cout << describe(outcome) << '\n';
+    failed += !outcome.ok();
+  }
+  std::cout << files.size() << " levels, " << failed << " failed\n";
+  if (failed != 0)
+    return 1;
+
+  if (options.keep) {
+    std::vector<RawLevel> levels;
+    levels.reserve(outcomes.size());
+    for (auto &outcome : outcomes)
+      levels.push_back(std::move(*outcome.level));
+    write_pack_file(options.out, levels, pack_format);
+    std::cout << "packed into " << options.out.string() << '\n';
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    return run({argv, static_cast<usize>(argc)});
+  } catch (const UsageError &err) {
+    std::cerr << "error: " << err.what << "\n\n" << USAGE;
+    return 2;
+  } catch (const std::exception &ex) {
+    std::cerr << "error: " << ex.what() << '\n';
+    return 2;
+  }
+}
@@ -0,0 +1,34 @@
+#include "parallel.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace sbokena::cli::parallel {
+
+usize hardware_threads() noexcept {
+  // may be 0 if it can't be told.
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void for_each_index(
+  usize count, usize threads, const std::function<void(usize)> &fn
+) {
+  std::atomic<usize> next {0};
+  const auto         work = [&] {
+    for (usize i = next++; i < count; i = next++)
+      fn(i);
+  };
+
+  // no more threads than inputs; the calling thread is one of them.
+  threads = std::clamp<usize>(threads, 1, std::max<usize>(count, 1));
+  std::vector<std::jthread> pool;
+  pool.reserve(threads - 1);
+  for (usize i = 1; i < threads; ++i)
+    pool.emplace_back(work);
+  work();
+}
+
+} // namespace sbokena::cli::parallel
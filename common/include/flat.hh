@@ -0,0 +1,365 @@
+// sorted containers over contiguous memory.
+//
+// these stand in for `std::flat_map` and `std::flat_set`, which not
+// every supported standard library ships yet. lookups are binary
+// searches over a vector, and iteration walks it in order, so they
+// suit containers which are filled once and then mostly read.
+// inserting and erasing shift everything after the element.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sbokena::flat {
+
+// marks elements which are already sorted by key, without equal
+// keys, such as those of a `std::map`. building a container from them
+// is a plain copy, without sorting.
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique {};
+
+// a map of unique keys, as a vector of pairs sorted by key.
+//
+// unlike `std::flat_map`, keys and values are stored side by side,
+// so an element is a plain `std::pair`. its key must not be changed
+// through an iterator.
+template <typename K, typename V>
+class FlatMap {
+public:
+  using key_type       = K;
+  using mapped_type    = V;
+  using value_type     = std::pair<K, V>;
+  using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+  using storage_type   = std::pmr::vector<value_type>;
+  using size_type      = typename storage_type::size_type;
+  using iterator       = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  FlatMap() = default;
+
+  explicit FlatMap(const allocator_type &alloc)
+    : items(alloc) {}
+
+  // from any elements, sorted here. of equal keys, the first is kept.
+  template <std::input_iterator It>
+  FlatMap(It first, It last, const allocator_type &alloc = {})
+    : items(first, last, alloc) {
+    normalize();
+  }
+
+  template <std::input_iterator It>
+  FlatMap(
+    sorted_unique_t, It first, It last, const allocator_type &alloc = {}
+  )
+    : items(first, last, alloc) {}
+
+  FlatMap(
+    std::initializer_list<value_type> init,
+    const allocator_type             &alloc = {}
+  )
+    : FlatMap {init.begin(), init.end(), alloc} {}
+
+  // copies draw from the default resource, as with `std::pmr`
+  // containers, unless given another one.
+  FlatMap(const FlatMap &)            = default;
+  FlatMap &operator=(const FlatMap &) = default;
+  FlatMap(FlatMap &&)                 = default;
+  FlatMap &operator=(FlatMap &&)      = default;
+  ~FlatMap()                          = default;
+
+  FlatMap(const FlatMap &other, const allocator_type &alloc)
+    : items(other.items, alloc) {}
+
+  FlatMap(FlatMap &&other, const allocator_type &alloc)
+    : items(std::move(other.items), alloc) {}
+
+  allocator_type get_allocator() const noexcept {
+    return items.get_allocator();
+  }
+
+  iterator begin() noexcept {
+    return items.begin();
+  }
+
+  iterator end() noexcept {
+    return items.end();
+  }
+
+  const_iterator begin() const noexcept {
+    return items.begin();
+  }
+
+  const_iterator end() const noexcept {
+    return items.end();
+  }
+
+  size_type size() const noexcept {
+    return items.size();
+  }
+
+  bool empty() const noexcept {
+    return items.empty();
+  }
+
+  void reserve(size_type n) {
+    items.reserve(n);
+  }
+
+  void clear() noexcept {
+    items.clear();
+  }
+
+  // the first element whose key isn't less than `key`.
+  iterator lower_bound(const K &key) {
+    return std::ranges::lower_bound(
+      items, key, std::less {}, &value_type::first
+    );
+  }
+
+  const_iterator lower_bound(const K &key) const {
+    return std::ranges::lower_bound(
+      items, key, std::less {}, &value_type::first
+    );
+  }
+
+  iterator find(const K &key) {
+    const auto iter = lower_bound(key);
+    return iter != end() && iter->first == key ? iter : end();
+  }
+
+  const_iterator find(const K &key) const {
+    const auto iter = lower_bound(key);
+    return iter != end() && iter->first == key ? iter : end();
+  }
+
+  bool contains(const K &key) const {
+    return find(key) != end();
+  }
+
+  size_type count(const K &key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  // throws `std::out_of_range` if there is no such key.
+  V &at(const K &key) {
+    const auto iter = find(key);
+    if (iter == end())
+      throw std::out_of_range("FlatMap::at: no such key");
+    return iter->second;
+  }
+
+  const V &at(const K &key) const {
+    const auto iter = find(key);
+    if (iter == end())
+      throw std::out_of_range("FlatMap::at: no such key");
+    return iter->second;
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(const K &key, Args &&...args) {
+    const auto iter = lower_bound(key);
+    if (iter != end() && iter->first == key)
+      return {iter, false};
+    return {
+      items.emplace(
+        iter,
+        std::piecewise_construct,
+        std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...)
+      ),
+      true
+    };
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    value_type value(std::forward<Args>(args)...);
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return try_emplace(value.first, value.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  template <typename M>
+  std::pair<iterator, bool>
+  insert_or_assign(const K &key, M &&value) {
+    const auto [iter, inserted] =
+      try_emplace(key, std::forward<M>(value));
+    if (!inserted)
+      iter->second = std::forward<M>(value);
+    return {iter, inserted};
+  }
+
+  iterator erase(const_iterator pos) {
+    return items.erase(pos);
+  }
+
+  size_type erase(const K &key) {
+    const auto iter = find(key);
+    if (iter == end())
+      return 0;
+    items.erase(iter);
+    return 1;
+  }
+
+  bool operator==(const FlatMap &rhs) const {
+    return items == rhs.items;
+  }
+
+private:
+  // sort by key, and drop later duplicates.
+  void normalize() {
+    constexpr auto key = &value_type::first;
+    std::ranges::stable_sort(items, std::less {}, key);
+    const auto dups =
+      std::ranges::unique(items, std::equal_to {}, key);
+    items.erase(dups.begin(), dups.end());
+  }
+
+  storage_type items;
+};
+
+// a set of unique keys, as a sorted vector.
+template <typename K>
+class FlatSet {
+public:
+  using key_type       = K;
+  using value_type     = K;
+  using allocator_type = std::pmr::polymorphic_allocator<K>;
+  using storage_type   = std::pmr::vector<K>;
+  using size_type      = typename storage_type::size_type;
+  // keys never change in place.
+  using iterator       = typename storage_type::const_iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  FlatSet() = default;
+
+  explicit FlatSet(const allocator_type &alloc)
+    : items(alloc) {}
+
+  // from any keys, sorted here.
+  template <std::input_iterator It>
+  FlatSet(It first, It last, const allocator_type &alloc = {})
+    : items(first, last, alloc) {
+    std::ranges::sort(items, std::less {});
+    const auto dups = std::ranges::unique(items, std::equal_to {});
+    items.erase(dups.begin(), dups.end());
+  }
+
+  template <std::input_iterator It>
+  FlatSet(
+    sorted_unique_t, It first, It last, const allocator_type &alloc = {}
+  )
+    : items(first, last, alloc) {}
+
+  FlatSet(
+    std::initializer_list<K> init, const allocator_type &alloc = {}
+  )
+    : FlatSet {init.begin(), init.end(), alloc} {}
+
+  FlatSet(const FlatSet &)            = default;
+  FlatSet &operator=(const FlatSet &) = default;
+  FlatSet(FlatSet &&)                 = default;
+  FlatSet &operator=(FlatSet &&)      = default;
+  ~FlatSet()                          = default;
+
+  FlatSet(const FlatSet &other, const allocator_type &alloc)
+    : items(other.items, alloc) {}
+
+  FlatSet(FlatSet &&other, const allocator_type &alloc)
+    : items(std::move(other.items), alloc) {}
+
+  allocator_type get_allocator() const noexcept {
+    return items.get_allocator();
+  }
+
+  const_iterator begin() const noexcept {
+    return items.begin();
+  }
+
+  const_iterator end() const noexcept {
+    return items.end();
+  }
+
+  size_type size() const noexcept {
+    return items.size();
+  }
+
+  bool empty() const noexcept {
+    return items.empty();
+  }
+
+  void reserve(size_type n) {
+    items.reserve(n);
+  }
+
+  void clear() noexcept {
+    items.clear();
+  }
+
+  const_iterator lower_bound(const K &key) const {
+    return std::ranges::lower_bound(items, key, std::less {});
+  }
+
+  const_iterator find(const K &key) const {
+    const auto iter = lower_bound(key);
+    return iter != end() && *iter == key ? iter : end();
+  }
+
+  bool contains(const K &key) const {
+    return find(key) != end();
+  }
+
+  size_type count(const K &key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  std::pair<const_iterator, bool> insert(const K &key) {
+    const auto iter = lower_bound(key);
+    if (iter != end() && *iter == key)
+      return {iter, false};
+    return {items.insert(iter, key), true};
+  }
+
+  template <typename... Args>
+  std::pair<const_iterator, bool> emplace(Args &&...args) {
+    return insert(K(std::forward<Args>(args)...));
+  }
+
+  const_iterator erase(const_iterator pos) {
+    return items.erase(pos);
+  }
+
+  size_type erase(const K &key) {
+    const auto iter = find(key);
+    if (iter == end())
+      return 0;
+    items.erase(iter);
+    return 1;
+  }
+
+  bool operator==(const FlatSet &rhs) const {
+    return items == rhs.items;
+  }
+
+private:
+  storage_type items;
+};
+
+} // namespace sbokena::flat
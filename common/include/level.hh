@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include <istream>
+#include <map>
+#include <memory_resource>
+#include <ostream>
+
 #include <nlohmann/json.hpp>
 
 #include "direction.hh"
@@ -13,6 +18,7 @@ using nlohmann::json;
 
 using namespace sbokena::types;
 using sbokena::direction::Direction;
+using sbokena::position::Cell;
 using sbokena::position::Position;
 
 namespace sbokena::level {
@@ -113,20 +119,66 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
   }
 )
 
-// raw level data from a level file.
+// raw level data from a level file, keyed by `Cell`. reading a level
+// with positions past `CELL_LIMIT` fails.
 //
 // this type does almost no validation.
 // if this is needed, see `sbokena::loader::Level`.
+//
+// its maps may draw from a memory resource other than the default
+// one, such as a scratch arena for loading (see `read_json`). copies
+// always draw from the default one.
 struct RawLevel {
+  using Tiles   = std::pmr::map<Cell, Tile>;
+  using Objects = std::pmr::map<Cell, Object>;
+
   std::string name;
   std::string theme;
   Difficulty  diff;
 
-  std::map<Position<>, Tile>   tiles;
-  std::map<Position<>, Object> objects;
+  Tiles   tiles;
+  Objects objects;
 };
 DECL_JSON(RawLevel)
 
 #undef DECL_JSON
 
+// ===== streaming =====
+
+// an encoding of a level.
+enum class Format : u8 {
+  // JSON text, as written by the editor (`.sbk`).
+  Json,
+  // CBOR, a binary encoding of the same document (`.sbkb`).
+  Cbor,
+};
+
+// writes a level as JSON, in the same format as `to_json`, straight
+// to the stream without building a `json` value first.
+void write_json(std::ostream &os, const RawLevel &level);
+
+// reads a level from JSON in the same format as `from_json`, straight
+// from the stream without building a `json` value first. the maps of
+// the level draw from `memory`, which must outlive them.
+//
+// throws `std::runtime_error` on malformed or incomplete input.
+RawLevel read_json(
+  std::istream              &is,
+  std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+);
+
+// writes a level as CBOR (RFC 8949), a binary encoding of the same
+// document `to_json` builds. it is smaller and faster to read than
+// the JSON text.
+void write_cbor(std::ostream &os, const RawLevel &level);
+
+// reads a level written by `write_cbor`, straight from the stream,
+// like `read_json`.
+//
+// throws `std::runtime_error` on malformed or incomplete input.
+RawLevel read_cbor(
+  std::istream              &is,
+  std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+);
+
 }; // namespace sbokena::level
@@ -8,6 +8,7 @@
 #include <format>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <print>
 #include <set>
@@ -21,8 +22,11 @@
 #include <nlohmann/json.hpp>
 #include <raylib.h>
 
+#include "flat.hh"
 #include "level.hh"
+#include "portal.hh"
 #include "position.hh"
+#include "profile.hh"
 #include "types.hh"
 #include "utils.hh"
 
@@ -137,6 +141,12 @@ struct InvalidLevelException : std::runtime_error {
   InvalidLevelException();
 };
 
+// a bump allocator which frees everything at once when destroyed.
+using Arena = std::pmr::monotonic_buffer_resource;
+
+// an arena with room for a level of about `cells` cells up front.
+std::unique_ptr<Arena> make_arena(usize cells);
+
 // a loaded and validated theme for in-memory use.
 // a valid value of `loader::Theme` guarantees that:
 // - all `Tile`/`Object` sprites have the same non-zero, uniform,
@@ -194,6 +204,7 @@ public:
   )
     : name_ {std::make_shared<std::string>(name)},
       sprites_ {nullptr} {
+    SBK_PROFILE_SCOPE("Theme::Theme");
     fs::path                 cur = fs::canonical(search_root);
     std::unique_ptr<Sprites> tmp {nullptr};
 
@@ -315,186 +326,75 @@ private:
   friend class Theme;
 };
 
-// a loaded and validated level for in-memory use.
-// a value of `loader::Level` guarantees that:
-// - the requisite theme is valid and loaded. see the `Theme` class
-//   for the exact details of these guarantees.
+// the validated contents of a level, without a theme.
+// a value of `loader::LevelData` guarantees that:
 // - all `Door` tiles have at least one corresponding button.
-// - all `Portal` tiles are paired correctly.
+// - all `Portal` tiles are paired correctly, no chain of portals
+//   leads back into itself, and no object starts on a portal.
 // - the number of `Goal` tiles equals the number of `Box` and
 //  `DirBox` objects combined.
 // - there is exactly one `Player` object.
-template <typename S>
-  requires Resource<S> && Sprite<S>
-class Level {
+// - every tile and object is at a cell below `CELL_LIMIT`.
+//
+// this is what tools which never draw the level (the editor's
+// solvability check, for instance) validate against.
+//
+// its containers all draw from an arena of its own, so loading a
+// level takes a few large allocations instead of one per cell, all
+// freed at once with it. a copy gets an arena of its own.
+//
+// its maps are ordered node maps, which the game state keeps moving
+// objects around in. what only reads the tiles, goals and door
+// buttons once the level is loaded can freeze them, see
+// `freeze_tiles`.
+class LevelData {
 public:
   using DoorSet = std::pair<
-    Position<>,          // position of door
-    std::set<Position<>> // positions of buttons
+    Position<>,         // position of door
+    std::pmr::set<Cell> // positions of buttons
     >;
   using PortalSet = std::pair<
     Position<>, // position of 1st portal
     Position<>  // position of 2nd portal
     >;
 
-  using Goals   = std::set<Position<>>;
-  using Objects = std::map<Position<>, level::Object>;
-  using Tiles   = std::map<Position<>, level::Tile>;
-  using Doors   = std::unordered_map<u32, DoorSet>;
-  using Portals = std::unordered_map<u32, PortalSet>;
+  using Goals   = std::pmr::set<Cell>;
+  using Objects = std::pmr::map<Cell, level::Object>;
+  using Tiles   = std::pmr::map<Cell, level::Tile>;
+  using Doors   = std::pmr::unordered_map<u32, DoorSet>;
+  using Portals = std::pmr::unordered_map<u32, PortalSet>;
+
+  // the tiles, goals and door buttons, frozen into sorted vectors.
+  using FrozenTiles   = flat::FlatMap<Cell, level::Tile>;
+  using FrozenGoals   = flat::FlatSet<Cell>;
+  using FrozenDoorSet = std::pair<
+    Position<>,         // position of door
+    flat::FlatSet<Cell> // positions of buttons
+    >;
+  using FrozenDoors = std::pmr::unordered_map<u32, FrozenDoorSet>;
 
-  // validate a `RawLevel`, and take in a `Theme`.
+  // validate a `RawLevel`.
   //
-  // this constructor is parameterized, i.e. you can pass in a
-  // `Theme<Image>` to a `Level<Texture>` constructor, and the theme
-  // will be committed into VRAM.
-  template <typename T = S>
-    requires Resource<T> && Sprite<T>
-  Level(const level::RawLevel &raw, const Theme<T> &theme)
-    : name_ {raw.name},
-      theme_ {theme},
-      diff_ {raw.diff},
-      tiles_ {raw.tiles},
-      objects_ {raw.objects},
-      player_ {POS_MAX<>} {
-    // #box must equal #goal
-    isize boxes = 0;
-
-    for (const auto &[pos, obj] : objects_)
-      switch (obj.index()) {
-      case index_of<level::Object, level::Player>(): {
-        // check if we've already set the player's position
-        assert_throw(player_ == POS_MAX<>, InvalidLevelException {});
-        player_ = pos;
-        break;
-      }
-      case index_of<level::Object, level::Box>():
-      case index_of<level::Object, level::DirBox>(): {
-        // count #box
-        ++boxes;
-        break;
-      }
-      }
+  // throws `InvalidLevelException` if any of the guarantees above
+  // don't hold.
+  explicit LevelData(const level::RawLevel &raw);
 
-    for (const auto &[pos, tile] : tiles_)
-      switch (tile.index()) {
-      case index_of<level::Tile, level::Floor>():
-        // nothing to do here
-        break;
-      case index_of<level::Tile, level::Button>(): {
-        // - if the door is there, add the button
-        // - if the door is not there, insert a fake door
-        const auto &btn  = std::get<level::Button>(tile);
-        const auto  iter = doors_.find(btn.door_id);
-        if (iter != doors_.end())
-          iter->second.second.insert(pos);
-        else
-          doors_.insert({btn.door_id, {POS_MAX<>, {pos}}});
-        break;
-      }
-      case index_of<level::Tile, level::Door>(): {
-        // - if the door is not there, add an empty set
-        // - if the door is there, either it's a placeholder (ok), or
-        //   it's a duplicate (error)
-        const auto &door = std::get<level::Door>(tile);
-        const auto  iter = doors_.find(door.door_id);
-
-        // door not there
-        if (iter == doors_.end()) {
-          doors_.insert({door.door_id, {pos, {}}});
-          break;
-        }
-
-        // door is there
-        assert_throw(
-          iter->second.first == POS_MAX<>, InvalidLevelException {}
-        );
-        iter->second.first = pos;
-        break;
-      }
-      case index_of<level::Tile, level::Portal>(): {
-        // - if the pair isn't present, add as the left hand
-        // - if the right hand is filled, add as the right hand
-        // - if both are filled, throw an error.
-        const auto &portal = std::get<level::Portal>(tile);
-        const auto  iter   = portals_.find(portal.portal_id);
-        if (iter == portals_.end())
-          portals_.insert({portal.portal_id, {pos, POS_MAX<>}});
-        else {
-          assert_throw(
-            iter->second.second == POS_MAX<>, InvalidLevelException {}
-          );
-          iter->second.second = pos;
-        }
-        break;
-      };
-      case index_of<level::Tile, level::Goal>(): {
-        // "uncount" #box
-        // if it's 0 at the end, the level is valid
-        --boxes;
-        goals_.insert(pos);
-        break;
-      }
-      }
-
-    // require #box == #goal
-    assert_throw(boxes == 0, InvalidLevelException {});
-
-    // require player to be present
-    assert_throw(player_ != POS_MAX<>, InvalidLevelException {});
-
-    // check for dangling doorsets
-    for (const auto &[_, doorset] : doors_) {
-      assert_throw(
-        doorset.first != POS_MAX<>, InvalidLevelException {}
-      );
-      assert_throw(!doorset.second.empty(), InvalidLevelException {});
-    }
+  LevelData() = delete;
+  LevelData(const LevelData &);
+  LevelData(LevelData &&) noexcept = default;
+  ~LevelData()                     = default;
 
-    // check for dangling portals
-    for (const auto &[_, portalset] : portals_) {
-      assert_throw(
-        portalset.first != POS_MAX<>, InvalidLevelException {}
-      );
-      assert_throw(
-        portalset.second != POS_MAX<>, InvalidLevelException {}
-      );
-    }
-  }
-
-  Level()                         = delete;
-  Level(const Level &)            = default;
-  Level &operator=(const Level &) = default;
-  Level(Level &&)                 = delete;
-  Level &operator=(Level &&)      = delete;
-  ~Level()                        = default;
-
-  template <typename T>
-    requires Resource<T> && Sprite<T>
-  Level(const Level<T> &);
-
-  // commit a Level<Image> to a Level<Texture>.
-  template <>
-  Level<Texture>(const Level<Image> &level)
-    : name_ {level.name_},
-      theme_ {level.theme_},
-      diff_ {level.diff_},
-      tiles_ {level.tiles_},
-      objects_ {level.objects_},
-      doors_ {level.doors_},
-      portals_ {level.portals_},
-      player_ {level.player_} {}
+  // the containers only ever move along with the arena they draw
+  // from, so assigning rebuilds this level around the other's arena,
+  // or a fresh copy of it, and frees the old one.
+  LevelData &operator=(const LevelData &);
+  LevelData &operator=(LevelData &&) noexcept;
 
   // name of the level.
   std::string_view name() const noexcept {
     return name_;
   }
 
-  // name of the theme.
-  const Theme<S> &theme() const noexcept {
-    return theme_;
-  }
-
   // difficulty of the level.
   level::Difficulty diff() const noexcept {
     return diff_;
@@ -525,14 +425,34 @@ public:
     return goals_;
   }
 
+  // a copy of the tiles, frozen into a sorted vector drawing from
+  // `memory`: lookups are binary searches over contiguous memory,
+  // and iteration is a linear walk in the row-major order of `Cell`.
+  FrozenTiles freeze_tiles(
+    std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+  ) const;
+
+  // a copy of the goals, frozen as by `freeze_tiles`.
+  FrozenGoals freeze_goals(
+    std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+  ) const;
+
+  // a copy of the doors, with their buttons frozen as by
+  // `freeze_tiles`.
+  FrozenDoors freeze_doors(
+    std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+  ) const;
+
   // position of player.
   Position<> player() const noexcept {
     return player_;
   }
 
 private:
+  // declared first, so it outlives the containers drawing from it.
+  std::unique_ptr<Arena> arena;
+
   std::string       name_;
-  Theme<S>          theme_;
   level::Difficulty diff_;
 
   Tiles   tiles_;
@@ -544,6 +464,52 @@ private:
   Goals goals_;
 
   Position<> player_;
+};
+
+// a loaded and validated level for in-memory use.
+// a value of `loader::Level` guarantees that:
+// - the requisite theme is valid and loaded. see the `Theme` class
+//   for the exact details of these guarantees.
+// - everything `LevelData` guarantees.
+template <typename S>
+  requires Resource<S> && Sprite<S>
+class Level : public LevelData {
+public:
+  // validate a `RawLevel`, and take in a `Theme`.
+  //
+  // this constructor is parameterized, i.e. you can pass in a
+  // `Theme<Image>` to a `Level<Texture>` constructor, and the theme
+  // will be committed into VRAM.
+  template <typename T = S>
+    requires Resource<T> && Sprite<T>
+  Level(const level::RawLevel &raw, const Theme<T> &theme)
+    : LevelData {raw},
+      theme_ {theme} {}
+
+  Level()                         = delete;
+  Level(const Level &)            = default;
+  Level &operator=(const Level &) = default;
+  Level(Level &&)                 = delete;
+  Level &operator=(Level &&)      = delete;
+  ~Level()                        = default;
+
+  template <typename T>
+    requires Resource<T> && Sprite<T>
+  Level(const Level<T> &);
+
+  // commit a Level<Image> to a Level<Texture>.
+  template <>
+  Level<Texture>(const Level<Image> &level)
+    : LevelData {level},
+      theme_ {level.theme_} {}
+
+  // name of the theme.
+  const Theme<S> &theme() const noexcept {
+    return theme_;
+  }
+
+private:
+  Theme<S> theme_;
 
   template <typename T>
     requires Resource<T> && Sprite<T>
@@ -0,0 +1,123 @@
+// level packs: many levels in a single file.
+//
+// a pack starts with an index of its levels (their names, difficulty
+// and dimensions, and where each one is stored), followed by the
+// levels themselves, each encoded on its own as JSON or CBOR. the
+// index alone is enough to list the levels of a pack, and a level is
+// read by seeking straight to it.
+//
+// all integers are stored in little-endian order:
+//
+//   header: "SBKPACK\0", u32 version, u32 level count
+//   entry:  u64 offset, u64 size, u8 format, u8 difficulty,
+//           u32 width, u32 height, u16 name size, name bytes
+//
+// followed by the levels, where an entry's `offset` is counted from
+// the start of the pack.
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory_resource>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "level.hh"
+#include "types.hh"
+
+namespace fs = std::filesystem;
+
+using namespace sbokena::types;
+using sbokena::level::Difficulty;
+using sbokena::level::Format;
+using sbokena::level::RawLevel;
+
+namespace sbokena::pack {
+
+// the version of the pack format written by `write_pack`.
+constexpr u32 VERSION = 1;
+
+// the file extension of a pack, dot included.
+constexpr const char *EXTENSION = ".sbkp";
+
+// a level of a pack, as listed in its index.
+struct Entry {
+  std::string name;
+  Difficulty  diff;
+  // the size of the smallest rectangle holding every tile.
+  u32 width;
+  u32 height;
+
+  // how the level is stored in the pack.
+  Format format;
+  u64    offset;
+  u64    size;
+};
+
+// writes a pack holding the levels, in order, each one encoded in a
+// format.
+//
+// throws `std::runtime_error` if a level's name is too long.
+void write_pack(
+  std::ostream &os, std::span<const RawLevel> levels, Format format
+);
+
+// reads the index of a pack, leaving the levels unread.
+//
+// throws `std::runtime_error` on malformed or incomplete input.
+std::vector<Entry> read_index(std::istream &is);
+
+// reads a level of a pack, given its entry in the index. the maps of
+// the level draw from `memory`, as with `read_json`.
+//
+// throws `std::runtime_error` on malformed or incomplete input.
+RawLevel read_entry(
+  std::istream              &is,
+  const Entry               &entry,
+  std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+);
+
+// an open pack file, whose index has been read.
+class Pack {
+public:
+  Pack()                        = delete;
+  Pack(const Pack &)            = delete;
+  Pack &operator=(const Pack &) = delete;
+  Pack(Pack &&)                 = default;
+  Pack &operator=(Pack &&)      = default;
+  ~Pack()                       = default;
+
+  // opens a pack file and reads its index.
+  //
+  // throws `std::runtime_error` if the file can't be opened, or if
+  // its index is malformed.
+  explicit Pack(const fs::path &path);
+
+  // the path of the pack file.
+  const fs::path &path() const noexcept {
+    return path_;
+  }
+
+  // the levels of the pack, in order.
+  std::span<const Entry> entries() const noexcept {
+    return entries_;
+  }
+
+  // reads the level at an index of the pack, see `read_entry`.
+  //
+  // throws `std::out_of_range` if there is no such level, and
+  // `std::runtime_error` if it can't be read.
+  RawLevel load(usize index);
+  RawLevel load(usize index, std::pmr::memory_resource *memory);
+
+private:
+  fs::path           path_;
+  std::ifstream      file;
+  std::vector<Entry> entries_;
+};
+
+} // namespace sbokena::pack
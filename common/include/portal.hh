@@ -0,0 +1,66 @@
+// compiled portal exits.
+//
+// an object entering a portal leaves through its pair, and may land
+// on yet another portal, which it then enters in turn. the exit table
+// resolves every such chain once, when a level is loaded.
+
+#pragma once
+
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+
+#include "direction.hh"
+#include "flat.hh"
+#include "level.hh"
+#include "position.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::position::Cell;
+using sbokena::position::Position;
+
+namespace sbokena::portal {
+
+// the resolved exit of entering a portal from its entrance side.
+struct Exit {
+  // the first non-`Portal` cell the chain lands on.
+  Position<> pos = position::POS_MAX<>;
+  // direction of the last hop, i.e. the direction in which the
+  // object moves onto `pos`.
+  Direction dir = Direction::Up;
+  // directions of every hop, as a mask of `Direction` bits.
+  u8 dirs = 0;
+  // whether the chain can be traversed at all, i.e. every portal
+  // along it is entered from its entrance side.
+  bool open = true;
+};
+
+using Tiles       = level::RawLevel::Tiles;
+using FrozenTiles = flat::FlatMap<Cell, level::Tile>;
+using Portals = std::pmr::unordered_map<
+  u32,
+  std::pair<Position<>, Position<>> // positions of both portals
+  >;
+using Exits = flat::FlatMap<Cell, Exit>;
+
+// resolve the exit of every paired `Portal` tile, into a table
+// drawing from `memory`.
+//
+// throws `loader::InvalidLevelException` if any chain leads back to
+// a portal it already went through, since it would never end.
+Exits compile(
+  const Tiles &,
+  const Portals &,
+  std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+);
+
+// `compile`, from frozen tiles.
+Exits compile(
+  const FrozenTiles &,
+  const Portals &,
+  std::pmr::memory_resource *memory = std::pmr::get_default_resource()
+);
+
+} // namespace sbokena::portal
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
+#include <functional>
 #include <limits>
+#include <type_traits>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 
@@ -17,11 +21,28 @@ namespace sbokena::position {
 
 // a position in a 2D grid.
 // for the game, +y points down, and +x points right.
+//
+// positions of different widths convert to each other implicitly.
+// a coordinate which doesn't fit the other width, or is the maximal
+// value of its own, becomes the maximal value of the other, so
+// `POS_MAX` stays `POS_MAX` and nothing out of range lands on a
+// valid position.
 template <std::integral T = u32>
 struct Position {
   T x;
   T y;
 
+  template <std::integral U>
+    requires(!std::same_as<T, U>)
+  constexpr operator Position<U>() const noexcept {
+    const auto fit = [](T v) {
+      if (v == std::numeric_limits<T>::max() || !std::in_range<U>(v))
+        return std::numeric_limits<U>::max();
+      return static_cast<U>(v);
+    };
+    return {fit(x), fit(y)};
+  }
+
   // this position with x and y swapped.
   [[nodiscard("tposed does not modify `this`")]]
   constexpr Position tposed() const noexcept {
@@ -33,13 +54,13 @@ struct Position {
   constexpr Position move(const Direction &dir) const noexcept {
     switch (dir) {
     case Direction::Up:
-      return {x, y - 1};
+      return {x, static_cast<T>(y - 1)};
     case Direction::Down:
-      return {x, y + 1};
+      return {x, static_cast<T>(y + 1)};
     case Direction::Left:
-      return {x - 1, y};
+      return {static_cast<T>(x - 1), y};
     case Direction::Right:
-      return {x + 1, y};
+      return {static_cast<T>(x + 1), y};
     }
   }
 
@@ -85,12 +106,21 @@ struct Position {
     return !(*this == rhs);
   }
 
-  // lexicographical less-than compare this position to another.
+  // row-major less-than compare this position to another, so that
+  // the cells of a row are next to each other in ordered containers.
   constexpr bool operator<(const Position<T> &rhs) const noexcept {
-    return x < rhs.x || (x == rhs.x && y < rhs.y);
+    return y < rhs.y || (y == rhs.y && x < rhs.x);
   }
 };
 
+// the key of a level's cell in containers, at half the size of a
+// `Position<>`.
+using Cell = Position<u16>;
+
+// coordinates of cells are below this. positions past it convert to
+// a `Cell` with coordinates at it, which is never a level's cell.
+constexpr u32 CELL_LIMIT = std::numeric_limits<u16>::max();
+
 // the minimal `Position` value.
 template <std::integral T = u32>
 constexpr Position<T> POS_MIN = {
@@ -120,3 +150,17 @@ void to_json(json &j, const Position<T> &pos) {
 }
 
 } // namespace sbokena::position
+
+// hashes a position, for unordered containers.
+template <std::integral T>
+struct std::hash<sbokena::position::Position<T>> {
+  using Key = sbokena::position::Position<T>;
+
+  std::size_t operator()(const Key &pos) const noexcept {
+    using U = std::make_unsigned_t<T>;
+    const u64 bits = (u64 {static_cast<U>(pos.x)} << 32)
+                   | u64 {static_cast<U>(pos.y)};
+    // the multiplier of fibonacci hashing spreads nearby cells apart.
+    return std::hash<u64> {}(bits * 0x9e3779b97f4a7c15);
+  }
+};
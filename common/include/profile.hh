@@ -0,0 +1,143 @@
+// scoped timing of frames and of the work done in them.
+//
+// code is instrumented with the macros below, which only do anything
+// when built with `SBOKENA_PROFILE` (`-DSBOKENA_PROFILE=1` in cmake).
+// otherwise they expand to nothing, and cost nothing.
+//
+// - `SBK_PROFILE_SCOPE("name")` times the rest of the enclosing
+//   scope. names must be string literals.
+// - `SBK_PROFILE_FRAME()` marks the end of a frame.
+//
+// the game shows the recorded times in an overlay (toggled with F3),
+// and when the `SBOKENA_TRACE` environment variable names a file,
+// every scope is also written there on exit, as Chrome trace event
+// JSON (see `chrome://tracing` or https://ui.perfetto.dev).
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "types.hh"
+
+using namespace sbokena::types;
+
+#ifdef SBOKENA_PROFILE
+#define SBK_PROFILE_CONCAT_(a, b) a##b
+#define SBK_PROFILE_CONCAT(a, b)  SBK_PROFILE_CONCAT_(a, b)
+#define SBK_PROFILE_SCOPE(name)                       \
+  const ::sbokena::profile::Scope SBK_PROFILE_CONCAT( \
+    sbk_profile_scope_, __LINE__                      \
+  ) {name}
+#define SBK_PROFILE_FRAME() ::sbokena::profile::end_frame()
+#else
+#define SBK_PROFILE_SCOPE(name) static_cast<void>(0)
+#define SBK_PROFILE_FRAME()     static_cast<void>(0)
+#endif
+
+namespace sbokena::profile {
+
+using Clock = std::chrono::steady_clock;
+
+// the number of frames kept for the overlay.
+constexpr usize FRAMES = 240;
+
+// the number of scopes kept for the trace, beyond which new ones are
+// dropped, so a long session can't run out of memory.
+constexpr usize MAX_TRACE_EVENTS = 1 << 20;
+
+// a timed scope.
+struct Event {
+  // a string literal.
+  const char *name;
+  // a small number, unique to the recording thread.
+  u32               thread;
+  Clock::time_point start;
+  Clock::duration   duration;
+};
+
+// records a finished scope, from any thread.
+void record(
+  const char *name, Clock::time_point start, Clock::time_point end
+);
+
+// records the time between its construction and destruction.
+class Scope {
+public:
+  Scope()                         = delete;
+  Scope(const Scope &)            = delete;
+  Scope &operator=(const Scope &) = delete;
+  Scope(Scope &&)                 = delete;
+  Scope &operator=(Scope &&)      = delete;
+
+  explicit Scope(const char *name) noexcept
+    : name {name},
+      start {Clock::now()} {}
+
+  ~Scope() {
+    record(name, start, Clock::now());
+  }
+
+private:
+  const char       *name;
+  Clock::time_point start;
+};
+
+// marks the end of a frame, i.e. the start of the next one.
+void end_frame();
+
+// the average time spent in a scope, per frame.
+struct Phase {
+  std::string_view name;
+  f64              ms;
+};
+
+// what the overlay shows, in milliseconds.
+struct Summary {
+  // the durations of the last `FRAMES` frames, oldest first.
+  std::vector<f32> frames;
+  f32              p50;
+  f32              p95;
+  f32              p99;
+  f32              max;
+  // every scope recorded so far, by name.
+  std::vector<Phase> phases;
+};
+
+// the recorded times so far.
+Summary summary();
+
+// the nearest-rank percentile `p` (in `[0, 1]`) of some samples, or 0
+// if there are none.
+f32 percentile(std::span<const f32> samples, f32 p);
+
+// writes events as Chrome trace event JSON, with times counted from
+// `epoch`.
+void write_trace(
+  std::ostream          &os,
+  std::span<const Event> events,
+  Clock::time_point      epoch
+);
+
+// keeps every scope recorded while alive, and writes them as a trace
+// to the file named by `SBOKENA_TRACE` when destroyed. does nothing
+// if it isn't set.
+class TraceSession {
+public:
+  TraceSession();
+  TraceSession(const TraceSession &)            = delete;
+  TraceSession &operator=(const TraceSession &) = delete;
+  TraceSession(TraceSession &&)                 = delete;
+  TraceSession &operator=(TraceSession &&)      = delete;
+  ~TraceSession();
+
+private:
+  std::optional<std::string> path;
+};
+
+} // namespace sbokena::profile
@@ -88,6 +88,11 @@ constexpr std::array<nfdfilteritem_t, 1> LEVEL_FILTER = {{
   {.name = "sbokena level", .spec = "sb,sbk"},
 }};
 
+// file dialog filter for level packs, see `pack.hh`.
+constexpr std::array<nfdfilteritem_t, 1> PACK_FILTER = {{
+  {.name = "sbokena level pack", .spec = "sbkp"},
+}};
+
 // create a file dialog for user to open a file.
 std::optional<fs::path> open_file_dialog(
   std::span<const nfdfilteritem_t> filter = LEVEL_FILTER
@@ -1,17 +1,21 @@
 #include "level.hh"
 
 #include <format>
+#include <limits>
+#include <string_view>
 #include <utility>
 #include <variant>
 
 #include <nlohmann/json.hpp>
 
+#include "profile.hh"
 #include "utils.hh"
 
 using namespace nlohmann::json_literals;
 using nlohmann::json;
 
 using namespace sbokena::utils;
+using sbokena::position::CELL_LIMIT;
 
 namespace sbokena::level {
 
@@ -161,6 +165,20 @@ void to_json(json &j, const Object &t) {
 
 // ===== level =====
 
+namespace {
+// the cell at a position read from a level.
+//
+// throws `std::runtime_error` if the position is past the range of
+// a `Cell`.
+Cell to_cell(Position<> pos) {
+  assert_throw(
+    pos.x < CELL_LIMIT && pos.y < CELL_LIMIT,
+    std::runtime_error {"level position out of range"}
+  );
+  return pos;
+}
+} // namespace
+
 void from_json(const json &j, RawLevel &l) {
   j.at("name").get_to(l.name);
   j.at("theme").get_to(l.theme);
@@ -173,10 +191,10 @@ void from_json(const json &j, RawLevel &l) {
   const auto objects =
     j.at("objects").get<std::vector<PackedObject>>();
 
-  for (const auto &ptile : tiles)
-    l.tiles.insert(ptile);
-  for (const auto &pobject : objects)
-    l.objects.insert(pobject);
+  for (const auto &[pos, tile] : tiles)
+    l.tiles.emplace(to_cell(pos), tile);
+  for (const auto &[pos, object] : objects)
+    l.objects.emplace(to_cell(pos), object);
 }
 
 void to_json(json &j, const RawLevel &l) {
@@ -194,6 +212,540 @@ void to_json(json &j, const RawLevel &l) {
     j.at("objects").push_back(pobject);
 }
 
+// ===== streaming =====
+
+namespace {
+
+// name of a direction, as serialized by `direction.hh`.
+std::string_view name_of(Direction dir) {
+  switch (dir) {
+  case Direction::Up:
+    return "Up";
+  case Direction::Down:
+    return "Down";
+  case Direction::Left:
+    return "Left";
+  case Direction::Right:
+    return "Right";
+  }
+  throw std::runtime_error("invalid direction");
+}
+
+// name of a difficulty, as serialized by `level.hh`.
+std::string_view name_of(Difficulty diff) {
+  switch (diff) {
+  case Difficulty::Unknown:
+    return "Unknown";
+  case Difficulty::Easy:
+    return "Easy";
+  case Difficulty::Medium:
+    return "Medium";
+  case Difficulty::Hard:
+    return "Hard";
+  }
+  throw std::runtime_error("invalid difficulty");
+}
+
+// parse a direction from its name.
+Direction direction_of(std::string_view name) {
+  for (const Direction dir :
+       {Direction::Up,
+        Direction::Down,
+        Direction::Left,
+        Direction::Right})
+    if (name_of(dir) == name)
+      return dir;
+  throw std::runtime_error(
+    std::format("unknown direction: {}", name)
+  );
+}
+
+// parse a difficulty from its name.
+Difficulty difficulty_of(std::string_view name) {
+  for (const Difficulty diff :
+       {Difficulty::Unknown,
+        Difficulty::Easy,
+        Difficulty::Medium,
+        Difficulty::Hard})
+    if (name_of(diff) == name)
+      return diff;
+  throw std::runtime_error(
+    std::format("unknown difficulty: {}", name)
+  );
+}
+
+// write a JSON string literal.
+void write_string(std::ostream &os, std::string_view str) {
+  os << '"';
+  for (const char c : str) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    case '\t':
+      os << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        os << std::format("\\u{:04x}", static_cast<int>(c));
+      else
+        os << c;
+    }
+  }
+  os << '"';
+}
+
+// write the `[{"x":..,"y":..},{` head of a packed tile or object.
+void write_head(std::ostream &os, const Position<> &pos) {
+  os << R"([{"x":)" << pos.x << R"(,"y":)" << pos.y << "},{";
+}
+
+// major types of CBOR data items.
+enum struct Major : u8 {
+  Unsigned = 0,
+  Text     = 3,
+  Array    = 4,
+  Map      = 5,
+};
+
+// write the head of a CBOR data item: its major type, and its value
+// or length, in as few bytes as it fits in.
+void cbor_head(std::ostream &os, Major major, u64 arg) {
+  const auto put = [&](u8 info, usize bytes) {
+    os.put(static_cast<char>(static_cast<u8>(major) << 5 | info));
+    for (usize i = bytes; i-- > 0;)
+      os.put(static_cast<char>(arg >> (8 * i)));
+  };
+  if (arg < 24)
+    put(static_cast<u8>(arg), 0);
+  else if (arg <= 0xff)
+    put(24, 1);
+  else if (arg <= 0xffff)
+    put(25, 2);
+  else if (arg <= 0xffff'ffff)
+    put(26, 4);
+  else
+    put(27, 8);
+}
+
+// write a CBOR text string.
+void cbor_text(std::ostream &os, std::string_view str) {
+  cbor_head(os, Major::Text, str.size());
+  os.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+// write a key and its value, in a CBOR map.
+void cbor_field(std::ostream &os, std::string_view key, u64 value) {
+  cbor_text(os, key);
+  cbor_head(os, Major::Unsigned, value);
+}
+
+void cbor_field(
+  std::ostream &os, std::string_view key, std::string_view value
+) {
+  cbor_text(os, key);
+  cbor_text(os, value);
+}
+
+// write the head of a packed tile or object in CBOR: the entry, its
+// position, and the map of a tile or object with `fields` fields,
+// `"type"` included.
+void cbor_entry(std::ostream &os, const Position<> &pos, u64 fields) {
+  cbor_head(os, Major::Array, 2);
+  cbor_head(os, Major::Map, 2);
+  cbor_field(os, "x", pos.x);
+  cbor_field(os, "y", pos.y);
+  cbor_head(os, Major::Map, fields);
+}
+
+// SAX handler reading a `RawLevel`.
+//
+// a level is an object holding strings and two arrays of entries,
+// each entry being an array of a position and a tile or object:
+//
+//   depth 1: {"name": .., "tiles": [..], ..}
+//   depth 2:   "tiles": [entry, ..]
+//   depth 3:     entry: [{"x": .., "y": ..}, {"type": .., ..}]
+//   depth 4:       fields of the position, then of the tile
+class LevelReader : public nlohmann::json_sax<json> {
+public:
+  explicit LevelReader(std::pmr::memory_resource *memory)
+    : level {
+        .name    = {},
+        .theme   = {},
+        .diff    = Difficulty::Unknown,
+        .tiles   = RawLevel::Tiles(memory),
+        .objects = RawLevel::Objects(memory),
+      } {}
+
+  RawLevel finish() {
+    assert_throw(
+      level_fields == ALL_LEVEL_FIELDS,
+      std::runtime_error {"level is missing fields"}
+    );
+    return std::move(level);
+  }
+
+  bool start_object(std::size_t) override {
+    if (depth == 2 && section != Section::None)
+      unexpected();
+    if (depth == 3 && section != Section::None)
+      ++entry.slot;
+    ++depth;
+    return true;
+  }
+
+  bool end_object() override {
+    --depth;
+    return true;
+  }
+
+  bool start_array(std::size_t) override {
+    if (depth == 1 && (field == "tiles" || field == "objects")) {
+      section = field == "tiles" ? Section::Tiles : Section::Objects;
+      level_fields |= field == "tiles" ? TILES : OBJECTS;
+    } else if (depth == 2 && section != Section::None) {
+      entry = {};
+    }
+    ++depth;
+    return true;
+  }
+
+  bool end_array() override {
+    --depth;
+    if (depth == 2 && section != Section::None)
+      finish_entry();
+    else if (depth == 1)
+      section = Section::None;
+    return true;
+  }
+
+  bool key(string_t &k) override {
+    if (depth == 1 || depth == 4)
+      field = k;
+    return true;
+  }
+
+  bool number_unsigned(number_unsigned_t n) override {
+    if (depth != 4 || section == Section::None)
+      return true;
+    assert_throw(
+      n <= std::numeric_limits<u32>::max(),
+      std::runtime_error {std::format("{} is out of range", field)}
+    );
+    const u32 value = static_cast<u32>(n);
+    if (entry.slot == 1 && field == "x")
+      set(entry.pos.x, value, X);
+    else if (entry.slot == 1 && field == "y")
+      set(entry.pos.y, value, Y);
+    else if (entry.slot == 2 && field == "type")
+      set(entry.type, value, TYPE);
+    else if (entry.slot == 2
+             && (field == "door_id" || field == "portal_id"))
+      set(entry.id, value, ID);
+    return true;
+  }
+
+  bool string(string_t &str) override {
+    if (depth == 1 && field == "name") {
+      level.name    = str;
+      level_fields |= NAME;
+    } else if (depth == 1 && field == "theme") {
+      level.theme   = str;
+      level_fields |= THEME;
+    } else if (depth == 1 && field == "diff") {
+      level.diff    = difficulty_of(str);
+      level_fields |= DIFF;
+    } else if (depth == 4 && entry.slot == 2 && field == "dir") {
+      set(entry.dir, direction_of(str), DIR);
+    } else if (depth == 4 && entry.slot == 2 && field == "in_dir") {
+      set(entry.in_dir, direction_of(str), IN_DIR);
+    } else {
+      unexpected();
+    }
+    return true;
+  }
+
+  bool number_integer(number_integer_t) override {
+    unexpected();
+    return true;
+  }
+
+  bool number_float(number_float_t, const string_t &) override {
+    unexpected();
+    return true;
+  }
+
+  bool null() override {
+    unexpected();
+    return true;
+  }
+
+  bool boolean(bool) override {
+    unexpected();
+    return true;
+  }
+
+  bool binary(binary_t &) override {
+    unexpected();
+    return true;
+  }
+
+  bool parse_error(
+    std::size_t,
+    const std::string &,
+    const nlohmann::detail::exception &ex
+  ) override {
+    throw std::runtime_error(ex.what());
+  }
+
+private:
+  enum class Section { None, Tiles, Objects };
+
+  // fields of the level which have been read.
+  static constexpr u8 NAME             = 1 << 0;
+  static constexpr u8 THEME            = 1 << 1;
+  static constexpr u8 DIFF             = 1 << 2;
+  static constexpr u8 TILES            = 1 << 3;
+  static constexpr u8 OBJECTS          = 1 << 4;
+  static constexpr u8 ALL_LEVEL_FIELDS = (1 << 5) - 1;
+
+  // fields of an entry which have been read.
+  static constexpr u8 X      = 1 << 0;
+  static constexpr u8 Y      = 1 << 1;
+  static constexpr u8 TYPE   = 1 << 2;
+  static constexpr u8 ID     = 1 << 3;
+  static constexpr u8 DIR    = 1 << 4;
+  static constexpr u8 IN_DIR = 1 << 5;
+
+  // the tile or object being read.
+  struct Entry {
+    // number of objects started in the entry; 1 while reading the
+    // position, 2 while reading the tile or object.
+    usize      slot   = 0;
+    u8         fields = 0;
+    Position<> pos;
+    u32        type   = 0;
+    u32        id     = 0;
+    Direction  dir    = Direction::Up;
+    Direction  in_dir = Direction::Up;
+  };
+
+  template <typename T>
+  void set(T &dest, T value, u8 bit) {
+    dest          = value;
+    entry.fields |= bit;
+  }
+
+  // a value of the wrong type for its key or place; values of
+  // unknown keys are skipped, like `from_json` does.
+  void unexpected() const {
+    const bool level_key =
+      depth == 1
+      && (field == "name" || field == "theme" || field == "diff"
+          || field == "tiles" || field == "objects");
+    const bool entry_part =
+      section != Section::None && (depth == 2 || depth == 3);
+    const bool entry_key =
+      section != Section::None && depth == 4
+      && (field == "x" || field == "y" || field == "type"
+          || field == "dir" || field == "in_dir"
+          || field == "door_id" || field == "portal_id");
+    assert_throw(
+      !level_key && !entry_part && !entry_key,
+      std::runtime_error {
+        std::format("unexpected value for {}", field)
+      }
+    );
+  }
+
+  // check that a field of the entry has been read.
+  void require(u8 bits) const {
+    assert_throw(
+      (entry.fields & bits) == bits,
+      std::runtime_error {"level entry is missing fields"}
+    );
+  }
+
+  void finish_entry() {
+    require(X | Y | TYPE);
+    if (section == Section::Tiles)
+      level.tiles.emplace(to_cell(entry.pos), make_tile());
+    else
+      level.objects.emplace(to_cell(entry.pos), make_object());
+  }
+
+  Tile make_tile() const {
+    switch (entry.type) {
+    case index_of<Tile, Floor>():
+      return Floor {};
+    case index_of<Tile, Button>():
+      require(ID);
+      return Button {.door_id = entry.id};
+    case index_of<Tile, Door>():
+      require(ID);
+      return Door {.door_id = entry.id};
+    case index_of<Tile, Portal>():
+      require(ID | IN_DIR);
+      return Portal {.portal_id = entry.id, .in_dir = entry.in_dir};
+    case index_of<Tile, DirFloor>():
+      require(DIR);
+      return DirFloor {.dir = entry.dir};
+    case index_of<Tile, Goal>():
+      return Goal {};
+    default:
+      throw std::runtime_error(
+        std::format("unknown tile type: {}", entry.type)
+      );
+    }
+  }
+
+  Object make_object() const {
+    switch (entry.type) {
+    case index_of<Object, Player>():
+      return Player {};
+    case index_of<Object, Box>():
+      return Box {};
+    case index_of<Object, DirBox>():
+      require(DIR);
+      return DirBox {.dir = entry.dir};
+    default:
+      throw std::runtime_error(
+        std::format("unknown object type: {}", entry.type)
+      );
+    }
+  }
+
+  RawLevel    level;
+  u8          level_fields = 0;
+  usize       depth        = 0;
+  Section     section      = Section::None;
+  // the last key read at depth 1 or 4.
+  std::string field;
+  Entry       entry;
+};
+
+} // namespace
+
+void write_json(std::ostream &os, const RawLevel &l) {
+  os << R"({"name":)";
+  write_string(os, l.name);
+  os << R"(,"theme":)";
+  write_string(os, l.theme);
+  os << R"(,"diff":")" << name_of(l.diff) << '"';
+
+  os << R"(,"tiles":[)";
+  bool first = true;
+  for (const auto &[pos, tile] : l.tiles) {
+    if (!std::exchange(first, false))
+      os << ',';
+    write_head(os, pos);
+    // clang-format off
+    std::visit(overload {
+      [](const Floor &) {},
+      [&](const Button &b) {
+        os << R"("door_id":)" << b.door_id << ',';
+      },
+      [&](const Door &d) {
+        os << R"("door_id":)" << d.door_id << ',';
+      },
+      [&](const Portal &p) {
+        os << R"("portal_id":)" << p.portal_id << R"(,"in_dir":")"
+           << name_of(p.in_dir) << R"(",)";
+      },
+      [&](const DirFloor &f) {
+        os << R"("dir":")" << name_of(f.dir) << R"(",)";
+      },
+      [](const Goal &) {},
+    }, tile);
+    // clang-format on
+    os << R"("type":)" << tile.index() << "}]";
+  }
+
+  os << R"(],"objects":[)";
+  first = true;
+  for (const auto &[pos, object] : l.objects) {
+    if (!std::exchange(first, false))
+      os << ',';
+    write_head(os, pos);
+    if (const auto *box = std::get_if<DirBox>(&object))
+      os << R"("dir":")" << name_of(box->dir) << R"(",)";
+    os << R"("type":)" << object.index() << "}]";
+  }
+  os << "]}";
+}
+
+RawLevel
+read_json(std::istream &is, std::pmr::memory_resource *memory) {
+  SBK_PROFILE_SCOPE("read_json");
+  LevelReader reader {memory};
+  json::sax_parse(is, &reader);
+  return reader.finish();
+}
+
+void write_cbor(std::ostream &os, const RawLevel &l) {
+  // the same layout as `write_json`. every map and array has a
+  // known size, which CBOR writes up front.
+  cbor_head(os, Major::Map, 5);
+  cbor_field(os, "name", l.name);
+  cbor_field(os, "theme", l.theme);
+  cbor_field(os, "diff", name_of(l.diff));
+
+  cbor_text(os, "tiles");
+  cbor_head(os, Major::Array, l.tiles.size());
+  for (const auto &[pos, tile] : l.tiles) {
+    // clang-format off
+    std::visit(overload {
+      [&](const Floor &) { cbor_entry(os, pos, 1); },
+      [&](const Button &b) {
+        cbor_entry(os, pos, 2);
+        cbor_field(os, "door_id", b.door_id);
+      },
+      [&](const Door &d) {
+        cbor_entry(os, pos, 2);
+        cbor_field(os, "door_id", d.door_id);
+      },
+      [&](const Portal &p) {
+        cbor_entry(os, pos, 3);
+        cbor_field(os, "portal_id", p.portal_id);
+        cbor_field(os, "in_dir", name_of(p.in_dir));
+      },
+      [&](const DirFloor &f) {
+        cbor_entry(os, pos, 2);
+        cbor_field(os, "dir", name_of(f.dir));
+      },
+      [&](const Goal &) { cbor_entry(os, pos, 1); },
+    }, tile);
+    // clang-format on
+    cbor_field(os, "type", tile.index());
+  }
+
+  cbor_text(os, "objects");
+  cbor_head(os, Major::Array, l.objects.size());
+  for (const auto &[pos, object] : l.objects) {
+    const auto *box = std::get_if<DirBox>(&object);
+    cbor_entry(os, pos, box ? 2 : 1);
+    if (box)
+      cbor_field(os, "dir", name_of(box->dir));
+    cbor_field(os, "type", object.index());
+  }
+}
+
+RawLevel
+read_cbor(std::istream &is, std::pmr::memory_resource *memory) {
+  SBK_PROFILE_SCOPE("read_cbor");
+  // the same events as the JSON text, so the same reader.
+  LevelReader reader {memory};
+  json::sax_parse(is, &reader, json::input_format_t::cbor);
+  return reader.finish();
+}
+
 #undef JSON_IMPL_STRUCT
 #undef JSON_IMPL_EMPTY
 #undef DE_VAR
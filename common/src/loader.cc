@@ -1,11 +1,20 @@
 #include "loader.hh"
 
+#include <algorithm>
 #include <filesystem>
 #include <format>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include <raylib.h>
 
+#include "level.hh"
+#include "portal.hh"
+#include "profile.hh"
+#include "utils.hh"
+
 namespace sbokena::loader {
 
 // ===== load_res/unload_res impls =====
@@ -46,4 +55,203 @@ ThemeLoadException::ThemeLoadException(
 InvalidLevelException::InvalidLevelException()
   : std::runtime_error {"invalid level data"} {}
 
+// ===== arenas =====
+
+namespace {
+// roughly what a map node of a tile or an object takes, with room
+// for the doors, portals and goals besides.
+constexpr usize BYTES_PER_CELL = 128;
+} // namespace
+
+std::unique_ptr<Arena> make_arena(usize cells) {
+  const usize bytes = std::max<usize>(cells, 1) * BYTES_PER_CELL;
+  return std::make_unique<Arena>(bytes);
+}
+
+// ===== LevelData impls =====
+
+LevelData::LevelData(const level::RawLevel &raw)
+  : arena {make_arena(raw.tiles.size())},
+    name_ {raw.name},
+    diff_ {raw.diff},
+    tiles_ {raw.tiles, arena.get()},
+    objects_ {raw.objects, arena.get()},
+    doors_ {arena.get()},
+    portals_ {arena.get()},
+    goals_ {arena.get()},
+    player_ {POS_MAX<>} {
+  SBK_PROFILE_SCOPE("LevelData::LevelData");
+  // #box must equal #goal
+  isize boxes = 0;
+
+  // a cell at `CELL_LIMIT` is where a position out of range lands.
+  const auto in_range = [](Cell cell) {
+    return cell.x < CELL_LIMIT && cell.y < CELL_LIMIT;
+  };
+
+  for (const auto &[pos, obj] : objects_) {
+    assert_throw(in_range(pos), InvalidLevelException {});
+    switch (obj.index()) {
+    case index_of<level::Object, level::Player>(): {
+      // check if we've already set the player's position
+      assert_throw(player_ == POS_MAX<>, InvalidLevelException {});
+      player_ = pos;
+      break;
+    }
+    case index_of<level::Object, level::Box>():
+    case index_of<level::Object, level::DirBox>(): {
+      // count #box
+      ++boxes;
+      break;
+    }
+    }
+  }
+
+  for (const auto &[pos, tile] : tiles_) {
+    assert_throw(in_range(pos), InvalidLevelException {});
+    switch (tile.index()) {
+    case index_of<level::Tile, level::Floor>():
+      // nothing to do here
+      break;
+    case index_of<level::Tile, level::Button>(): {
+      // - if the door is there, add the button
+      // - if the door is not there, insert a fake door
+      const auto &btn  = std::get<level::Button>(tile);
+      const auto  iter = doors_.find(btn.door_id);
+      if (iter != doors_.end())
+        iter->second.second.insert(pos);
+      else
+        doors_.insert({btn.door_id, {POS_MAX<>, {pos}}});
+      break;
+    }
+    case index_of<level::Tile, level::Door>(): {
+      // - if the door is not there, add an empty set
+      // - if the door is there, either it's a placeholder (ok), or
+      //   it's a duplicate (error)
+      const auto &door = std::get<level::Door>(tile);
+      const auto  iter = doors_.find(door.door_id);
+
+      // door not there
+      if (iter == doors_.end()) {
+        doors_.insert({door.door_id, {pos, {}}});
+        break;
+      }
+
+      // door is there
+      assert_throw(
+        iter->second.first == POS_MAX<>, InvalidLevelException {}
+      );
+      iter->second.first = pos;
+      break;
+    }
+    case index_of<level::Tile, level::Portal>(): {
+      // - if the pair isn't present, add as the left hand
+      // - if the right hand is filled, add as the right hand
+      // - if both are filled, throw an error.
+      const auto &portal = std::get<level::Portal>(tile);
+      const auto  iter   = portals_.find(portal.portal_id);
+      assert_throw(!objects_.contains(pos), InvalidLevelException {});
+      if (iter == portals_.end())
+        portals_.insert({portal.portal_id, {pos, POS_MAX<>}});
+      else {
+        assert_throw(
+          iter->second.second == POS_MAX<>, InvalidLevelException {}
+        );
+        iter->second.second = pos;
+      }
+      break;
+    };
+    case index_of<level::Tile, level::Goal>(): {
+      // "uncount" #box
+      // if it's 0 at the end, the level is valid
+      --boxes;
+      goals_.insert(pos);
+      break;
+    }
+    }
+  }
+
+  // require #box == #goal
+  assert_throw(boxes == 0, InvalidLevelException {});
+
+  // require player to be present
+  assert_throw(player_ != POS_MAX<>, InvalidLevelException {});
+
+  // check for dangling doorsets
+  for (const auto &[_, doorset] : doors_) {
+    assert_throw(
+      doorset.first != POS_MAX<>, InvalidLevelException {}
+    );
+    assert_throw(!doorset.second.empty(), InvalidLevelException {});
+  }
+
+  // check for dangling portals
+  for (const auto &[_, portalset] : portals_) {
+    assert_throw(
+      portalset.first != POS_MAX<>, InvalidLevelException {}
+    );
+    assert_throw(
+      portalset.second != POS_MAX<>, InvalidLevelException {}
+    );
+  }
+
+  // check for portal cycles
+  portal::compile(tiles_, portals_);
+}
+
+LevelData::LevelData(const LevelData &other)
+  : arena {make_arena(other.tiles_.size())},
+    name_ {other.name_},
+    diff_ {other.diff_},
+    tiles_ {other.tiles_, arena.get()},
+    objects_ {other.objects_, arena.get()},
+    doors_ {other.doors_, arena.get()},
+    portals_ {other.portals_, arena.get()},
+    goals_ {other.goals_, arena.get()},
+    player_ {other.player_} {}
+
+LevelData::FrozenTiles
+LevelData::freeze_tiles(std::pmr::memory_resource *memory) const {
+  return {flat::sorted_unique, tiles_.begin(), tiles_.end(), memory};
+}
+
+LevelData::FrozenGoals
+LevelData::freeze_goals(std::pmr::memory_resource *memory) const {
+  return {flat::sorted_unique, goals_.begin(), goals_.end(), memory};
+}
+
+LevelData::FrozenDoors
+LevelData::freeze_doors(std::pmr::memory_resource *memory) const {
+  FrozenDoors out {memory};
+  out.reserve(doors_.size());
+  for (const auto &[id, door] : doors_) {
+    const auto &[pos, buttons] = door;
+    out.try_emplace(
+      id,
+      pos,
+      flat::FlatSet<Cell> {
+        flat::sorted_unique, buttons.begin(), buttons.end(), memory
+      }
+    );
+  }
+  return out;
+}
+
+LevelData &LevelData::operator=(const LevelData &other) {
+  if (this != &other)
+    *this = LevelData {other};
+  return *this;
+}
+
+LevelData &LevelData::operator=(LevelData &&other) noexcept {
+  // moving the containers alone would leave them drawing from an
+  // arena which `other` still owns.
+  static_assert(std::is_nothrow_move_constructible_v<LevelData>);
+  if (this != &other) {
+    std::destroy_at(this);
+    std::construct_at(this, std::move(other));
+  }
+  return *this;
+}
+
 } // namespace sbokena::loader
@@ -0,0 +1,207 @@
+#include "pack.hh"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <format>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "profile.hh"
+
+using namespace std::string_view_literals;
+
+namespace sbokena::pack {
+
+namespace {
+constexpr std::string_view MAGIC = "SBKPACK\0"sv;
+
+// the size of the header, and of an entry without its name.
+constexpr u64 HEADER_SIZE = MAGIC.size() + 4 + 4;
+constexpr u64 ENTRY_SIZE  = 8 + 8 + 1 + 1 + 4 + 4 + 2;
+
+// writes an unsigned integer, little-endian.
+template <std::unsigned_integral T>
+void put(std::ostream &os, T value) {
+  std::array<char, sizeof(T)> bytes;
+  for (auto &byte : bytes) {
+    byte = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+  os.write(bytes.data(), bytes.size());
+}
+
+// reads an unsigned integer, little-endian.
+template <std::unsigned_integral T>
+T get(std::istream &is) {
+  std::array<unsigned char, sizeof(T)> bytes;
+  if (!is.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+    throw std::runtime_error("pack: unexpected end of index");
+  T value = 0;
+  for (usize i = sizeof(T); i-- > 0;)
+    value = static_cast<T>(value << 8) | bytes[i];
+  return value;
+}
+
+// the size of the smallest rectangle holding every tile of a level.
+std::pair<u32, u32> dimensions(const RawLevel &level) {
+  if (level.tiles.empty())
+    return {0, 0};
+  Cell min = level.tiles.begin()->first;
+  Cell max = min;
+  for (const auto &[pos, _] : level.tiles) {
+    min = {std::min(min.x, pos.x), std::min(min.y, pos.y)};
+    max = {std::max(max.x, pos.x), std::max(max.y, pos.y)};
+  }
+  return {max.x - min.x + 1, max.y - min.y + 1};
+}
+} // namespace
+
+void write_pack(
+  std::ostream &os, std::span<const RawLevel> levels, Format format
+) {
+  // the index holds the offset of every level, so the levels are
+  // encoded first.
+  std::vector<std::string> payloads;
+  payloads.reserve(levels.size());
+  u64 offset = HEADER_SIZE;
+  for (const auto &level : levels) {
+    if (level.name.size() > std::numeric_limits<u16>::max())
+      throw std::runtime_error(
+        std::format("pack: level name too long: {}", level.name)
+      );
+    std::ostringstream out;
+    switch (format) {
+    case Format::Json:
+      level::write_json(out, level);
+      break;
+    case Format::Cbor:
+      level::write_cbor(out, level);
+      break;
+    }
+    payloads.push_back(std::move(out).str());
+    offset += ENTRY_SIZE + level.name.size();
+  }
+
+  os.write(MAGIC.data(), MAGIC.size());
+  put<u32>(os, VERSION);
+  put<u32>(os, levels.size());
+  for (usize i = 0; i < levels.size(); ++i) {
+    const RawLevel &level      = levels[i];
+    const auto [width, height] = dimensions(level);
+    put<u64>(os, offset);
+    put<u64>(os, payloads[i].size());
+    put<u8>(os, static_cast<u8>(format));
+    put<u8>(os, static_cast<u8>(level.diff));
+    put<u32>(os, width);
+    put<u32>(os, height);
+    put<u16>(os, level.name.size());
+    os.write(level.name.data(), level.name.size());
+    offset += payloads[i].size();
+  }
+  for (const auto &payload : payloads)
+    os.write(payload.data(), payload.size());
+}
+
+std::vector<Entry> read_index(std::istream &is) {
+  SBK_PROFILE_SCOPE("pack::read_index");
+  // every level must lie within the stream.
+  is.seekg(0, std::ios::end);
+  const auto end = static_cast<u64>(is.tellg());
+  is.seekg(0);
+  if (!is)
+    throw std::runtime_error("pack: can't seek");
+
+  std::array<char, MAGIC.size()> magic;
+  if (!is.read(magic.data(), magic.size())
+      || std::string_view {magic.data(), magic.size()} != MAGIC)
+    throw std::runtime_error("pack: not a level pack");
+  const u32 version = get<u32>(is);
+  if (version != VERSION)
+    throw std::runtime_error(
+      std::format("pack: unsupported version {}", version)
+    );
+
+  const u32          count = get<u32>(is);
+  std::vector<Entry> entries;
+  // a malformed count must not reserve more than the stream holds.
+  entries.reserve(std::min<u64>(count, end / ENTRY_SIZE));
+  for (u32 i = 0; i < count; ++i) {
+    Entry entry;
+    entry.offset    = get<u64>(is);
+    entry.size      = get<u64>(is);
+    const u8 format = get<u8>(is);
+    const u8 diff   = get<u8>(is);
+    entry.width     = get<u32>(is);
+    entry.height    = get<u32>(is);
+    entry.name.resize(get<u16>(is));
+    if (!is.read(entry.name.data(), entry.name.size()))
+      throw std::runtime_error("pack: unexpected end of index");
+
+    if (format > static_cast<u8>(Format::Cbor))
+      throw std::runtime_error(
+        std::format("pack: unknown level format {}", format)
+      );
+    if (diff > static_cast<u8>(Difficulty::Hard))
+      throw std::runtime_error(
+        std::format("pack: unknown difficulty {}", diff)
+      );
+    if (entry.offset > end || entry.size > end - entry.offset)
+      throw std::runtime_error(
+        std::format("pack: level {} lies past the end", i)
+      );
+    entry.format = static_cast<Format>(format);
+    entry.diff   = static_cast<Difficulty>(diff);
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+RawLevel read_entry(
+  std::istream              &is,
+  const Entry               &entry,
+  std::pmr::memory_resource *memory
+) {
+  SBK_PROFILE_SCOPE("pack::read_entry");
+  // the level readers expect nothing past the level, so it is read
+  // out of the pack first.
+  std::string bytes(entry.size, '\0');
+  is.clear();
+  is.seekg(static_cast<std::streamoff>(entry.offset));
+  if (!is.read(bytes.data(), bytes.size()))
+    throw std::runtime_error(
+      std::format("pack: can't read level {}", entry.name)
+    );
+
+  std::istringstream in {std::move(bytes)};
+  switch (entry.format) {
+  case Format::Json:
+    return level::read_json(in, memory);
+  case Format::Cbor:
+    break;
+  }
+  return level::read_cbor(in, memory);
+}
+
+Pack::Pack(const fs::path &path)
+  : path_ {path},
+    file {path, std::ios::binary} {
+  if (!file)
+    throw std::runtime_error(
+      std::format("pack: can't open {}", path.string())
+    );
+  entries_ = read_index(file);
+}
+
+RawLevel Pack::load(usize index) {
+  return load(index, std::pmr::get_default_resource());
+}
+
+RawLevel Pack::load(usize index, std::pmr::memory_resource *memory) {
+  return read_entry(file, entries_.at(index), memory);
+}
+
+} // namespace sbokena::pack
@@ -0,0 +1,96 @@
+#include "portal.hh"
+
+#include <set>
+#include <variant>
+
+#include "level.hh"
+#include "loader.hh"
+#include "utils.hh"
+
+using namespace sbokena::utils;
+using sbokena::loader::InvalidLevelException;
+
+namespace sbokena::portal {
+
+namespace {
+// `compile`, over either kind of tiles, which are both sorted by
+// cell, so exits are added in order.
+template <typename T>
+Exits compile_from(
+  const T                   &tiles,
+  const Portals             &portals,
+  std::pmr::memory_resource *memory
+) {
+  // the portal paired with one at `pos`, if any.
+  const auto partner = [&](Position<> pos, const level::Portal &p)
+    -> const Position<> * {
+    const auto iter = portals.find(p.portal_id);
+    if (iter == portals.end())
+      return nullptr;
+    const auto &[first, second] = iter->second;
+    return pos == first ? &second : &first;
+  };
+
+  Exits exits {memory};
+  for (const auto &[entrance, tile] : tiles) {
+    const auto *portal = std::get_if<level::Portal>(&tile);
+    if (!portal || !partner(entrance, *portal))
+      continue;
+
+    std::set<Position<>> seen {entrance};
+    Position<>           at = entrance;
+    const level::Portal *in = portal;
+    Exit                 exit {};
+
+    while (true) {
+      // leave through the pair, away from its entrance side.
+      const Position<> out      = *partner(at, *in);
+      const auto      &out_tile = tiles.at(out);
+      exit.dir  = -std::get<level::Portal>(out_tile).in_dir;
+      exit.pos  = out.move(exit.dir);
+      exit.dirs |= static_cast<u8>(exit.dir);
+
+      const auto           iter = tiles.find(exit.pos);
+      const level::Portal *next = nullptr;
+      if (iter != tiles.end())
+        next = std::get_if<level::Portal>(&iter->second);
+      if (!next || !partner(exit.pos, *next))
+        break;
+
+      // landed on another portal, from the wrong side.
+      if (next->in_dir != exit.dir) {
+        exit.open = false;
+        break;
+      }
+
+      assert_throw(
+        seen.insert(exit.pos).second, InvalidLevelException {}
+      );
+      at = exit.pos;
+      in = next;
+    }
+
+    exits.insert({entrance, exit});
+  }
+
+  return exits;
+}
+} // namespace
+
+Exits compile(
+  const Tiles               &tiles,
+  const Portals             &portals,
+  std::pmr::memory_resource *memory
+) {
+  return compile_from(tiles, portals, memory);
+}
+
+Exits compile(
+  const FrozenTiles         &tiles,
+  const Portals             &portals,
+  std::pmr::memory_resource *memory
+) {
+  return compile_from(tiles, portals, memory);
+}
+
+} // namespace sbokena::portal
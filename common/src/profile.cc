@@ -0,0 +1,204 @@
+#include "profile.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <print>
+#include <stdexcept>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+
+namespace sbokena::profile {
+
+namespace {
+// how fast the per-frame average of a scope follows changes.
+constexpr f64 PHASE_SMOOTHING = 0.05;
+
+// the time spent in a scope.
+struct PhaseTime {
+  // in the current frame.
+  f64 frame_ms = 0;
+  // per frame, on average.
+  f64 mean_ms = 0;
+};
+
+// everything recorded, shared by every thread.
+struct Profiler {
+  std::mutex lock;
+
+  // the last frame durations, as a ring.
+  std::array<f32, FRAMES>          frames {};
+  usize                            frame_count = 0;
+  usize                            next_frame  = 0;
+  std::optional<Clock::time_point> frame_start;
+
+  std::map<std::string_view, PhaseTime> phases;
+
+  // the scopes kept for a trace, if one is being recorded.
+  bool               tracing = false;
+  bool               dropped = false;
+  std::vector<Event> events;
+  Clock::time_point  epoch = Clock::now();
+};
+
+Profiler &profiler() {
+  static Profiler p;
+  return p;
+}
+
+u32 thread_id() {
+  static std::atomic<u32> next {0};
+  thread_local const u32  id = next++;
+  return id;
+}
+
+f64 to_ms(Clock::duration d) {
+  return std::chrono::duration<f64, std::milli>(d).count();
+}
+
+f64 to_us(Clock::duration d) {
+  return std::chrono::duration<f64, std::micro>(d).count();
+}
+} // namespace
+
+void record(
+  const char *name, Clock::time_point start, Clock::time_point end
+) {
+  const u32 thread = thread_id();
+  Profiler &p      = profiler();
+
+  std::scoped_lock _ {p.lock};
+  p.phases[name].frame_ms += to_ms(end - start);
+  if (!p.tracing)
+    return;
+  if (p.events.size() < MAX_TRACE_EVENTS)
+    p.events.push_back({name, thread, start, end - start});
+  else
+    p.dropped = true;
+}
+
+void end_frame() {
+  const auto now = Clock::now();
+  Profiler  &p   = profiler();
+
+  std::scoped_lock _ {p.lock};
+  if (p.frame_start) {
+    p.frames[p.next_frame] = to_ms(now - *p.frame_start);
+    p.next_frame           = (p.next_frame + 1) % FRAMES;
+    p.frame_count          = std::min(p.frame_count + 1, FRAMES);
+  }
+  p.frame_start = now;
+
+  for (auto &[_, phase] : p.phases) {
+    const f64 change = phase.frame_ms - phase.mean_ms;
+    phase.mean_ms += PHASE_SMOOTHING * change;
+    phase.frame_ms = 0;
+  }
+}
+
+Summary summary() {
+  Summary   sum;
+  Profiler &p = profiler();
+  {
+    std::scoped_lock _ {p.lock};
+    // the ring starts at its oldest frame once it is full.
+    const usize first = p.frame_count < FRAMES ? 0 : p.next_frame;
+    sum.frames.reserve(p.frame_count);
+    for (usize i = 0; i < p.frame_count; ++i)
+      sum.frames.push_back(p.frames[(first + i) % FRAMES]);
+    for (const auto &[name, phase] : p.phases)
+      sum.phases.push_back({name, phase.mean_ms});
+  }
+
+  sum.p50 = percentile(sum.frames, 0.50f);
+  sum.p95 = percentile(sum.frames, 0.95f);
+  sum.p99 = percentile(sum.frames, 0.99f);
+  sum.max = percentile(sum.frames, 1.00f);
+  return sum;
+}
+
+f32 percentile(std::span<const f32> samples, f32 p) {
+  if (samples.empty())
+    return 0;
+  std::vector<f32> sorted(samples.begin(), samples.end());
+  std::ranges::sort(sorted);
+  const auto rank = static_cast<usize>(std::ceil(p * sorted.size()));
+  return sorted[std::clamp<usize>(rank, 1, sorted.size()) - 1];
+}
+
+void write_trace(
+  std::ostream          &os,
+  std::span<const Event> events,
+  Clock::time_point      epoch
+) {
+  // complete ("X") events, with times in microseconds.
+  os << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  for (usize i = 0; i < events.size(); ++i) {
+    const Event &e = events[i];
+    const json event {
+      {"name", e.name},
+      {"ph", "X"},
+      {"pid", 1},
+      {"tid", e.thread},
+      {"ts", to_us(e.start - epoch)},
+      {"dur", to_us(e.duration)},
+    };
+    os << (i ? ",\n" : "\n") << event.dump();
+  }
+  os << "\n]}\n";
+}
+
+TraceSession::TraceSession() {
+  const char *env = std::getenv("SBOKENA_TRACE");
+  if (!env || !*env)
+    return;
+
+  path        = env;
+  Profiler &p = profiler();
+
+  std::scoped_lock _ {p.lock};
+  p.tracing = true;
+  p.dropped = false;
+  p.events.clear();
+}
+
+TraceSession::~TraceSession() {
+  if (!path)
+    return;
+
+  Profiler          &p = profiler();
+  std::vector<Event> events;
+  bool               dropped;
+  {
+    std::scoped_lock _ {p.lock};
+    p.tracing = false;
+    events    = std::move(p.events);
+    dropped   = p.dropped;
+  }
+
+  try {
+    std::ofstream out {*path};
+    write_trace(out, events, p.epoch);
+    if (!out.flush())
+      throw std::runtime_error("write failed");
+    std::println(
+      "trace of {} scopes written to {}{}",
+      events.size(),
+      *path,
+      dropped ? " (later scopes dropped)" : ""
+    );
+  } catch (const std::exception &ex) {
+    std::println("can't write trace to {}: {}", *path, ex.what());
+  }
+}
+
+} // namespace sbokena::profile
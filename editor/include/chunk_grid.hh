@@ -0,0 +1,212 @@
+// A sparse, unbounded grid of cells, stored as fixed-size square
+// chunks in a hash map. Only chunks containing at least one cell are
+// allocated, and area queries only visit the chunks they overlap, so
+// the cost of drawing or editing a region does not depend on the size
+// of the whole level.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+#include "position.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::position::Position;
+using sbokena::position::POS_MAX;
+using sbokena::position::POS_MIN;
+
+namespace sbokena::editor::chunk {
+
+// a grid mapping positions to values, where `EMPTY` marks a cell
+// that holds nothing.
+template <typename T, T EMPTY = T {}, u32 SIZE = 32>
+class ChunkGrid {
+public:
+  // number of cells along each side of a chunk.
+  static constexpr u32 CHUNK_SIZE = SIZE;
+
+  ChunkGrid() = default;
+
+  ChunkGrid(const ChunkGrid &other) {
+    *this = other;
+  }
+
+  ChunkGrid &operator=(const ChunkGrid &other) {
+    chunks.clear();
+    for (const auto &[key, chunk] : other.chunks)
+      chunks.emplace(key, std::make_unique<Chunk>(*chunk));
+    count = other.count;
+    return *this;
+  }
+
+  ChunkGrid(ChunkGrid &&)            = default;
+  ChunkGrid &operator=(ChunkGrid &&) = default;
+  ~ChunkGrid()                       = default;
+
+  // the value at a position, or `EMPTY` if there is none.
+  T get(const Position<> &pos) const {
+    const auto it = chunks.find(key_of(pos));
+    if (it == chunks.end())
+      return EMPTY;
+    return it->second->cells[cell_of(pos)];
+  }
+
+  // whether a position holds a value.
+  bool contains(const Position<> &pos) const {
+    return get(pos) != EMPTY;
+  }
+
+  // sets the value at a position; setting `EMPTY` erases it.
+  void set(const Position<> &pos, T value) {
+    if (value == EMPTY) {
+      (void)erase(pos);
+      return;
+    }
+    auto &chunk = chunks[key_of(pos)];
+    if (!chunk)
+      chunk = std::make_unique<Chunk>();
+    T &cell = chunk->cells[cell_of(pos)];
+    if (cell == EMPTY) {
+      ++chunk->count;
+      ++count;
+    }
+    cell = value;
+  }
+
+  // erases the value at a position; returns whether there was one.
+  // chunks left without any value are freed.
+  bool erase(const Position<> &pos) {
+    const auto it = chunks.find(key_of(pos));
+    if (it == chunks.end())
+      return false;
+    T &cell = it->second->cells[cell_of(pos)];
+    if (cell == EMPTY)
+      return false;
+    cell = EMPTY;
+    --count;
+    if (--it->second->count == 0)
+      chunks.erase(it);
+    return true;
+  }
+
+  // erases every value.
+  void clear() {
+    chunks.clear();
+    count = 0;
+  }
+
+  // number of positions holding a value.
+  usize size() const noexcept {
+    return count;
+  }
+
+  // whether no position holds a value.
+  bool empty() const noexcept {
+    return count == 0;
+  }
+
+  // number of allocated chunks.
+  usize chunk_count() const noexcept {
+    return chunks.size();
+  }
+
+  // calls `fn(pos, value)` for every value, in no particular order.
+  template <typename F>
+  void for_each(F &&fn) const {
+    for (const auto &[key, chunk] : chunks)
+      visit(key, *chunk, POS_MIN<>, POS_MAX<>, fn);
+  }
+
+  // calls `fn(pos, value)` for every value inside the area between
+  // `min` and `max` (both inclusive), only visiting the chunks that
+  // overlap the area.
+  template <typename F>
+  void for_each_in(
+    const Position<> &min, const Position<> &max, F &&fn
+  ) const {
+    if (max.x < min.x || max.y < min.y)
+      return;
+    const u64 cols = max.x / SIZE - min.x / SIZE + 1;
+    const u64 rows = max.y / SIZE - min.y / SIZE + 1;
+
+    // for areas much larger than the level, walking the allocated
+    // chunks is cheaper than probing every chunk of the area.
+    if (cols * rows > chunks.size()) {
+      for (const auto &[key, chunk] : chunks)
+        visit(key, *chunk, min, max, fn);
+      return;
+    }
+
+    for (u32 cy = min.y / SIZE; cy <= max.y / SIZE; ++cy)
+      for (u32 cx = min.x / SIZE; cx <= max.x / SIZE; ++cx) {
+        const auto it = chunks.find(pack(cx, cy));
+        if (it != chunks.end())
+          visit(it->first, *it->second, min, max, fn);
+      }
+  }
+
+private:
+  struct Chunk {
+    Chunk() {
+      cells.fill(EMPTY);
+    }
+
+    std::array<T, SIZE * SIZE> cells;
+    // number of cells holding a value.
+    u32 count = 0;
+  };
+
+  // packs chunk coordinates into a hash map key.
+  static u64 pack(u32 cx, u32 cy) noexcept {
+    return (static_cast<u64>(cy) << 32) | cx;
+  }
+
+  // the key of the chunk containing a position.
+  static u64 key_of(const Position<> &pos) noexcept {
+    return pack(pos.x / SIZE, pos.y / SIZE);
+  }
+
+  // the index of a position inside its chunk.
+  static u32 cell_of(const Position<> &pos) noexcept {
+    return (pos.y % SIZE) * SIZE + (pos.x % SIZE);
+  }
+
+  // calls `fn` for every value of a chunk inside an area.
+  template <typename F>
+  static void visit(
+    u64                key,
+    const Chunk       &chunk,
+    const Position<> &min,
+    const Position<> &max,
+    F                 &fn
+  ) {
+    const u32 ox = static_cast<u32>(key) * SIZE;
+    const u32 oy = static_cast<u32>(key >> 32) * SIZE;
+    if (max.x < ox || max.y < oy)
+      return;
+
+    // clamp the area to the chunk.
+    const u32 x0 = std::max(min.x, ox) - ox;
+    const u32 y0 = std::max(min.y, oy) - oy;
+    if (x0 >= SIZE || y0 >= SIZE)
+      return;
+    const u32 x1 = std::min<u64>(max.x - ox, SIZE - 1);
+    const u32 y1 = std::min<u64>(max.y - oy, SIZE - 1);
+
+    for (u32 y = y0; y <= y1; ++y)
+      for (u32 x = x0; x <= x1; ++x) {
+        const T &cell = chunk.cells[y * SIZE + x];
+        if (cell != EMPTY)
+          fn(Position<> {ox + x, oy + y}, cell);
+      }
+  }
+
+  std::unordered_map<u64, std::unique_ptr<Chunk>> chunks;
+  usize                                           count = 0;
+};
+
+} // namespace sbokena::editor::chunk
@@ -3,21 +3,22 @@
 // contains:
 //  - A Condition struct denoting its difficulty and move
 //  limits.
-//  - A TileMap struct storing every tile's id mapped to its
-//  unique_ptr.
-//  - An ObjectMap struct storing every object's id mapped
-//  to its unique_ptr.
-//  - A PositionMap struct storing every initialized
-//  position mapped to its tile_id, and a PositionHash for
-//  providing its hash function.
+//  - A TileMap struct storing every tile in a pool per tile
+//  type, accessed by its id (see pool.hh).
+//  - An ObjectMap struct storing every object in a pool per
+//  object type, accessed by its id.
+//  - Two ChunkGrids storing every initialized position
+//  mapped to its tile_id and object_id respectively.
+//  - Two unordered maps storing the reverse, every tile_id
+//  and object_id mapped to its position.
 //  - An unordered map for storing all pairs of linked
 //  portals.
 //  - An unordered map for storing all pairs of linked
 //  button to door.
 //  - An unordered map for storing all pairs of linked door
 //  to button.
-// Note: id indexing starts at 0x01, therefore 0x00 means a
-// null or invalid id.
+// Note: ids are pool handles and never 0x00, therefore 0x00
+// means a null or invalid id.
 
 #pragma once
 
@@ -27,17 +28,26 @@
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <raylib.h>
 
+#include "chunk_grid.hh"
 #include "loader.hh"
 #include "object.hh"
+#include "pool.hh"
 #include "position.hh"
+#include "region.hh"
 #include "tile.hh"
 
 using namespace sbokena::editor::tile;
 using namespace sbokena::editor::object;
 
+using sbokena::editor::chunk::ChunkGrid;
+using sbokena::editor::pool::Pool;
+using sbokena::editor::region::CellState;
+using sbokena::editor::region::Clip;
+using sbokena::editor::region::Transform;
 using sbokena::editor::tile::NULL_ID;
 using sbokena::loader::Theme;
 using sbokena::position::Position;
@@ -113,51 +123,130 @@ struct Condition {
   u32        time_limit; // in seconds.
 };
 
-// an unordered map using tile ids to access tiles.
+// a pool holding tiles or objects of a single type.
+template <typename T>
+using TypedPool = Pool<T, static_cast<u32>(T::KIND)>;
+
+// the tiles of a level, stored in a pool per tile type. the type of
+// a tile is encoded in its id, so a lookup is a switch on the type
+// followed by an index into the pool.
 struct TileMap {
-  // initialize an empty map and no ids (id starts from
-  // 0x01).
-  TileMap() : map(), max_id(NULL_ID) {}
+  // creates a new tile, returns its id.
+  u32 create(TileType type);
 
-  ~TileMap() = default;
+  // the pointer to the tile, or nullptr if the id is invalid.
+  Tile *get(u32 id);
 
-  // return a new id, which is the id with the max value
-  // incremented by 1.
-  u32 generate_new_id() {
-    return ++max_id;
-  }
+  // the const pointer to the tile, or nullptr if the id is invalid.
+  const Tile *get(u32 id) const;
+
+  // removes a tile; returns whether it existed.
+  bool erase(u32 id);
+
+  // removes every tile.
+  void clear();
+
+  // number of tiles.
+  usize size() const;
+
+  // the pools.
+  TypedPool<Roof>   roofs;
+  TypedPool<Floor>  floors;
+  TypedPool<OneDir> one_dirs;
+  TypedPool<Goal>   goals;
+  TypedPool<Portal> portals;
+  TypedPool<Door>   doors;
+  TypedPool<Button> buttons;
 
-  // the container itself.
-  std::unordered_map<u32, std::unique_ptr<Tile>> map;
-  // used for generating ids.
-  u32 max_id;
+private:
+  // calls `fn(pool)` with the pool holding tiles of a type.
+  template <typename F>
+  decltype(auto) with_pool(TileType type, F &&fn) {
+    switch (type) {
+    case TileType::Roof:
+      return fn(roofs);
+    case TileType::Floor:
+      return fn(floors);
+    case TileType::OneDir:
+      return fn(one_dirs);
+    case TileType::Goal:
+      return fn(goals);
+    case TileType::Portal:
+      return fn(portals);
+    case TileType::Door:
+      return fn(doors);
+    case TileType::Button:
+      break;
+    }
+    return fn(buttons);
+  }
 };
 
-// an unordered map using object ids to access objects.
+// the objects of a level, stored in a pool per object type, in the
+// same way as tiles.
 struct ObjectMap {
-  // initialize an empty map and no ids (id starts from
-  // 0x01).
-  ObjectMap() : map(), max_id(NULL_ID) {}
+  // creates a new object, returns its id.
+  u32 create(ObjectType type);
+
+  // the pointer to the object, or nullptr if the id is invalid.
+  Object *get(u32 id);
+
+  // the const pointer to the object, or nullptr if the id is
+  // invalid.
+  const Object *get(u32 id) const;
 
-  ~ObjectMap() = default;
+  // removes an object; returns whether it existed.
+  bool erase(u32 id);
 
-  // return a new id, which is the id with the max value
-  // incremented by 1.
-  u32 generate_new_id() {
-    return ++max_id;
+  // removes every object.
+  void clear();
+
+  // number of objects.
+  usize size() const;
+
+  // the pools.
+  TypedPool<Box>       boxes;
+  TypedPool<OneDirBox> one_dir_boxes;
+  TypedPool<Player>    players;
+
+private:
+  // calls `fn(pool)` with the pool holding objects of a type.
+  template <typename F>
+  decltype(auto) with_pool(ObjectType type, F &&fn) {
+    switch (type) {
+    case ObjectType::Box:
+      return fn(boxes);
+    case ObjectType::OneDirBox:
+      return fn(one_dir_boxes);
+    case ObjectType::Player:
+      break;
+    }
+    return fn(players);
   }
+};
 
-  // the container itself.
-  std::unordered_map<u32, std::unique_ptr<Object>> map;
-  // used for generating ids.
-  u32 max_id;
+// the counts the game's level rules are checked against. each is
+// read off a pool or link map, so they stay up to date as the level
+// is edited and cost nothing to fetch.
+struct Counts {
+  // boxes, unidirectional included.
+  usize boxes;
+  usize goals;
+  usize players;
+  // portals without a partner.
+  usize unpaired_portals;
+  // buttons not linked to a door.
+  usize unlinked_buttons;
+  // doors not linked to any button.
+  usize unlinked_doors;
 };
 
 // contains and manages all tiles and objects.
 class Level {
 public:
   // constructor; apart from names, all other fields are
-  // defaults.
+  // defaults. the theme's assets need a window to load into, so
+  // they are only loaded by `load_theme_assets`.
   // clang-format off
   explicit Level(const std::string &name) : 
     name(name),
@@ -168,12 +257,15 @@ public:
     objects(),
     pos_tiles(),
     pos_objects(),
+    tile_positions(),
+    object_positions(),
     linked_portals(),
     door_to_buttons(),
-    button_to_door() 
-    {
-      load_theme_assets();
-    }
+    button_to_door(),
+    revision(0),
+    batch_depth(0),
+    batched_doors()
+    {}
 
   // clang-format on
 
@@ -186,7 +278,7 @@ public:
   void reset();
 
   // returns level name.
-  std::string_view get_name() noexcept {
+  std::string_view get_name() const noexcept {
     return name;
   }
 
@@ -195,6 +287,12 @@ public:
     name = str;
   }
 
+  // a counter bumped by every edit to the tiles, objects or links of
+  // the level, so changes can be noticed without comparing levels.
+  u64 get_revision() const noexcept {
+    return revision;
+  }
+
   // returns level condition.
   const Condition &get_condition() const noexcept {
     return condition;
@@ -205,16 +303,6 @@ public:
     return condition;
   }
 
-  // generates a new id for a new tile.
-  u32 generate_tile_id() {
-    return tiles.generate_new_id();
-  }
-
-  // generates a new id for a new object.
-  u32 generate_object_id() {
-    return objects.generate_new_id();
-  }
-
   // ===== themes =====
 
   // tries to load the assets needed for the current theme.
@@ -225,7 +313,7 @@ public:
   i32 load_theme_assets();
 
   // returns name of theme used.
-  std::string get_theme_name() noexcept {
+  std::string get_theme_name() const noexcept {
     return theme_name;
   }
 
@@ -280,13 +368,36 @@ public:
 
   // whether the position contains the tile.
   bool has_tile_at(const Position<> &pos) const {
-    return pos_tiles.find(pos) != pos_tiles.end();
+    return pos_tiles.contains(pos);
+  }
+
+  // the position of the tile, if it exists.
+  std::optional<Position<>> get_tile_position(u32 id) const;
+
+  // calls `fn(pos, tile_id)` for every tile, in no particular order.
+  template <typename F>
+  void for_each_tile(F &&fn) const {
+    pos_tiles.for_each(fn);
   }
 
+  // calls `fn(pos, tile_id)` for every tile inside the area between
+  // `min` and `max` (both inclusive).
+  template <typename F>
+  void for_each_tile_in(
+    const Position<> &min, const Position<> &max, F &&fn
+  ) const {
+    pos_tiles.for_each_in(min, max, fn);
+  }
+
+  // rotates the tile at the specified position clockwise;
+  // returns false if there is no tile with a direction there.
+  bool rotate_tile_at(const Position<> &pos);
+
   // updates door state (whether it is opened or closed).
   // is only opened if all of the linked buttons are
   // activated. if contains an object, keeps its current
-  // state.
+  // state. during a region operation, the update is deferred
+  // until the end of the operation.
   void update_door_state(u32 id);
 
   // ===== objects =====
@@ -318,6 +429,80 @@ public:
   // moves the object to another existing position.
   bool move_object(u32 id, const Position<> &new_pos);
 
+  // the position of the object, if it exists.
+  std::optional<Position<>> get_object_position(u32 id) const;
+
+  // rotates the object at the specified position clockwise;
+  // returns false if there is no object with a direction there.
+  bool rotate_object_at(const Position<> &pos);
+
+  // calls `fn(pos, object_id)` for every object, in no particular
+  // order.
+  template <typename F>
+  void for_each_object(F &&fn) const {
+    pos_objects.for_each(fn);
+  }
+
+  // calls `fn(pos, object_id)` for every object inside the area
+  // between `min` and `max` (both inclusive).
+  template <typename F>
+  void for_each_object_in(
+    const Position<> &min, const Position<> &max, F &&fn
+  ) const {
+    pos_objects.for_each_in(min, max, fn);
+  }
+
+  // ===== regions =====
+
+  // region operations are batched: each door's state is updated
+  // once, at the end of the operation, rather than after every cell.
+
+  // removes every object, then every tile, inside the area between
+  // `min` and `max` (both inclusive); returns the number of tiles
+  // and objects removed. takes time linear in the number removed.
+  usize clear_region(const Position<> &min, const Position<> &max);
+
+  // the state of the cell at a position, with its links stored as
+  // the positions of the linked tiles.
+  CellState cell_state(const Position<> &pos) const;
+
+  // copies the area between `min` and `max` (both inclusive).
+  Clip copy_region(const Position<> &min, const Position<> &max)
+    const;
+
+  // pastes a clip with its top left corner at `origin`, replacing
+  // the cells it holds; the other cells of the area are left as they
+  // are. returns false if the clip is empty.
+  bool paste(const Clip &clip, const Position<> &origin);
+
+  // transforms the area between `min` and `max` (both inclusive) in
+  // place, keeping its top left corner; returns the bottom right
+  // corner of the transformed area, or nothing if the area holds no
+  // tile.
+  std::optional<Position<>> transform_region(
+    const Position<> &min, const Position<> &max, Transform transform
+  );
+
+  // puts a tile of a type on every cell, keeping the objects on them
+  // if the new tile can hold one; returns the number of cells
+  // changed.
+  usize
+  fill_cells(const std::vector<Position<>> &cells, TileType type);
+
+  // removes the object, then the tile, on every cell; returns the
+  // number of tiles and objects removed.
+  usize clear_cells(const std::vector<Position<>> &cells);
+
+  // the cells inside the area between `min` and `max` (both
+  // inclusive) reachable from `start` through cells sharing a side
+  // and holding the same type of tile (or no tile), `start`
+  // included.
+  std::vector<Position<>> flood_region(
+    const Position<> &start,
+    const Position<> &min,
+    const Position<> &max
+  ) const;
+
   // ===== portal pairs =====
 
   // links two portals together.
@@ -339,12 +524,35 @@ public:
   // that button.
   bool unlink_button(u32 button_id);
 
-  // ===== json =====
+  // ===== validation =====
+
+  // the counts the level rules are checked against.
+  Counts counts() const noexcept;
+
+  // a description of every rule of the game the level breaks, in
+  // the order the game checks them; empty if the level can be
+  // played.
+  std::vector<std::string> broken_rules() const;
+
+  // the broken rules, and whether the theme failed to load; empty if
+  // the level can be exported.
+  std::vector<std::string> problems() const;
 
   // checks whether the level is valid enough to be exported.
-  bool is_valid();
+  bool is_valid() const;
 
 private:
+  // starts a batch, deferring door state updates until the outermost
+  // batch ends.
+  void begin_batch();
+
+  // ends a batch, updating the state of the doors touched during it.
+  void end_batch();
+
+  // adds the object of a cell state onto an existing tile, with its
+  // direction.
+  void restore_object(const Position<> &pos, const CellState &state);
+
   // the level name.
   std::string name;
   // name of theme used.
@@ -353,19 +561,30 @@ private:
   std::unique_ptr<Theme<Texture>> theme_assets;
   // level difficulty, move limit, and time limit.
   Condition condition;
-  // id -> tile.
+  // id -> tile, one pool per tile type.
   TileMap tiles;
-  // id -> object.
+  // id -> object, one pool per object type.
   ObjectMap objects;
   // position -> tile_id.
-  std::map<Position<>, u32> pos_tiles;
+  ChunkGrid<u32, NULL_ID> pos_tiles;
   // position -> object_id.
-  std::map<Position<>, u32> pos_objects;
+  ChunkGrid<u32, NULL_ID> pos_objects;
+  // tile_id -> position, the reverse of pos_tiles.
+  std::unordered_map<u32, Position<>> tile_positions;
+  // object_id -> position, the reverse of pos_objects.
+  std::unordered_map<u32, Position<>> object_positions;
   // linked portals, stores both portal 1 -> portal 2 and vice versa.
   std::unordered_map<u32, u32> linked_portals;
-  // stores door_id to its set of button_ids.
+  // stores door_id to its set of button_ids; doors without buttons
+  // have no entry.
   std::unordered_map<u32, std::unordered_set<u32>> door_to_buttons;
   // stores button_id to door_id.
   std::unordered_map<u32, u32> button_to_door;
+  // bumped by every edit, see get_revision.
+  u64 revision;
+  // number of open batches.
+  u32 batch_depth;
+  // doors whose state update is deferred until the batches end.
+  std::unordered_set<u32> batched_doors;
 };
 } // namespace sbokena::editor::level
@@ -1,41 +1,44 @@
 // A file containing implementations regarding importing a loaded
 // level into the editor (as an editor level) or exporting a loaded
-// level (as a game level).
+// level (as a game level). Editor levels are converted directly to
+// and from raw levels, which are written and read as level files
+// by the streaming functions in `level.hh`.
 
 #pragma once
 
-#include <nlohmann/json.hpp>
+#include <filesystem>
 
 #include "editor_level.hh"
-#include "loader.hh"
-#include "object.hh"
-#include "tile.hh"
-// TODO: include common/loaded_level.hh
+#include "level.hh"
 
-using nlohmann::json;
-using namespace sbokena::editor::level;
-using namespace sbokena::loader;
-
-// TODO: using namespace loaded_level
+namespace fs = std::filesystem;
 
 namespace Editor = sbokena::editor;
-namespace Loaded = sbokena::loader;
+
+using sbokena::level::RawLevel;
 
 namespace sbokena::editor::from_to_json {
 
-//  ===== objects =====
+// ===== level =====
 
-void from_json();
-void to_json(Editor::object::Object &object);
+// converts an editor level into a raw level. portal pairs and
+// door-button groups are numbered as they are found, in a single
+// pass over the tiles.
+RawLevel to_raw(const Editor::level::Level &level);
 
-// ===== tiles =====
+// replaces the contents of an editor level with a raw level. the
+// name and theme of the level are replaced as well.
+void from_raw(const RawLevel &raw, Editor::level::Level &level);
 
-void from_json();
-void to_json(Editor::tile::Tile &tile);
+// ===== files =====
 
-// ===== level =====
+// writes an editor level to a level file.
+// throws `std::runtime_error` if the file can't be written.
+void save(const Editor::level::Level &level, const fs::path &path);
 
-void from_json();
-void to_from(Editor::level::Level &level);
+// reads a level file into an editor level.
+// throws `std::runtime_error` if the file can't be read or isn't a
+// level, in which case the level is left as is.
+void load(Editor::level::Level &level, const fs::path &path);
 
 } // namespace sbokena::editor::from_to_json
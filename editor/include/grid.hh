@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <utility>
+
 #include <Window.hpp>
 #include <position.hh>
 
@@ -17,8 +19,18 @@ raylib::Vector2 refactored_grid_offset(
   raylib::Vector2 offset_pos, raylib::Vector2 point_pos, float scale
 );
 
-// returns the max position in the grid
-raylib::Vector2 grid_end(raylib::Vector2 offset_pos, float tile_size);
+// checks whether a position is on the grid, which has no fixed size
+// and extends right and down from its offset
+bool is_on_grid(raylib::Vector2 pos, raylib::Vector2 offset_pos);
+
+// returns the indices of the first and last tiles that are visible
+// in the specified area; if none are, the first is past the last
+std::pair<Position<>, Position<>> visible_tiles(
+  raylib::Vector2 offset,
+  float           size,
+  raylib::Vector2 min,
+  raylib::Vector2 max
+);
 
 // returns the index of the tile that has the specific position
 Position<>
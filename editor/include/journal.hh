@@ -0,0 +1,186 @@
+// A file implementing undo and redo for the editor. Every edit made
+// through the journal is recorded as an entry holding, for each cell
+// (position) it touched, the state of the cell before and after the
+// edit: its tile, with its direction, door state and links, and its
+// object, with its direction. Undoing or redoing an entry rebuilds
+// only those cells, so both take time proportional to the size of
+// the edit rather than the size of the level.
+//
+// Links are stored as the positions of the linked tiles, as ids are
+// not kept when cells are rebuilt. Since links are symmetric,
+// rebuilding a cell also restores the links of its partners.
+//
+// Edits made while a stroke is open (for example, while dragging
+// the mouse to paint) are merged into a single entry.
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "editor_level.hh"
+#include "object.hh"
+#include "position.hh"
+#include "region.hh"
+#include "tile.hh"
+
+using sbokena::editor::level::Level;
+using sbokena::editor::region::CellState;
+using sbokena::editor::region::Clip;
+using sbokena::editor::region::Transform;
+using sbokena::position::Position;
+
+namespace sbokena::editor::journal {
+
+// a cell touched by an edit, with its state before and after it.
+struct Cell {
+  Position<> pos;
+  CellState  before;
+  CellState  after;
+};
+
+// a single undoable edit.
+struct Entry {
+  std::vector<Cell> cells;
+};
+
+// records the edits made to a level, and undoes or redoes them.
+class Journal {
+public:
+  // constructs an empty journal over a level; the level must outlive
+  // the journal.
+  explicit Journal(Level &level) : level(level) {}
+
+  // ===== recorded edits =====
+
+  // same as Level::create_tile.
+  u32 create_tile(TileType type, const Position<> &pos);
+
+  // same as Level::replace_tile_at.
+  u32 replace_tile_at(const Position<> &pos, TileType type);
+
+  // same as Level::remove_tile.
+  bool remove_tile(u32 id);
+
+  // same as Level::remove_tile_at.
+  bool remove_tile_at(const Position<> &pos);
+
+  // same as Level::rotate_tile_at.
+  bool rotate_tile_at(const Position<> &pos);
+
+  // same as Level::add_object.
+  u32 add_object(ObjectType type, const Position<> &pos);
+
+  // same as Level::replace_object_at.
+  u32 replace_object_at(const Position<> &pos, ObjectType type);
+
+  // same as Level::remove_object.
+  bool remove_object(u32 id);
+
+  // same as Level::move_object.
+  bool move_object(u32 id, const Position<> &new_pos);
+
+  // same as Level::rotate_object_at.
+  bool rotate_object_at(const Position<> &pos);
+
+  // same as Level::link_portals.
+  bool link_portals(u32 id1, u32 id2);
+
+  // same as Level::link_door_button.
+  bool link_door_button(u32 door_id, u32 button_id);
+
+  // ===== region edits =====
+
+  // same as Level::clear_region.
+  usize clear_region(const Position<> &min, const Position<> &max);
+
+  // same as Level::paste.
+  bool paste(const Clip &clip, const Position<> &origin);
+
+  // same as Level::transform_region.
+  std::optional<Position<>> transform_region(
+    const Position<> &min, const Position<> &max, Transform transform
+  );
+
+  // same as Level::fill_cells.
+  usize
+  fill_cells(const std::vector<Position<>> &cells, TileType type);
+
+  // same as Level::clear_cells.
+  usize clear_cells(const std::vector<Position<>> &cells);
+
+  // ===== strokes =====
+
+  // starts merging the following edits into a single entry.
+  void begin_stroke();
+
+  // stops merging edits, and records the merged entry if any edit
+  // was made.
+  void end_stroke();
+
+  // whether a stroke is open.
+  bool in_stroke() const noexcept {
+    return stroke.has_value();
+  }
+
+  // ===== history =====
+
+  // undoes the last edit; returns false if there is none.
+  bool undo();
+
+  // redoes the last undone edit; returns false if there is none.
+  bool redo();
+
+  // whether there is an edit to undo.
+  bool can_undo() const noexcept {
+    return !done.empty();
+  }
+
+  // whether there is an edit to redo.
+  bool can_redo() const noexcept {
+    return !undone.empty();
+  }
+
+  // forgets every edit, for example after resetting the level.
+  void clear();
+
+private:
+  // the pending entry of an edit or stroke, indexing its cells by
+  // position.
+  struct Pending {
+    Entry                       entry;
+    std::map<Position<>, usize> index;
+  };
+
+  // records the state of the cells before calling `edit`, and adds
+  // the entry if it succeeded (returned a non-zero value).
+  template <typename F>
+  auto record(const std::vector<Position<>> &cells, F &&edit)
+    -> decltype(edit());
+
+  // adds the state of a cell to a pending entry, unless it is
+  // already part of it.
+  void touch(Pending &pending, const Position<> &pos) const;
+
+  // fills in the after states of a pending entry and adds it to the
+  // history.
+  void commit(Pending &pending);
+
+  // the current state of a cell.
+  CellState capture(const Position<> &pos) const;
+
+  // rebuilds the cells of an entry in either their before or after
+  // state.
+  void apply(const Entry &entry, bool after);
+
+  Level &level;
+  // edits that can be undone, the last one on top.
+  std::vector<Entry> done;
+  // edits that can be redone, the last undone one on top.
+  std::vector<Entry> undone;
+  // the entry of the open stroke, if any.
+  std::optional<Pending> stroke;
+};
+
+} // namespace sbokena::editor::journal
@@ -18,12 +18,13 @@ namespace sbokena::editor::object {
 enum class ObjectType { Box, OneDirBox, Player };
 
 // contains common traits of all object classes such as id
-// and type.
+// and type. objects are stored by value in a pool per type, so
+// there are no virtual functions; see object_cast.
 class Object {
 public:
   explicit Object(ObjectType type, u32 id) : type {type}, id {id} {}
 
-  virtual ~Object() = default;
+  ~Object() = default;
 
   ObjectType get_type() const {
     return type;
@@ -43,9 +44,11 @@ private:
 // level.
 class Player : public Object {
 public:
+  static constexpr ObjectType KIND = ObjectType::Player;
+
   // constructor; by default the direction is up.
   Player(u32 id)
-    : Object(ObjectType::Player, id),
+    : Object(KIND, id),
       dir(Direction::Up) {}
 
   // current direction of the player.
@@ -83,15 +86,19 @@ private:
 // the box; place it on a button to open the door.
 class Box : public Object {
 public:
-  Box(u32 id) : Object(ObjectType::Box, id) {}
+  static constexpr ObjectType KIND = ObjectType::Box;
+
+  Box(u32 id) : Object(KIND, id) {}
 };
 
 // same as the box but can only move in one way.
 class OneDirBox : public Object {
 public:
+  static constexpr ObjectType KIND = ObjectType::OneDirBox;
+
   // constructor; by default the direction is up.
   OneDirBox(u32 id)
-    : Object(ObjectType::OneDirBox, id),
+    : Object(KIND, id),
       dir(Direction::Up) {}
 
   // to which only direction to move on this tile.
@@ -126,4 +133,20 @@ private:
   Direction dir;
 };
 
+// casts an object to a specific type of object; returns nullptr if
+// the object is of another type.
+template <typename T>
+T *object_cast(Object *object) {
+  if (!object || object->get_type() != T::KIND)
+    return nullptr;
+  return static_cast<T *>(object);
+}
+
+template <typename T>
+const T *object_cast(const Object *object) {
+  if (!object || object->get_type() != T::KIND)
+    return nullptr;
+  return static_cast<const T *>(object);
+}
+
 } // namespace sbokena::editor::object
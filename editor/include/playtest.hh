@@ -0,0 +1,106 @@
+// A file implementing the editor's playtest mode. A playtest builds
+// the game's state machine (a `RawState`) straight from the editor's
+// level, in a single pass over its tiles and objects, and steps it
+// with the game's own rules. It only picks sprites out of the theme
+// the editor has already loaded, so starting or stopping a playtest
+// doesn't touch the disk or the GPU.
+//
+// The game's headers are only included by the implementation, as
+// their tile and object names clash with the editor's.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include <raylib.h>
+
+#include "direction.hh"
+#include "editor_level.hh"
+#include "position.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::editor::level::Level;
+using sbokena::position::Position;
+
+namespace sbokena::game::state {
+struct RawState;
+} // namespace sbokena::game::state
+
+namespace sbokena::editor::playtest {
+
+// a sprite of the level's theme.
+using Sprite = Theme<Texture>::SpriteIndex;
+
+// the result of a move.
+enum class Outcome {
+  // the player moved, and the level isn't complete yet.
+  Moved,
+  // the move was refused by the game's rules.
+  Blocked,
+  // the move completed the level.
+  Completed,
+};
+
+// a game in progress on the current state of an editor level.
+class Playtest {
+public:
+  // starts playing a level from its current state.
+  // throws `std::runtime_error` if the level breaks a rule of the
+  // game, and `loader::InvalidLevelException` if it is too large.
+  explicit Playtest(const Level &level);
+
+  ~Playtest();
+
+  Playtest(const Playtest &)            = delete;
+  Playtest &operator=(const Playtest &) = delete;
+
+  // moves the player one step, as in the game.
+  Outcome step(Direction dir);
+
+  // puts every object back where it started.
+  void restart();
+
+  // number of successful moves since the start.
+  usize moves() const noexcept {
+    return move_count;
+  }
+
+  // whether the level has been completed.
+  bool completed() const noexcept {
+    return complete;
+  }
+
+  // the revision of the level the playtest was started from.
+  u64 revision() const noexcept {
+    return start_revision;
+  }
+
+  // the sprite of the tile at a position, if it looks different
+  // while playing (doors open and close); nothing otherwise.
+  std::optional<Sprite> tile_sprite_at(Position<> pos) const;
+
+  // calls `fn(pos, sprite)` for every object inside the area between
+  // `min` and `max` (both inclusive).
+  void for_each_object_in(
+    const Position<>                              &min,
+    const Position<>                              &max,
+    const std::function<void(Position<>, Sprite)> &fn
+  ) const;
+
+private:
+  // the state at the start, and the state being played.
+  std::unique_ptr<const game::state::RawState> start;
+  std::unique_ptr<game::state::RawState>       state;
+
+  u64       start_revision;
+  Direction start_dir;
+  Direction player_dir;
+  usize     move_count = 0;
+  bool      complete   = false;
+};
+
+} // namespace sbokena::editor::playtest
@@ -0,0 +1,163 @@
+// A slot map storing the editor's tiles and objects by kind. Every
+// kind of tile or object has its own pool, a contiguous vector of
+// slots, and is referred to by a handle packing its kind, the slot
+// index and the slot generation into a single u32 id:
+//
+//   [ kind : 3 | generation : 7 | index : 22 ]
+//
+// Freed slots are reused, and bumping the generation of a slot on
+// every removal makes stale handles fail to resolve instead of
+// aliasing whatever takes the slot next. Generations start at 1, so
+// a valid handle is never 0x00 (NULL_ID).
+
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "types.hh"
+
+using namespace sbokena::types;
+
+namespace sbokena::editor::pool {
+
+inline constexpr u32 KIND_BITS  = 3;
+inline constexpr u32 GEN_BITS   = 7;
+inline constexpr u32 INDEX_BITS = 22;
+
+// the largest number of slots in a pool.
+inline constexpr u32 MAX_SLOTS = 1u << INDEX_BITS;
+
+// packs a kind, a generation and a slot index into a handle.
+constexpr u32 make_handle(u32 kind, u32 gen, u32 index) noexcept {
+  return (kind << (GEN_BITS + INDEX_BITS)) | (gen << INDEX_BITS)
+         | index;
+}
+
+// the kind of the tile or object a handle refers to.
+constexpr u32 kind_of(u32 handle) noexcept {
+  return handle >> (GEN_BITS + INDEX_BITS);
+}
+
+// the generation of the slot a handle refers to.
+constexpr u32 gen_of(u32 handle) noexcept {
+  return (handle >> INDEX_BITS) & ((1u << GEN_BITS) - 1);
+}
+
+// the index of the slot a handle refers to.
+constexpr u32 index_of(u32 handle) noexcept {
+  return handle & (MAX_SLOTS - 1);
+}
+
+// a pool of values of a single kind. pointers to values are
+// invalidated by inserting into the same pool, as with std::vector.
+template <typename T, u32 KIND>
+class Pool {
+  static_assert(KIND < (1u << KIND_BITS));
+
+public:
+  // constructs a new value, passing its handle as the first argument
+  // of its constructor, and returns the handle.
+  template <typename... Args>
+  u32 emplace(Args &&...args) {
+    u32 index;
+    if (!vacant.empty()) {
+      index = vacant.back();
+      vacant.pop_back();
+    } else {
+      if (slots.size() == MAX_SLOTS)
+        throw std::length_error("editor pool is full");
+      index = static_cast<u32>(slots.size());
+      slots.emplace_back();
+    }
+    Slot     &slot   = slots[index];
+    const u32 handle = make_handle(KIND, slot.gen, index);
+    slot.value.emplace(handle, std::forward<Args>(args)...);
+    ++count;
+    return handle;
+  }
+
+  // the value a handle refers to, or nullptr if it is stale or
+  // belongs to another pool.
+  T *get(u32 handle) noexcept {
+    Slot *slot = find(handle);
+    return slot ? &*slot->value : nullptr;
+  }
+
+  const T *get(u32 handle) const noexcept {
+    return const_cast<Pool *>(this)->get(handle);
+  }
+
+  // removes the value a handle refers to; returns whether there
+  // was one.
+  bool erase(u32 handle) {
+    Slot *slot = find(handle);
+    if (!slot)
+      return false;
+    release(*slot, index_of(handle));
+    return true;
+  }
+
+  // removes every value; handles to them become stale.
+  void clear() {
+    for (u32 i = 0; i < slots.size(); ++i)
+      if (slots[i].value)
+        release(slots[i], i);
+  }
+
+  // number of values in the pool.
+  usize size() const noexcept {
+    return count;
+  }
+
+  // calls `fn(value)` for every value, in slot order.
+  template <typename F>
+  void for_each(F &&fn) {
+    for (Slot &slot : slots)
+      if (slot.value)
+        fn(*slot.value);
+  }
+
+  template <typename F>
+  void for_each(F &&fn) const {
+    for (const Slot &slot : slots)
+      if (slot.value)
+        fn(*slot.value);
+  }
+
+private:
+  struct Slot {
+    std::optional<T> value;
+    u32              gen = 1;
+  };
+
+  // the live slot a handle refers to, if any.
+  Slot *find(u32 handle) noexcept {
+    if (kind_of(handle) != KIND)
+      return nullptr;
+    const u32 index = index_of(handle);
+    if (index >= slots.size())
+      return nullptr;
+    Slot &slot = slots[index];
+    if (!slot.value || slot.gen != gen_of(handle))
+      return nullptr;
+    return &slot;
+  }
+
+  // empties a slot, bumps its generation and makes it reusable.
+  void release(Slot &slot, u32 index) {
+    slot.value.reset();
+    slot.gen = slot.gen % ((1u << GEN_BITS) - 1) + 1;
+    vacant.push_back(index);
+    --count;
+  }
+
+  std::vector<Slot> slots;
+  // indices of the empty slots.
+  std::vector<u32> vacant;
+  usize            count = 0;
+};
+
+} // namespace sbokena::editor::pool
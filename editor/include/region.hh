@@ -0,0 +1,98 @@
+// A file implementing the data of the editor's region operations. A
+// clip is a copy of a rectangular region of a level, detached from
+// it: every cell holding a tile is stored with its offset from the
+// top left corner of the region, along with the state of its tile
+// and object (see `CellState`).
+//
+// Links between two cells of the clip are stored as offsets, so they
+// survive moving, rotating and mirroring the clip. Links to tiles
+// outside of it are kept as absolute positions, and are only made
+// again on paste if they don't take the linked tile away from
+// another link.
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "direction.hh"
+#include "object.hh"
+#include "position.hh"
+#include "tile.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::editor::object::ObjectType;
+using sbokena::editor::tile::TileType;
+using sbokena::position::Position;
+
+namespace sbokena::editor::region {
+
+// the state of a single cell of the level.
+struct CellState {
+  // the tile on the cell, if any.
+  std::optional<TileType> tile;
+  // the direction of a one direction floor or portal.
+  Direction tile_dir = Direction::Up;
+  // whether the door on the cell is opened.
+  bool opened = false;
+  // the positions of the linked portal, the buttons linked to a
+  // door or the door linked to a button.
+  std::vector<Position<>> links;
+  // the object on the cell, if any.
+  std::optional<ObjectType> object;
+  // the direction of a one direction box or player.
+  Direction object_dir = Direction::Up;
+
+  bool operator==(const CellState &) const = default;
+};
+
+// a cell of a clip.
+struct ClipCell {
+  // the position of the cell, relative to the top left corner.
+  Position<> offset;
+  // the state of the cell, where `links` holds the offsets of the
+  // linked cells inside the clip.
+  CellState state;
+  // the positions of the linked tiles outside the clip.
+  std::vector<Position<>> outside_links;
+};
+
+// a transform of a clip, in place.
+enum class Transform {
+  // a quarter turn clockwise.
+  Rotate,
+  // swaps left and right.
+  MirrorHorizontal,
+  // swaps up and down.
+  MirrorVertical,
+};
+
+// a copy of a rectangular region of a level.
+struct Clip {
+  // the size of the region, in cells.
+  u32 width  = 0;
+  u32 height = 0;
+  // the cells holding a tile, in no particular order.
+  std::vector<ClipCell> cells;
+
+  // whether the clip holds no tile.
+  bool empty() const noexcept {
+    return cells.empty();
+  }
+
+  // transforms the clip: moves its cells and links, and turns the
+  // directions of its floors, portals, boxes and player to match.
+  void apply(Transform transform);
+};
+
+// a direction after a transform.
+Direction transformed(Direction dir, Transform transform);
+
+// every cell of the area between `min` and `max` (both inclusive),
+// row by row.
+std::vector<Position<>>
+cells_in(const Position<> &min, const Position<> &max);
+
+} // namespace sbokena::editor::region
@@ -0,0 +1,88 @@
+// A file implementing the editor's background solvability check.
+// Every time the level changes, a snapshot of it (as a raw level) is
+// handed to a worker thread, which validates it as the game would
+// and runs the game's solver on it. A newer snapshot cancels the
+// run in progress, and the result of the last finished run is kept
+// so the editor can keep showing it while the next one runs.
+//
+// Submitting a snapshot and reading the result only take a lock
+// for as long as it takes to move the snapshot, so the edit loop
+// never waits on the solver.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include "level.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::level::RawLevel;
+
+namespace sbokena::editor::solve_check {
+
+// the outcome of a check.
+enum class Verdict {
+  // no check has finished yet.
+  None,
+  // the level breaks one of the game's rules (see
+  // `loader::LevelData`), so it can't be played at all.
+  Invalid,
+  // the level can be completed.
+  Solvable,
+  // the level can't be completed from its starting state.
+  Unsolvable,
+  // the solver ran out of nodes before reaching either answer.
+  Unknown,
+};
+
+// the result of the last finished check.
+struct Report {
+  Verdict verdict = Verdict::None;
+  // the least number of moves completing the level, if solvable.
+  usize moves = 0;
+  // number of states the solver visited.
+  usize nodes = 0;
+  // whether a newer snapshot is being checked.
+  bool checking = false;
+};
+
+// runs the checks on a worker thread owned by the checker.
+class Checker {
+public:
+  // starts the worker thread, which waits for a first snapshot.
+  Checker();
+
+  // cancels the check in progress and joins the worker thread.
+  ~Checker();
+
+  Checker(const Checker &)            = delete;
+  Checker &operator=(const Checker &) = delete;
+
+  // hands a snapshot of the level to the worker, cancelling the
+  // check in progress, if any.
+  void submit(RawLevel level);
+
+  // the result of the last finished check.
+  Report report() const;
+
+private:
+  // the worker thread's loop.
+  void run(std::stop_token stop);
+
+  mutable std::mutex          mutex;
+  std::condition_variable_any wake;
+  // the latest snapshot not yet picked up by the worker.
+  std::optional<RawLevel> pending;
+  // cancels the check in progress.
+  std::stop_source cancel;
+  Report           last;
+  // declared last, so it is joined before the rest is destroyed.
+  std::jthread worker;
+};
+
+} // namespace sbokena::editor::solve_check
@@ -33,7 +33,9 @@ enum class TileType {
 };
 
 // A class containing common fields and functions that all
-// tiles share.
+// tiles share. Tiles are stored by value in a pool per type, so
+// there are no virtual functions; the type field tells which class
+// a tile is, see tile_cast.
 class Tile {
 public:
   // construct a new tile, contains no object by default.
@@ -44,7 +46,7 @@ public:
       obj_id(NULL_ID) {}
 
   // default destructor.
-  virtual ~Tile() = default;
+  ~Tile() = default;
 
   // returns tile type.
   TileType get_type() const {
@@ -57,22 +59,23 @@ public:
   }
 
   // if there is an object on the tile.
-  virtual bool contains_obj() const {
+  bool contains_obj() const {
     return (obj_id != NULL_ID);
   }
 
   // tile's object id.
-  virtual u32 get_obj_id() const {
+  u32 get_obj_id() const {
     return obj_id;
   }
 
-  // object goes on tile.
-  virtual void set_obj_id(const u32 &new_id) {
-    obj_id = new_id;
+  // object goes on tile; an object cannot be on a roof.
+  void set_obj_id(const u32 &new_id) {
+    if (type != TileType::Roof)
+      obj_id = new_id;
   }
 
   // object goes off tile.
-  virtual void remove_obj_id() {
+  void remove_obj_id() {
     obj_id = NULL_ID;
   }
 
@@ -87,32 +90,20 @@ private:
 // any object.
 class Roof : public Tile {
 public:
-  // construct a new roof.
-  explicit Roof(u32 id) : Tile(TileType::Roof, id) {}
-
-  // does not contain object.
-  bool contains_obj() const override {
-    return false;
-  }
+  static constexpr TileType KIND = TileType::Roof;
 
-  // no object, no id.
-  u32 get_obj_id() const override {
-    return NULL_ID;
-  }
-
-  // object cannot be on roof.
-  void set_obj_id(const u32 &) override {}
-
-  // does not have object to remove to begin with.
-  void remove_obj_id() override {}
+  // construct a new roof.
+  explicit Roof(u32 id) : Tile(KIND, id) {}
 };
 
 // The basic, most common type of non-roof tile. Can contain
 // an object.
 class Floor : public Tile {
 public:
+  static constexpr TileType KIND = TileType::Floor;
+
   // construct a new floor.
-  Floor(u32 id) : Tile(TileType::Floor, id) {}
+  Floor(u32 id) : Tile(KIND, id) {}
 };
 
 // Similar to floor but only lets object move into it
@@ -120,10 +111,12 @@ public:
 // object can only move the opposite way.
 class OneDir : public Tile {
 public:
+  static constexpr TileType KIND = TileType::OneDir;
+
   // construct a new one direction floor.
   // by default the direction into the tile is up.
   OneDir(u32 id)
-    : Tile(TileType::OneDir, id),
+    : Tile(KIND, id),
       dir_in(Direction::Up) {}
 
   // which only direction for the object to move into this
@@ -185,7 +178,9 @@ private:
 // completed.
 class Goal : public Tile {
 public:
-  Goal(u32 id) : Tile(TileType::Goal, id) {}
+  static constexpr TileType KIND = TileType::Goal;
+
+  Goal(u32 id) : Tile(KIND, id) {}
 };
 
 // Can teleport objects to the linked portal.
@@ -193,11 +188,13 @@ public:
 // specific way and its opposite way respectively.
 class Portal : public Tile {
 public:
+  static constexpr TileType KIND = TileType::Portal;
+
   // construct a new portal, by default is unlinked to
   // another portal. by default the direction into the tile
   // is up.
   Portal(u32 id)
-    : Tile(TileType::Portal, id),
+    : Tile(KIND, id),
       portal_id(NULL_ID),
       dir_in(Direction::Up) {}
 
@@ -284,8 +281,10 @@ class Door : public Tile {
 public:
   // constructs a new door, by default isn't linked to another button
   // and isn't opened.
+  static constexpr TileType KIND = TileType::Door;
+
   Door(u32 id)
-    : Tile(TileType::Door, id),
+    : Tile(KIND, id),
       button_ids(),
       opened(false) {}
 
@@ -357,8 +356,10 @@ private:
 // Is linked to a door, tries to it when contains an object (pressed).
 class Button : public Tile {
 public:
+  static constexpr TileType KIND = TileType::Button;
+
   // constructs a new button, by default isn't linked to another door.
-  Button(u32 id) : Tile(TileType::Button, id), door_id(NULL_ID) {}
+  Button(u32 id) : Tile(KIND, id), door_id(NULL_ID) {}
 
   // links the button to a door.
   void link(u32 linked_id) {
@@ -384,4 +385,20 @@ private:
   u32 door_id;
 };
 
+// casts a tile to a specific type of tile; returns nullptr if the
+// tile is of another type.
+template <typename T>
+T *tile_cast(Tile *tile) {
+  if (!tile || tile->get_type() != T::KIND)
+    return nullptr;
+  return static_cast<T *>(tile);
+}
+
+template <typename T>
+const T *tile_cast(const Tile *tile) {
+  if (!tile || tile->get_type() != T::KIND)
+    return nullptr;
+  return static_cast<const T *>(tile);
+}
+
 } // namespace sbokena::editor::tile
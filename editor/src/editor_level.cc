@@ -1,19 +1,26 @@
 #include "editor_level.hh"
 
 #include <filesystem>
+#include <format>
 #include <memory>
 #include <optional>
+#include <set>
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <raylib.h>
 
 #include "loader.hh"
 #include "object.hh"
+#include "region.hh"
 #include "tile.hh"
 #include "types.hh"
 
 using namespace sbokena::position;
+using sbokena::editor::region::ClipCell;
 using namespace sbokena::editor::tile;
 using namespace sbokena::editor::object;
 
@@ -21,22 +28,102 @@ namespace fs = std::filesystem;
 
 namespace sbokena::editor::level {
 
+// ===== tile and object maps =====
+
+// creates a new tile, returns its id.
+u32 TileMap::create(TileType type) {
+  return with_pool(type, [](auto &pool) { return pool.emplace(); });
+}
+
+// the pointer to the tile, or nullptr if the id is invalid.
+Tile *TileMap::get(u32 id) {
+  const auto type = static_cast<TileType>(pool::kind_of(id));
+  return with_pool(type, [&](auto &pool) -> Tile * {
+    return pool.get(id);
+  });
+}
+
+// the const pointer to the tile, or nullptr if the id is invalid.
+const Tile *TileMap::get(u32 id) const {
+  return const_cast<TileMap *>(this)->get(id);
+}
+
+// removes a tile; returns whether it existed.
+bool TileMap::erase(u32 id) {
+  const auto type = static_cast<TileType>(pool::kind_of(id));
+  return with_pool(type, [&](auto &pool) { return pool.erase(id); });
+}
+
+// removes every tile.
+void TileMap::clear() {
+  roofs.clear();
+  floors.clear();
+  one_dirs.clear();
+  goals.clear();
+  portals.clear();
+  doors.clear();
+  buttons.clear();
+}
+
+// number of tiles.
+usize TileMap::size() const {
+  return roofs.size() + floors.size() + one_dirs.size()
+         + goals.size() + portals.size() + doors.size()
+         + buttons.size();
+}
+
+// creates a new object, returns its id.
+u32 ObjectMap::create(ObjectType type) {
+  return with_pool(type, [](auto &pool) { return pool.emplace(); });
+}
+
+// the pointer to the object, or nullptr if the id is invalid.
+Object *ObjectMap::get(u32 id) {
+  const auto type = static_cast<ObjectType>(pool::kind_of(id));
+  return with_pool(type, [&](auto &pool) -> Object * {
+    return pool.get(id);
+  });
+}
+
+// the const pointer to the object, or nullptr if the id is invalid.
+const Object *ObjectMap::get(u32 id) const {
+  return const_cast<ObjectMap *>(this)->get(id);
+}
+
+// removes an object; returns whether it existed.
+bool ObjectMap::erase(u32 id) {
+  const auto type = static_cast<ObjectType>(pool::kind_of(id));
+  return with_pool(type, [&](auto &pool) { return pool.erase(id); });
+}
+
+// removes every object.
+void ObjectMap::clear() {
+  boxes.clear();
+  one_dir_boxes.clear();
+  players.clear();
+}
+
+// number of objects.
+usize ObjectMap::size() const {
+  return boxes.size() + one_dir_boxes.size() + players.size();
+}
+
 // resets the level back the empty default template but keep
 // the name.
 void Level::reset() {
   // clears all stored elements.
-  tiles.map.clear();
-  objects.map.clear();
+  tiles.clear();
+  objects.clear();
   pos_tiles.clear();
   pos_objects.clear();
+  tile_positions.clear();
+  object_positions.clear();
   linked_portals.clear();
   door_to_buttons.clear();
   button_to_door.clear();
-  // resets the max id counters.
-  tiles.max_id   = NULL_ID;
-  objects.max_id = NULL_ID;
   // resets the condition.
   condition = Condition();
+  ++revision;
 }
 
 // ===== themes =====
@@ -94,14 +181,14 @@ Texture Level::tile_sprite_at(Position<> pos) const {
     return *sprites[theme_assets->BUTTON];
     break;
   case TileType::Door: {
-    const Door *door = dynamic_cast<const Door *>(tile);
+    const Door *door = tile_cast<Door>(tile);
     bool        open = door->is_opened();
     return *sprites
       [open ? theme_assets->DOOR_OPEN : theme_assets->DOOR_CLOSED];
     break;
   }
   case TileType::Portal: {
-    const Portal *portal = dynamic_cast<const Portal *>(tile);
+    const Portal *portal = tile_cast<Portal>(tile);
     Direction     dir    = portal->get_dir_in();
     switch (dir) {
     case Direction::Up:
@@ -120,7 +207,7 @@ Texture Level::tile_sprite_at(Position<> pos) const {
     break;
   }
   case TileType::OneDir: {
-    const OneDir *onedir = dynamic_cast<const OneDir *>(tile);
+    const OneDir *onedir = tile_cast<OneDir>(tile);
     Direction     dir    = onedir->get_dir_in();
     switch (dir) {
     case Direction::Up:
@@ -169,7 +256,7 @@ std::optional<Texture> Level::object_sprite_at(Position<> pos) const {
     return *sprites[theme_assets->BOX];
     break;
   case ObjectType::OneDirBox: {
-    const OneDirBox *box = dynamic_cast<const OneDirBox *>(object);
+    const OneDirBox *box = object_cast<OneDirBox>(object);
     switch (box->get_dir()) {
     case Direction::Up:
       return *sprites[theme_assets->DIRBOX_N];
@@ -186,7 +273,7 @@ std::optional<Texture> Level::object_sprite_at(Position<> pos) const {
     break;
   }
   case ObjectType::Player: {
-    const Player *player = dynamic_cast<const Player *>(object);
+    const Player *player = object_cast<Player>(object);
     switch (player->get_dir()) {
     case Direction::Up:
       return *sprites[theme_assets->PLAYER_N];
@@ -210,41 +297,15 @@ std::optional<Texture> Level::object_sprite_at(Position<> pos) const {
 // creates a new tile, takes a type and a position as
 // parameters.
 u32 Level::create_tile(TileType type, const Position<> &pos) {
-  u32 id;
   // if a tile already exists at the position, cannot create a new
   // tile.
-  auto it = pos_tiles.find(pos);
-  if (it != pos_tiles.end())
+  if (pos_tiles.contains(pos))
     return NULL_ID;
   // creates a new tile at the position.
-  id = this->generate_tile_id();
-  std::unique_ptr<Tile> tile;
-  switch (type) {
-  case TileType::Roof:
-    tile = std::make_unique<Roof>(id);
-    break;
-  case TileType::Floor:
-    tile = std::make_unique<Floor>(id);
-    break;
-  case TileType::OneDir:
-    tile = std::make_unique<OneDir>(id);
-    break;
-  case TileType::Goal:
-    tile = std::make_unique<Goal>(id);
-    break;
-  case TileType::Portal:
-    tile = std::make_unique<Portal>(id);
-    break;
-  case TileType::Door:
-    tile = std::make_unique<Door>(id);
-    break;
-  case TileType::Button:
-    tile = std::make_unique<Button>(id);
-    break;
-  }
-
-  pos_tiles[pos] = id;
-  tiles.map[id]  = std::move(tile);
+  const u32 id = tiles.create(type);
+  pos_tiles.set(pos, id);
+  tile_positions.emplace(id, pos);
+  ++revision;
   return id;
 }
 
@@ -284,68 +345,85 @@ bool Level::remove_tile(u32 id) {
   default:
     break;
   }
-  // removes from pos_tiles (position -> id).
-  for (auto it = pos_tiles.begin(); it != pos_tiles.end(); ++it) {
-    if (it->second == id) {
-      pos_tiles.erase(it);
-      break;
-    }
+  // removes from pos_tiles (position -> id) and its reverse.
+  auto pos_it = tile_positions.find(id);
+  if (pos_it != tile_positions.end()) {
+    pos_tiles.erase(pos_it->second);
+    tile_positions.erase(pos_it);
   }
   // removes from tile map.
-  tiles.map.erase(id);
+  tiles.erase(id);
+  ++revision;
   return true;
 }
 
 // removes the tile at the specified position.
 bool Level::remove_tile_at(const Position<> &pos) {
-  auto it = pos_tiles.find(pos);
+  const u32 id = pos_tiles.get(pos);
   // if the position contains no tile then cant remove tile.
-  if (it == pos_tiles.end())
+  if (id == NULL_ID)
     return false;
   // else removes tile normally.
-  return remove_tile(it->second);
+  return remove_tile(id);
 }
 
 // the pointer to the tile.
 Tile *Level::get_tile(u32 id) {
-  auto it = tiles.map.find(id);
-  // if id doesn't exist return nullptr.
-  if (it == tiles.map.end())
-    return nullptr;
-  // else returns the tile pointer.
-  return it->second.get();
+  // if id doesn't exist returns nullptr.
+  return tiles.get(id);
 }
 
 // the const pointer to the tile.
 const Tile *Level::get_tile(u32 id) const {
-  auto it = tiles.map.find(id);
-  // if id doesn't exist return nullptr.
-  if (it == tiles.map.end())
-    return nullptr;
-  // else returns the tile pointer.
-  return it->second.get();
-};
+  // if id doesn't exist returns nullptr.
+  return tiles.get(id);
+}
 
 // returns the pointer to the tile at the specified
 // position.
 Tile *Level::get_tile_at(const Position<> &pos) {
-  auto it = pos_tiles.find(pos);
+  const u32 id = pos_tiles.get(pos);
   // if the position contains no tile then returns nullptr.
-  if (it == pos_tiles.end())
+  if (id == NULL_ID)
     return nullptr;
   // else returns the tile pointer.
-  return get_tile(it->second);
+  return get_tile(id);
 }
 
 // returns the const pointer to the tile at the specified
 // position.
 const Tile *Level::get_tile_at(const Position<> &pos) const {
-  auto it = pos_tiles.find(pos);
+  const u32 id = pos_tiles.get(pos);
   // if the position contains no tile then returns nullptr.
-  if (it == pos_tiles.end())
+  if (id == NULL_ID)
     return nullptr;
   // else returns the tile pointer.
-  return get_tile(it->second);
+  return get_tile(id);
+}
+
+// the position of the tile, if it exists.
+std::optional<Position<>> Level::get_tile_position(u32 id) const {
+  auto it = tile_positions.find(id);
+  if (it == tile_positions.end())
+    return std::nullopt;
+  return it->second;
+}
+
+// rotates the tile at the specified position clockwise; returns
+// false if there is no tile with a direction there.
+bool Level::rotate_tile_at(const Position<> &pos) {
+  Tile *tile = get_tile_at(pos);
+  if (OneDir *one_dir = tile_cast<OneDir>(tile)) {
+    one_dir->rotate();
+    ++revision;
+    return true;
+  }
+  if (Portal *portal = tile_cast<Portal>(tile)) {
+    portal->rotate();
+    ++revision;
+    return true;
+  }
+  return false;
 }
 
 // updates door state (whether it is opened or closed).
@@ -353,9 +431,14 @@ const Tile *Level::get_tile_at(const Position<> &pos) const {
 // activated. if contains an object, keeps its current
 // state.
 void Level::update_door_state(u32 id) {
+  // during a batch, the door is updated once, when it ends.
+  if (batch_depth > 0) {
+    batched_doors.insert(id);
+    return;
+  }
   // if the door doesn't exist, or if there is an object on
   // it, does nothing.
-  Door *door = dynamic_cast<Door *>(get_tile(id));
+  Door *door = tile_cast<Door>(get_tile(id));
   if (!door || door->contains_obj())
     return;
   // if the door is unlinked, closes it.
@@ -368,7 +451,7 @@ void Level::update_door_state(u32 id) {
   // (contain object).
   bool all_pressed = true;
   for (auto b_id : it->second) {
-    Button *button = dynamic_cast<Button *>(get_tile(b_id));
+    Button *button = tile_cast<Button>(get_tile(b_id));
     if (!button || !button->contains_obj()) {
       all_pressed = false;
       break;
@@ -398,22 +481,11 @@ u32 Level::add_object(ObjectType type, const Position<> &pos) {
   if (tile->contains_obj())
     return NULL_ID;
   // else adds an object.
-  u32                     id = this->generate_object_id();
-  std::unique_ptr<Object> object;
-  switch (type) {
-  case ObjectType::Box:
-    object = std::make_unique<Box>(id);
-    break;
-  case ObjectType::OneDirBox:
-    object = std::make_unique<OneDirBox>(id);
-    break;
-  case ObjectType::Player:
-    object = std::make_unique<Player>(id);
-    break;
-  }
+  const u32 id = objects.create(type);
   tile->set_obj_id(id);
-  objects.map[id]  = std::move(object);
-  pos_objects[pos] = id;
+  pos_objects.set(pos, id);
+  object_positions.emplace(id, pos);
+  ++revision;
 
   // update linked door state if placed tile is a button or
   // a door.
@@ -447,22 +519,14 @@ u32 Level::replace_object_at(const Position<> &pos, ObjectType type) {
 
 // removes an object.
 bool Level::remove_object(u32 id) {
-  auto it = objects.map.find(id);
   // check if the object exists.
-  if (it == objects.map.end())
+  if (!objects.get(id))
     return false;
   // find current position of the object.
-  Position<> pos;
-  bool       found = false;
-  for (auto &pair : pos_objects) {
-    if (pair.second == id) {
-      pos   = pair.first;
-      found = true;
-      break;
-    }
-  }
-  if (!found)
+  auto pos_it = object_positions.find(id);
+  if (pos_it == object_positions.end())
     return false;
+  const Position<> pos = pos_it->second;
   // removes the object_id in the tile the object is on.
   Tile *cleanup = get_tile_at(pos);
   if (!cleanup)
@@ -479,49 +543,45 @@ bool Level::remove_object(u32 id) {
       update_door_state(cleanup->get_id());
     }
   }
-  // removes from pos_objects (position -> id).
+  // removes from pos_objects (position -> id) and its reverse.
   pos_objects.erase(pos);
+  object_positions.erase(pos_it);
   // removes from object map.
-  objects.map.erase(it);
+  objects.erase(id);
+  ++revision;
   return true;
 };
 
 // the pointer to the object.
 Object *Level::get_object(u32 id) {
-  auto it = objects.map.find(id);
-  if (it == objects.map.end())
-    return nullptr;
-  return it->second.get();
-};
+  return objects.get(id);
+}
 
 // the const pointer to the object.
 const Object *Level::get_object(u32 id) const {
-  auto it = objects.map.find(id);
-  if (it == objects.map.end())
-    return nullptr;
-  return it->second.get();
+  return objects.get(id);
 }
 
 // returns the pointer to the object at the specified
 // position.
 Object *Level::get_object_at(const Position<> &pos) {
-  auto it = pos_objects.find(pos);
+  const u32 id = pos_objects.get(pos);
   // if the position contains no object then returns nullptr.
-  if (it == pos_objects.end())
+  if (id == NULL_ID)
     return nullptr;
   // else returns the object pointer.
-  return get_object(it->second);
+  return get_object(id);
 };
 
 // returns the const pointer to the object at the specified
 // position.
 const Object *Level::get_object_at(const Position<> &pos) const {
-  auto it = pos_objects.find(pos);
+  const u32 id = pos_objects.get(pos);
   // if the position contains no object then returns nullptr.
-  if (it == pos_objects.end())
+  if (id == NULL_ID)
     return nullptr;
   // else returns the object pointer.
-  return get_object(it->second);
+  return get_object(id);
 }
 
 // moves the object to another existing position.
@@ -540,17 +600,10 @@ bool Level::move_object(u32 id, const Position<> &new_pos) {
     return false;
   // finds the current position of the object, if failed, returns
   // false.
-  Position<> old_pos;
-  bool       exists = false;
-  for (auto &pair : pos_objects) {
-    if (pair.second == id) {
-      old_pos = pair.first;
-      exists  = true;
-      break;
-    }
-  }
-  if (!exists)
+  auto pos_it = object_positions.find(id);
+  if (pos_it == object_positions.end())
     return false;
+  const Position<> old_pos = pos_it->second;
   // removes the object_id in the old tile.
   Tile *cleanup = get_tile_at(old_pos);
   if (!cleanup)
@@ -560,8 +613,10 @@ bool Level::move_object(u32 id, const Position<> &new_pos) {
   pos_objects.erase(old_pos);
   // places the object on a new tile and sets a new
   tile->set_obj_id(id);
-  // adds new position entry in pos_objects.
-  pos_objects[new_pos] = id;
+  // adds new position entry in pos_objects and its reverse.
+  pos_objects.set(new_pos, id);
+  pos_it->second = new_pos;
+  ++revision;
   // update the state of possible linked doors in the old and new
   // tile.
   auto update = [&](Tile *t) {
@@ -581,6 +636,354 @@ bool Level::move_object(u32 id, const Position<> &new_pos) {
   return true;
 }
 
+// the position of the object, if it exists.
+std::optional<Position<>> Level::get_object_position(u32 id) const {
+  auto it = object_positions.find(id);
+  if (it == object_positions.end())
+    return std::nullopt;
+  return it->second;
+}
+
+// rotates the object at the specified position clockwise; returns
+// false if there is no object with a direction there.
+bool Level::rotate_object_at(const Position<> &pos) {
+  Object *object = get_object_at(pos);
+  if (OneDirBox *box = object_cast<OneDirBox>(object)) {
+    box->rotate();
+    ++revision;
+    return true;
+  }
+  if (Player *player = object_cast<Player>(object)) {
+    player->rotate();
+    ++revision;
+    return true;
+  }
+  return false;
+}
+
+// ===== regions =====
+
+// removes every object, then every tile, inside the area between
+// `min` and `max` (both inclusive); returns the number of tiles and
+// objects removed.
+usize Level::clear_region(
+  const Position<> &min, const Position<> &max
+) {
+  // collects the ids first, as removing invalidates the iteration.
+  std::vector<u32> ids;
+  pos_objects.for_each_in(min, max, [&](const Position<> &, u32 id) {
+    ids.push_back(id);
+  });
+  begin_batch();
+  usize removed = 0;
+  for (u32 id : ids)
+    removed += remove_object(id);
+  // objects are gone, so none of the tiles are occupied anymore.
+  ids.clear();
+  pos_tiles.for_each_in(min, max, [&](const Position<> &, u32 id) {
+    ids.push_back(id);
+  });
+  for (u32 id : ids)
+    removed += remove_tile(id);
+  end_batch();
+  return removed;
+}
+
+// the state of the cell at a position, with its links stored as the
+// positions of the linked tiles.
+CellState Level::cell_state(const Position<> &pos) const {
+  CellState state;
+  const auto link = [&](u32 id) {
+    if (const auto linked = get_tile_position(id))
+      state.links.push_back(*linked);
+  };
+
+  const Tile *tile = get_tile_at(pos);
+  if (tile) {
+    state.tile = tile->get_type();
+    if (const OneDir *one_dir = tile_cast<OneDir>(tile)) {
+      state.tile_dir = one_dir->get_dir_in();
+    } else if (const Portal *portal = tile_cast<Portal>(tile)) {
+      state.tile_dir = portal->get_dir_in();
+      if (portal->is_linked())
+        link(portal->get_linked());
+    } else if (const Door *door = tile_cast<Door>(tile)) {
+      state.opened = door->is_opened();
+      for (u32 button_id : door->get_linked_vector())
+        link(button_id);
+    } else if (const Button *button = tile_cast<Button>(tile)) {
+      if (button->is_linked())
+        link(button->get_linked());
+    }
+  }
+
+  const Object *object = get_object_at(pos);
+  if (object) {
+    state.object = object->get_type();
+    if (const OneDirBox *box = object_cast<OneDirBox>(object))
+      state.object_dir = box->get_dir();
+    else if (const Player *player = object_cast<Player>(object))
+      state.object_dir = player->get_dir();
+  }
+
+  return state;
+}
+
+// copies the area between `min` and `max` (both inclusive).
+Clip Level::copy_region(
+  const Position<> &min, const Position<> &max
+) const {
+  Clip clip;
+  if (min.x > max.x || min.y > max.y)
+    return clip;
+  clip.width  = max.x - min.x + 1;
+  clip.height = max.y - min.y + 1;
+
+  const auto inside = [&](const Position<> &pos) {
+    return pos.x >= min.x && pos.x <= max.x && pos.y >= min.y
+        && pos.y <= max.y;
+  };
+  // objects are only ever on tiles, so visiting the tiles is enough.
+  pos_tiles.for_each_in(min, max, [&](const Position<> &pos, u32) {
+    ClipCell cell;
+    cell.offset = {pos.x - min.x, pos.y - min.y};
+    cell.state  = cell_state(pos);
+    // links inside the area become offsets, the others stay as
+    // positions.
+    std::vector<Position<>> links;
+    for (const auto &linked : cell.state.links) {
+      if (inside(linked))
+        links.push_back({linked.x - min.x, linked.y - min.y});
+      else
+        cell.outside_links.push_back(linked);
+    }
+    cell.state.links = std::move(links);
+    clip.cells.push_back(std::move(cell));
+  });
+  return clip;
+}
+
+// pastes a clip with its top left corner at `origin`, replacing the
+// cells it holds. returns false if the clip is empty.
+bool Level::paste(const Clip &clip, const Position<> &origin) {
+  if (clip.empty())
+    return false;
+  const auto at = [&](const Position<> &offset) {
+    return Position<> {origin.x + offset.x, origin.y + offset.y};
+  };
+
+  begin_batch();
+  // the indices grow by at most the size of the clip, so they are
+  // resized once rather than as the cells are added.
+  tile_positions.reserve(tile_positions.size() + clip.cells.size());
+  object_positions.reserve(
+    object_positions.size() + clip.cells.size()
+  );
+
+  // clears the cells; objects go first, as tiles with an object on
+  // them can't be removed.
+  for (const auto &cell : clip.cells)
+    if (const Object *object = get_object_at(at(cell.offset)))
+      (void)remove_object(object->get_id());
+  for (const auto &cell : clip.cells)
+    (void)remove_tile_at(at(cell.offset));
+
+  // rebuilds the tiles.
+  for (const auto &cell : clip.cells) {
+    const Position<> pos = at(cell.offset);
+    (void)create_tile(*cell.state.tile, pos);
+    Tile *tile = get_tile_at(pos);
+    if (OneDir *one_dir = tile_cast<OneDir>(tile))
+      one_dir->set_dir_in(cell.state.tile_dir);
+    else if (Portal *portal = tile_cast<Portal>(tile))
+      portal->set_dir_in(cell.state.tile_dir);
+  }
+
+  // relinks the tiles. a link inside the clip is made from both of
+  // its sides, the second time being harmlessly refused or repeated.
+  // a link to a tile outside the clip is only made if it doesn't
+  // take that tile away from another link.
+  for (const auto &cell : clip.cells) {
+    const TileType type = *cell.state.tile;
+    const u32      id   = get_tile_at(at(cell.offset))->get_id();
+    const auto     link = [&](const Tile *linked, bool outside) {
+      if (!linked)
+        return;
+      switch (type) {
+      case TileType::Portal:
+        (void)link_portals(id, linked->get_id());
+        break;
+      case TileType::Door: {
+        const Button *button = tile_cast<Button>(linked);
+        if (button && !(outside && button->is_linked()))
+          (void)link_door_button(id, button->get_id());
+        break;
+      }
+      case TileType::Button:
+        (void)link_door_button(linked->get_id(), id);
+        break;
+      default:
+        break;
+      }
+    };
+    for (const auto &offset : cell.state.links)
+      link(get_tile_at(at(offset)), false);
+    for (const auto &pos : cell.outside_links)
+      link(get_tile_at(pos), true);
+  }
+
+  // restores the door states, then the objects; a door with an
+  // object on it keeps the state it was copied with.
+  for (const auto &cell : clip.cells) {
+    Door *door = tile_cast<Door>(get_tile_at(at(cell.offset)));
+    if (!door)
+      continue;
+    if (cell.state.opened)
+      (void)door->open();
+    else
+      (void)door->close();
+  }
+  for (const auto &cell : clip.cells)
+    restore_object(at(cell.offset), cell.state);
+
+  end_batch();
+  return true;
+}
+
+// transforms the area between `min` and `max` (both inclusive) in
+// place, keeping its top left corner.
+std::optional<Position<>> Level::transform_region(
+  const Position<> &min, const Position<> &max, Transform transform
+) {
+  Clip clip = copy_region(min, max);
+  if (clip.empty())
+    return std::nullopt;
+  clip.apply(transform);
+
+  // the links to tiles outside the area are undone by clearing it,
+  // so pasting makes them again.
+  begin_batch();
+  (void)clear_region(min, max);
+  (void)paste(clip, min);
+  end_batch();
+  return Position<> {
+    min.x + clip.width - 1, min.y + clip.height - 1
+  };
+}
+
+// puts a tile of a type on every cell, keeping the objects on them
+// if the new tile can hold one.
+usize Level::fill_cells(
+  const std::vector<Position<>> &cells, TileType type
+) {
+  begin_batch();
+  tile_positions.reserve(tile_positions.size() + cells.size());
+  usize changed = 0;
+  for (const auto &pos : cells) {
+    const Tile *tile = get_tile_at(pos);
+    if (tile && tile->get_type() == type)
+      continue;
+    // lifts the object off the old tile, to put it back on the new
+    // one.
+    const CellState before = cell_state(pos);
+    if (const Object *object = get_object_at(pos))
+      (void)remove_object(object->get_id());
+    (void)remove_tile_at(pos);
+    (void)create_tile(type, pos);
+    restore_object(pos, before);
+    ++changed;
+  }
+  end_batch();
+  return changed;
+}
+
+// removes the object, then the tile, on every cell.
+usize Level::clear_cells(const std::vector<Position<>> &cells) {
+  begin_batch();
+  usize removed = 0;
+  for (const auto &pos : cells)
+    if (const Object *object = get_object_at(pos))
+      removed += remove_object(object->get_id());
+  for (const auto &pos : cells)
+    removed += remove_tile_at(pos);
+  end_batch();
+  return removed;
+}
+
+// the cells inside the area between `min` and `max` (both inclusive)
+// reachable from `start` through cells sharing a side and holding the
+// same type of tile (or no tile), `start` included.
+std::vector<Position<>> Level::flood_region(
+  const Position<> &start,
+  const Position<> &min,
+  const Position<> &max
+) const {
+  std::vector<Position<>> cells;
+  const auto              inside = [&](const Position<> &pos) {
+    return pos.x >= min.x && pos.x <= max.x && pos.y >= min.y
+        && pos.y <= max.y;
+  };
+  if (!inside(start))
+    return cells;
+
+  const auto type_at = [&](const Position<> &pos) {
+    const Tile *tile = get_tile_at(pos);
+    return tile ? std::optional {tile->get_type()} : std::nullopt;
+  };
+  const auto type = type_at(start);
+
+  // the cells found so far double as the queue of the search. moving
+  // off the edge of the grid wraps around, and lands outside the
+  // area.
+  std::set<Position<>> seen {start};
+  cells.push_back(start);
+  for (usize i = 0; i < cells.size(); ++i) {
+    for (const auto dir :
+         {Direction::Up,
+          Direction::Down,
+          Direction::Left,
+          Direction::Right}) {
+      const Position<> next = cells[i].move(dir);
+      if (inside(next) && type_at(next) == type
+          && seen.insert(next).second)
+        cells.push_back(next);
+    }
+  }
+  return cells;
+}
+
+// ===== batches =====
+
+// starts a batch, deferring door state updates until the outermost
+// batch ends.
+void Level::begin_batch() {
+  ++batch_depth;
+}
+
+// ends a batch, updating the state of the doors touched during it.
+void Level::end_batch() {
+  if (--batch_depth > 0)
+    return;
+  const auto doors = std::move(batched_doors);
+  batched_doors.clear();
+  for (u32 id : doors)
+    update_door_state(id);
+}
+
+// adds the object of a cell state onto an existing tile, with its
+// direction.
+void Level::restore_object(
+  const Position<> &pos, const CellState &state
+) {
+  if (!state.object)
+    return;
+  Object *object = get_object(add_object(*state.object, pos));
+  if (OneDirBox *box = object_cast<OneDirBox>(object))
+    box->set_dir(state.object_dir);
+  else if (Player *player = object_cast<Player>(object))
+    player->set_dir(state.object_dir);
+}
+
 // ===== portal pairs =====
 
 // links two portals together.
@@ -589,8 +992,8 @@ bool Level::link_portals(u32 id1, u32 id2) {
   if (id1 == id2)
     return false;
   // checks if the portals exist.
-  Portal *portal1 = dynamic_cast<Portal *>(get_tile(id1));
-  Portal *portal2 = dynamic_cast<Portal *>(get_tile(id2));
+  Portal *portal1 = tile_cast<Portal>(get_tile(id1));
+  Portal *portal2 = tile_cast<Portal>(get_tile(id2));
   if (!portal1 || !portal2)
     return false;
   // both portals must be unlinked in order to link.
@@ -602,6 +1005,7 @@ bool Level::link_portals(u32 id1, u32 id2) {
   // adds the pair in both directions into linked_portals.
   linked_portals[id1] = id2;
   linked_portals[id2] = id1;
+  ++revision;
   return true;
 }
 
@@ -617,8 +1021,8 @@ bool Level::unlink_portal(u32 portal_id) {
   // checks if the reverse portal pair exists.
   if (it2 == linked_portals.end())
     return false;
-  Portal *portal1 = dynamic_cast<Portal *>(get_tile(portal_id));
-  Portal *portal2 = dynamic_cast<Portal *>(get_tile(other_id));
+  Portal *portal1 = tile_cast<Portal>(get_tile(portal_id));
+  Portal *portal2 = tile_cast<Portal>(get_tile(other_id));
   if (!portal1 || !portal2)
     return false;
   // unlinks the portals.
@@ -627,6 +1031,7 @@ bool Level::unlink_portal(u32 portal_id) {
   // erases the two pairs in linked_portals.
   linked_portals.erase(portal_id);
   linked_portals.erase(other_id);
+  ++revision;
   return true;
 }
 
@@ -638,8 +1043,8 @@ bool Level::link_door_button(u32 door_id, u32 button_id) {
   if (door_id == button_id)
     return false;
   // check if the door and button exist.
-  Door   *door   = dynamic_cast<Door *>(get_tile(door_id));
-  Button *button = dynamic_cast<Button *>(get_tile(button_id));
+  Door   *door   = tile_cast<Door>(get_tile(door_id));
+  Button *button = tile_cast<Button>(get_tile(button_id));
   if (!door || !button)
     return false;
   // if this button was linked before, unlink from its old
@@ -656,6 +1061,7 @@ bool Level::link_door_button(u32 door_id, u32 button_id) {
   // button_to_door.
   door_to_buttons[door_id].emplace(button_id);
   button_to_door[button_id] = door_id;
+  ++revision;
   // update door state after removing button.
   update_door_state(door_id);
   return true;
@@ -668,12 +1074,12 @@ bool Level::unlink_door(u32 door_id) {
   if (it == door_to_buttons.end())
     return false;
   // erases the button to door pairs.
-  Door *door = dynamic_cast<Door *>(get_tile(door_id));
+  Door *door = tile_cast<Door>(get_tile(door_id));
   if (!door)
     return false;
   for (auto button_id : it->second) {
     button_to_door.erase(button_id);
-    Button *button = dynamic_cast<Button *>(get_tile(button_id));
+    Button *button = tile_cast<Button>(get_tile(button_id));
     if (button)
       button->unlink();
   }
@@ -682,6 +1088,7 @@ bool Level::unlink_door(u32 door_id) {
   // closes the door and unlinks the door.
   door->unlink_all();
   door->close();
+  ++revision;
   return true;
 }
 
@@ -695,8 +1102,8 @@ bool Level::unlink_button(u32 button_id) {
   // the other door's id.
   u32 door_id = it->second;
   // checks if the door and the button exists.
-  Button *button = dynamic_cast<Button *>(get_tile(button_id));
-  Door   *door   = dynamic_cast<Door *>(get_tile(door_id));
+  Button *button = tile_cast<Button>(get_tile(button_id));
+  Door   *door   = tile_cast<Door>(get_tile(door_id));
   if (!button || !door)
     return false;
   // erases the pairs in button_to_door and door_to_buttons.
@@ -704,73 +1111,81 @@ bool Level::unlink_button(u32 button_id) {
   if (door_it == door_to_buttons.end())
     return false;
   door_it->second.erase(button_id);
+  if (door_it->second.empty())
+    door_to_buttons.erase(door_it);
   button_to_door.erase(button_id);
   // unlinks the button and door.
   button->unlink();
   door->unlink(button_id);
+  ++revision;
   // update door state after removing button.
   update_door_state(door_id);
   return true;
 }
 
-// ===== json =====
+// ===== validation =====
+
+// the counts the level rules are checked against.
+Counts Level::counts() const noexcept {
+  // linked portals are stored in both directions, linked buttons
+  // once each and linked doors once each, so the unlinked ones are
+  // whatever is left of their pools.
+  return Counts {
+    .boxes   = objects.boxes.size() + objects.one_dir_boxes.size(),
+    .goals   = tiles.goals.size(),
+    .players = objects.players.size(),
+    .unpaired_portals = tiles.portals.size() - linked_portals.size(),
+    .unlinked_buttons = tiles.buttons.size() - button_to_door.size(),
+    .unlinked_doors   = tiles.doors.size() - door_to_buttons.size(),
+  };
+}
+
+// a description of every rule of the game the level breaks; empty if
+// the level can be played.
+std::vector<std::string> Level::broken_rules() const {
+  std::vector<std::string> out;
+  const Counts             c = counts();
+  if (c.boxes != c.goals)
+    out.push_back(
+      std::format("{} boxes for {} goals", c.boxes, c.goals)
+    );
+  if (c.players != 1)
+    out.push_back(std::format("{} players instead of 1", c.players));
+  if (c.unpaired_portals != 0)
+    out.push_back(
+      std::format("{} unpaired portals", c.unpaired_portals)
+    );
+  if (c.unlinked_buttons != 0)
+    out.push_back(
+      std::format("{} buttons without a door", c.unlinked_buttons)
+    );
+  if (c.unlinked_doors != 0)
+    out.push_back(
+      std::format("{} doors without a button", c.unlinked_doors)
+    );
+  return out;
+}
+
+// the broken rules, and whether the theme failed to load; empty if
+// the level can be exported.
+std::vector<std::string> Level::problems() const {
+  std::vector<std::string> out = broken_rules();
+  if (theme_assets == nullptr || theme_name == NULL_NAME
+      || theme_name != theme_assets->name())
+    out.push_back("theme failed to load");
+  return out;
+}
 
 // checks whether the level is valid enough to be exported.
-bool Level::is_valid() {
+bool Level::is_valid() const {
   // checks if the loaded texture is valid & matches the theme name.
   if (theme_assets == nullptr || theme_name == NULL_NAME
       || theme_name != theme_assets->name())
     return false;
-  // checks if there is only one player.
-  u32  player = 0;
-  auto it     = objects.map.begin();
-  while (it != objects.map.end()) {
-    if (it->second->get_type() == ObjectType::Player)
-      player++;
-    it++;
-  }
-  if (player != 1)
-    return false;
-  // checks if all the doors, buttons, and portals are linked.
-  // count the number of goals.
-  u32  goals = 0;
-  auto it2   = tiles.map.begin();
-  while (it2 != tiles.map.end()) {
-    switch (it2->second->get_type()) {
-    case TileType::Door: {
-      Door *door = dynamic_cast<Door *>(it2->second.get());
-      if (!door || !door->is_linked())
-        return false;
-      break;
-    }
-    case TileType::Button: {
-      Button *button = dynamic_cast<Button *>(it2->second.get());
-      if (!button || !button->is_linked())
-        return false;
-      break;
-    }
-    case TileType::Portal: {
-      Portal *portal = dynamic_cast<Portal *>(it2->second.get());
-      if (!portal || !portal->is_linked())
-        return false;
-      break;
-    }
-    case TileType::Goal: {
-      Goal *goal = dynamic_cast<Goal *>(it2->second.get());
-      if (!goal)
-        return false;
-      goals++;
-      break;
-    }
-    default:
-      break;
-    }
-  }
-  // checks if the no. boxes (unidirectional included) = no. of goals.
-  u32 boxes = objects.map.size() - player;
-  if (boxes != goals)
-    return false;
-  return true;
+  const Counts c = counts();
+  return c.players == 1 && c.boxes == c.goals
+         && c.unpaired_portals == 0 && c.unlinked_buttons == 0
+         && c.unlinked_doors == 0;
 }
 
 } // namespace sbokena::editor::level
@@ -0,0 +1,238 @@
+#include "from_to_json.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "editor_level.hh"
+#include "level.hh"
+#include "object.hh"
+#include "tile.hh"
+#include "utils.hh"
+
+using namespace sbokena::editor::tile;
+using namespace sbokena::editor::object;
+using sbokena::utils::overload;
+
+namespace raw = sbokena::level;
+
+namespace sbokena::editor::from_to_json {
+
+namespace {
+// converts between the editor's and the level file's difficulty.
+raw::Difficulty to_raw(Editor::level::Difficulty diff) {
+  switch (diff) {
+  case Editor::level::Difficulty::Easy:
+    return raw::Difficulty::Easy;
+  case Editor::level::Difficulty::Medium:
+    return raw::Difficulty::Medium;
+  case Editor::level::Difficulty::Hard:
+    return raw::Difficulty::Hard;
+  default:
+    return raw::Difficulty::Unknown;
+  }
+}
+
+Editor::level::Difficulty from_raw(raw::Difficulty diff) {
+  switch (diff) {
+  case raw::Difficulty::Easy:
+    return Editor::level::Difficulty::Easy;
+  case raw::Difficulty::Medium:
+    return Editor::level::Difficulty::Medium;
+  case raw::Difficulty::Hard:
+    return Editor::level::Difficulty::Hard;
+  default:
+    return Editor::level::Difficulty::Unknown;
+  }
+}
+} // namespace
+
+// ===== level =====
+
+// converts an editor level into a raw level.
+RawLevel to_raw(const Editor::level::Level &level) {
+  RawLevel out;
+  out.name  = std::string {level.get_name()};
+  out.theme = level.get_theme_name();
+  out.diff  = to_raw(level.get_condition().difficulty);
+
+  // file ids of portal pairs and door-button groups, numbered as
+  // they are found. a pair is keyed by the smaller id of its two
+  // portals, a group by the id of its door; unlinked tiles get an
+  // id of their own.
+  std::unordered_map<u32, u32> portal_ids;
+  std::unordered_map<u32, u32> door_ids;
+  const auto number = [](std::unordered_map<u32, u32> &ids, u32 key) {
+    return ids.try_emplace(key, static_cast<u32>(ids.size() + 1))
+      .first->second;
+  };
+
+  level.for_each_tile([&](const Position<> &pos, u32 id) {
+    const Tile *tile = level.get_tile(id);
+    switch (tile->get_type()) {
+    case TileType::Floor:
+      out.tiles.insert({pos, raw::Floor {}});
+      break;
+    case TileType::OneDir: {
+      const OneDir *one_dir = tile_cast<OneDir>(tile);
+      out.tiles.insert({pos, raw::DirFloor {one_dir->get_dir_in()}});
+      break;
+    }
+    case TileType::Goal:
+      out.tiles.insert({pos, raw::Goal {}});
+      break;
+    case TileType::Portal: {
+      const Portal *portal = tile_cast<Portal>(tile);
+      const u32     key =
+        portal->is_linked() ? std::min(id, portal->get_linked()) : id;
+      out.tiles.insert(
+        {pos,
+         raw::Portal {
+           .portal_id = number(portal_ids, key),
+           .in_dir    = portal->get_dir_in(),
+         }}
+      );
+      break;
+    }
+    case TileType::Door:
+      out.tiles.insert({pos, raw::Door {number(door_ids, id)}});
+      break;
+    case TileType::Button: {
+      const Button *button = tile_cast<Button>(tile);
+      const u32     key =
+        button->is_linked() ? button->get_linked() : id;
+      out.tiles.insert({pos, raw::Button {number(door_ids, key)}});
+      break;
+    }
+    case TileType::Roof:
+      // roofs are walls, which level files don't store.
+      break;
+    }
+  });
+
+  level.for_each_object([&](const Position<> &pos, u32 id) {
+    const Object *object = level.get_object(id);
+    switch (object->get_type()) {
+    case ObjectType::Player:
+      out.objects.insert({pos, raw::Player {}});
+      break;
+    case ObjectType::Box:
+      out.objects.insert({pos, raw::Box {}});
+      break;
+    case ObjectType::OneDirBox: {
+      const OneDirBox *box = object_cast<OneDirBox>(object);
+      out.objects.insert({pos, raw::DirBox {box->get_dir()}});
+      break;
+    }
+    }
+  });
+
+  return out;
+}
+
+// replaces the contents of an editor level with a raw level.
+void from_raw(const RawLevel &raw, Editor::level::Level &level) {
+  level.reset();
+  level.change_name(raw.name);
+  if (raw.theme != level.get_theme_name()) {
+    std::string theme = raw.theme;
+    level.change_theme(theme);
+  }
+  level.get_condition().set_difficulty(from_raw(raw.diff));
+
+  // editor ids of the tiles sharing a file id. the first portal of a
+  // pair waits for the second one; buttons are linked to their doors
+  // once all tiles exist.
+  std::unordered_map<u32, u32>              portals;
+  std::unordered_map<u32, std::vector<u32>> doors;
+  std::unordered_map<u32, std::vector<u32>> buttons;
+
+  for (const auto &[pos, tile] : raw.tiles) {
+    // clang-format off
+    std::visit(overload {
+      [&](const raw::Floor &) {
+        level.create_tile(TileType::Floor, pos);
+      },
+      [&](const raw::Goal &) {
+        level.create_tile(TileType::Goal, pos);
+      },
+      [&](const raw::DirFloor &t) {
+        const u32 id = level.create_tile(TileType::OneDir, pos);
+        tile_cast<OneDir>(level.get_tile(id))->set_dir_in(t.dir);
+      },
+      [&](const raw::Portal &t) {
+        const u32 id = level.create_tile(TileType::Portal, pos);
+        tile_cast<Portal>(level.get_tile(id))->set_dir_in(t.in_dir);
+        const auto [it, first] = portals.try_emplace(t.portal_id, id);
+        if (!first)
+          level.link_portals(it->second, id);
+      },
+      [&](const raw::Door &t) {
+        const u32 id = level.create_tile(TileType::Door, pos);
+        doors[t.door_id].push_back(id);
+      },
+      [&](const raw::Button &t) {
+        const u32 id = level.create_tile(TileType::Button, pos);
+        buttons[t.door_id].push_back(id);
+      },
+    }, tile);
+    // clang-format on
+  }
+
+  // a button links to a single door in the editor, so groups with
+  // several doors keep the last one.
+  for (const auto &[door_id, door_tiles] : doors) {
+    const auto it = buttons.find(door_id);
+    if (it == buttons.end())
+      continue;
+    for (const u32 door : door_tiles)
+      for (const u32 button : it->second)
+        level.link_door_button(door, button);
+  }
+
+  for (const auto &[pos, object] : raw.objects) {
+    // clang-format off
+    std::visit(overload {
+      [&](const raw::Player &) {
+        level.add_object(ObjectType::Player, pos);
+      },
+      [&](const raw::Box &) {
+        level.add_object(ObjectType::Box, pos);
+      },
+      [&](const raw::DirBox &o) {
+        const u32 id = level.add_object(ObjectType::OneDirBox, pos);
+        Object   *box = level.get_object(id);
+        if (box)
+          object_cast<OneDirBox>(box)->set_dir(o.dir);
+      },
+    }, object);
+    // clang-format on
+  }
+}
+
+// ===== files =====
+
+// writes an editor level to a level file.
+void save(const Editor::level::Level &level, const fs::path &path) {
+  std::ofstream file {path};
+  if (!file)
+    throw std::runtime_error("can't open " + path.string());
+  raw::write_json(file, to_raw(level));
+  if (!file.flush())
+    throw std::runtime_error("can't write " + path.string());
+}
+
+// reads a level file into an editor level.
+void load(Editor::level::Level &level, const fs::path &path) {
+  std::ifstream file {path};
+  if (!file)
+    throw std::runtime_error("can't open " + path.string());
+  // reads the whole file first, so a bad file leaves the level as is.
+  from_raw(raw::read_json(file), level);
+}
+
+} // namespace sbokena::editor::from_to_json
@@ -1,5 +1,8 @@
 #include "grid.hh"
 
+#include <algorithm>
+#include <limits>
+
 using namespace sbokena::position;
 
 // checks whether a position is in the the specified area
@@ -23,12 +26,36 @@ raylib::Vector2 refactored_grid_offset(
   return offset_pos + (distance - (distance.Scale(scale)));
 };
 
-// returns the max position in the grid
-raylib::Vector2
-grid_end(raylib::Vector2 offset_pos, float tile_size) {
+// checks whether a position is on the grid, which has no fixed size
+// and extends right and down from its offset
+bool is_on_grid(raylib::Vector2 pos, raylib::Vector2 offset_pos) {
+  return pos.GetX() >= offset_pos.GetX()
+         && pos.GetY() >= offset_pos.GetY();
+}
+
+// returns the indices of the first and last tiles that are visible
+// in the specified area; if none are, the first is past the last
+std::pair<Position<>, Position<>> visible_tiles(
+  raylib::Vector2 offset,
+  float           size,
+  raylib::Vector2 min,
+  raylib::Vector2 max
+) {
+  // the largest index that is still safe to step past in a loop
+  constexpr float last = std::numeric_limits<u32>::max() >> 1;
+  const auto      index = [&](float pos, float origin) {
+    return std::clamp(floorf((pos - origin) / size), -1.0f, last);
+  };
+
+  const float x0 = std::max(index(min.GetX(), offset.GetX()), 0.0f);
+  const float y0 = std::max(index(min.GetY(), offset.GetY()), 0.0f);
+  const float x1 = index(max.GetX(), offset.GetX());
+  const float y1 = index(max.GetY(), offset.GetY());
+  if (x1 < 0 || y1 < 0)
+    return {{1, 1}, {0, 0}};
   return {
-    offset_pos.GetX() + 32 * tile_size,
-    offset_pos.GetY() + 32 * tile_size
+    {static_cast<u32>(x0), static_cast<u32>(y0)},
+    {static_cast<u32>(x1), static_cast<u32>(y1)}
   };
 }
 
@@ -0,0 +1,344 @@
+#include "journal.hh"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "editor_level.hh"
+#include "object.hh"
+#include "region.hh"
+#include "tile.hh"
+
+using namespace sbokena::editor::tile;
+using namespace sbokena::editor::object;
+
+namespace sbokena::editor::journal {
+
+// ===== recorded edits =====
+
+// records the state of the cells before calling `edit`, and adds
+// the entry if it succeeded (returned a non-zero value).
+template <typename F>
+auto Journal::record(
+  const std::vector<Position<>> &cells, F &&edit
+) -> decltype(edit()) {
+  // cells already part of the open stroke keep their first state.
+  Pending pending;
+  for (const auto &pos : cells)
+    if (!stroke || !stroke->index.contains(pos))
+      touch(pending, pos);
+
+  const auto result = edit();
+  if (!result)
+    return result;
+
+  if (!stroke) {
+    commit(pending);
+    return result;
+  }
+  for (auto &cell : pending.entry.cells) {
+    stroke->index.emplace(cell.pos, stroke->entry.cells.size());
+    stroke->entry.cells.push_back(std::move(cell));
+  }
+  return result;
+}
+
+u32 Journal::create_tile(TileType type, const Position<> &pos) {
+  return record({pos}, [&] { return level.create_tile(type, pos); });
+}
+
+u32 Journal::replace_tile_at(const Position<> &pos, TileType type) {
+  return record({pos}, [&] {
+    return level.replace_tile_at(pos, type);
+  });
+}
+
+bool Journal::remove_tile(u32 id) {
+  const auto pos = level.get_tile_position(id);
+  if (!pos)
+    return false;
+  return record({*pos}, [&] { return level.remove_tile(id); });
+}
+
+bool Journal::remove_tile_at(const Position<> &pos) {
+  return record({pos}, [&] { return level.remove_tile_at(pos); });
+}
+
+bool Journal::rotate_tile_at(const Position<> &pos) {
+  return record({pos}, [&] { return level.rotate_tile_at(pos); });
+}
+
+u32 Journal::add_object(ObjectType type, const Position<> &pos) {
+  return record({pos}, [&] { return level.add_object(type, pos); });
+}
+
+u32 Journal::replace_object_at(
+  const Position<> &pos, ObjectType type
+) {
+  return record({pos}, [&] {
+    return level.replace_object_at(pos, type);
+  });
+}
+
+bool Journal::remove_object(u32 id) {
+  const auto pos = level.get_object_position(id);
+  if (!pos)
+    return false;
+  return record({*pos}, [&] { return level.remove_object(id); });
+}
+
+bool Journal::move_object(u32 id, const Position<> &new_pos) {
+  const auto pos = level.get_object_position(id);
+  if (!pos)
+    return false;
+  return record({*pos, new_pos}, [&] {
+    return level.move_object(id, new_pos);
+  });
+}
+
+bool Journal::rotate_object_at(const Position<> &pos) {
+  return record({pos}, [&] { return level.rotate_object_at(pos); });
+}
+
+bool Journal::link_portals(u32 id1, u32 id2) {
+  const auto pos1 = level.get_tile_position(id1);
+  const auto pos2 = level.get_tile_position(id2);
+  if (!pos1 || !pos2)
+    return false;
+  return record({*pos1, *pos2}, [&] {
+    return level.link_portals(id1, id2);
+  });
+}
+
+bool Journal::link_door_button(u32 door_id, u32 button_id) {
+  const auto door_pos   = level.get_tile_position(door_id);
+  const auto button_pos = level.get_tile_position(button_id);
+  if (!door_pos || !button_pos)
+    return false;
+  // the old door of the button gets its link back through the
+  // button's own state, so it doesn't need to be recorded.
+  return record({*door_pos, *button_pos}, [&] {
+    return level.link_door_button(door_id, button_id);
+  });
+}
+
+// ===== region edits =====
+
+namespace {
+// the positions of the tiles inside an area, the only cells of it an
+// edit can change when it only removes or moves what is there.
+std::vector<Position<>> tiles_in(
+  const Level &level, const Position<> &min, const Position<> &max
+) {
+  std::vector<Position<>> cells;
+  level.for_each_tile_in(min, max, [&](const Position<> &pos, u32) {
+    cells.push_back(pos);
+  });
+  return cells;
+}
+} // namespace
+
+usize Journal::clear_region(
+  const Position<> &min, const Position<> &max
+) {
+  return record(tiles_in(level, min, max), [&] {
+    return level.clear_region(min, max);
+  });
+}
+
+bool Journal::paste(const Clip &clip, const Position<> &origin) {
+  std::vector<Position<>> cells;
+  cells.reserve(clip.cells.size());
+  for (const auto &cell : clip.cells)
+    cells.push_back(
+      {origin.x + cell.offset.x, origin.y + cell.offset.y}
+    );
+  return record(cells, [&] { return level.paste(clip, origin); });
+}
+
+std::optional<Position<>> Journal::transform_region(
+  const Position<> &min, const Position<> &max, Transform transform
+) {
+  // the cells emptied, followed by the cells the transformed area
+  // will cover.
+  std::vector<Position<>> cells = tiles_in(level, min, max);
+  Clip                    clip  = level.copy_region(min, max);
+  clip.apply(transform);
+  for (const auto &cell : clip.cells)
+    cells.push_back({min.x + cell.offset.x, min.y + cell.offset.y});
+  return record(cells, [&] {
+    return level.transform_region(min, max, transform);
+  });
+}
+
+usize Journal::fill_cells(
+  const std::vector<Position<>> &cells, TileType type
+) {
+  return record(cells, [&] { return level.fill_cells(cells, type); });
+}
+
+usize Journal::clear_cells(const std::vector<Position<>> &cells) {
+  return record(cells, [&] { return level.clear_cells(cells); });
+}
+
+// ===== strokes =====
+
+// starts merging the following edits into a single entry.
+void Journal::begin_stroke() {
+  end_stroke();
+  stroke.emplace();
+}
+
+// stops merging edits, and records the merged entry if any edit was
+// made.
+void Journal::end_stroke() {
+  if (!stroke)
+    return;
+  commit(*stroke);
+  stroke.reset();
+}
+
+// ===== history =====
+
+// undoes the last edit; returns false if there is none.
+bool Journal::undo() {
+  end_stroke();
+  if (done.empty())
+    return false;
+  undone.push_back(std::move(done.back()));
+  done.pop_back();
+  apply(undone.back(), false);
+  return true;
+}
+
+// redoes the last undone edit; returns false if there is none.
+bool Journal::redo() {
+  end_stroke();
+  if (undone.empty())
+    return false;
+  done.push_back(std::move(undone.back()));
+  undone.pop_back();
+  apply(done.back(), true);
+  return true;
+}
+
+// forgets every edit.
+void Journal::clear() {
+  done.clear();
+  undone.clear();
+  stroke.reset();
+}
+
+// ===== internals =====
+
+// adds the state of a cell to a pending entry, unless it is already
+// part of it.
+void Journal::touch(Pending &pending, const Position<> &pos) const {
+  if (pending.index.contains(pos))
+    return;
+  pending.index.emplace(pos, pending.entry.cells.size());
+  pending.entry.cells.push_back({pos, capture(pos), {}});
+}
+
+// fills in the after states of a pending entry and adds it to the
+// history.
+void Journal::commit(Pending &pending) {
+  if (pending.entry.cells.empty())
+    return;
+  for (auto &cell : pending.entry.cells)
+    cell.after = capture(cell.pos);
+  done.push_back(std::move(pending.entry));
+  undone.clear();
+}
+
+// the current state of a cell.
+CellState Journal::capture(const Position<> &pos) const {
+  return level.cell_state(pos);
+}
+
+// rebuilds the cells of an entry in either their before or after
+// state.
+void Journal::apply(const Entry &entry, bool after) {
+  const auto state = [&](const Cell &cell) -> const CellState & {
+    return after ? cell.after : cell.before;
+  };
+
+  // clears the cells; objects go first, as tiles with an object on
+  // them can't be removed.
+  for (const auto &cell : entry.cells)
+    if (const Object *object = level.get_object_at(cell.pos))
+      (void)level.remove_object(object->get_id());
+  for (const auto &cell : entry.cells)
+    (void)level.remove_tile_at(cell.pos);
+
+  // rebuilds the tiles.
+  for (const auto &cell : entry.cells) {
+    const CellState &s = state(cell);
+    if (!s.tile)
+      continue;
+    (void)level.create_tile(*s.tile, cell.pos);
+    Tile *tile = level.get_tile_at(cell.pos);
+    if (OneDir *one_dir = tile_cast<OneDir>(tile))
+      one_dir->set_dir_in(s.tile_dir);
+    else if (Portal *portal = tile_cast<Portal>(tile))
+      portal->set_dir_in(s.tile_dir);
+  }
+
+  // relinks the tiles; a link already restored from its other side
+  // is harmlessly restored again or refused.
+  for (const auto &cell : entry.cells) {
+    const CellState &s = state(cell);
+    if (!s.tile)
+      continue;
+    const u32 id = level.get_tile_at(cell.pos)->get_id();
+    for (const auto &linked_pos : s.links) {
+      const Tile *linked = level.get_tile_at(linked_pos);
+      if (!linked)
+        continue;
+      switch (*s.tile) {
+      case TileType::Portal:
+        (void)level.link_portals(id, linked->get_id());
+        break;
+      case TileType::Door:
+        (void)level.link_door_button(id, linked->get_id());
+        break;
+      case TileType::Button:
+        (void)level.link_door_button(linked->get_id(), id);
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  // restores the objects and door states. a door keeps its state
+  // while an object is on it, so objects on doors go last.
+  const auto restore_object = [&](const Cell &cell) {
+    const CellState &s = state(cell);
+    if (!s.object)
+      return;
+    const u32 id     = level.add_object(*s.object, cell.pos);
+    Object   *object = level.get_object(id);
+    if (OneDirBox *box = object_cast<OneDirBox>(object))
+      box->set_dir(s.object_dir);
+    else if (Player *player = object_cast<Player>(object))
+      player->set_dir(s.object_dir);
+  };
+  for (const auto &cell : entry.cells)
+    if (state(cell).tile != TileType::Door)
+      restore_object(cell);
+  for (const auto &cell : entry.cells) {
+    Door *door = tile_cast<Door>(level.get_tile_at(cell.pos));
+    if (!door)
+      continue;
+    if (state(cell).opened)
+      (void)door->open();
+    else
+      (void)door->close();
+  }
+  for (const auto &cell : entry.cells)
+    if (state(cell).tile == TileType::Door)
+      restore_object(cell);
+}
+
+} // namespace sbokena::editor::journal
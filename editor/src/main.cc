@@ -2,17 +2,45 @@
 #define RAYGUI_IMPLEMENTATION
 #endif
 
+#include <algorithm>
+#include <exception>
+#include <format>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <Color.hpp>
 #include <Window.hpp>
+#include <nfd.hpp>
 #include <raygui.h>
 #include <raylib.h>
 
 #include "editor_level.hh"
+#include "from_to_json.hh"
 #include "grid.hh"
+#include "journal.hh"
+#include "playtest.hh"
+#include "region.hh"
+#include "solve_check.hh"
+#include "utils.hh"
 
 using namespace sbokena::types;
 using namespace sbokena::editor::level;
 using namespace sbokena::editor::tile;
+using sbokena::editor::journal::Journal;
+using sbokena::editor::playtest::Playtest;
+using sbokena::editor::playtest::Sprite;
+using sbokena::editor::region::cells_in;
+using sbokena::editor::region::Clip;
+using sbokena::editor::region::Transform;
+using sbokena::editor::solve_check::Checker;
+using sbokena::editor::solve_check::Report;
+using sbokena::editor::solve_check::Verdict;
+using sbokena::utils::open_file_dialog;
+using sbokena::utils::save_file_dialog;
+
+namespace FromToJson = sbokena::editor::from_to_json;
 
 // for testing purposes
 #include <iostream>
@@ -28,6 +56,9 @@ constexpr u32 view_control_button_width    = 60;
 constexpr u32 view_control_button_height   = 50;
 constexpr u32 dropdown_width               = 100;
 constexpr u32 grid_view_min_height         = 45;
+constexpr u32 problem_font_size            = 20;
+constexpr u32 problem_line_spacing         = 4;
+constexpr u32 problem_margin               = 10;
 constexpr u32 view_control_padding         = tile_picker_padding + 5;
 // also the minimum width of the grid-view
 constexpr u32 tile_picker_width = 250;
@@ -63,6 +94,19 @@ float     thickness = 0;
 Rectangle link_selection;
 bool      window_exit = false;
 
+// whether the left mouse button is held down while placing, and the
+// last tile placed while it is
+bool       is_painting  = false;
+Position<> last_painted = {0, 0};
+
+// the region selected by shift-dragging, as its first and last
+// cells, and whether it is being dragged
+std::optional<Position<>> region_anchor;
+Position<>                region_corner = {0, 0};
+bool                      is_selecting_region = false;
+// the last region copied or cut
+Clip clipboard;
+
 bool select_same = false;
 enum class Selecting { None, Tile, Object };
 Selecting layer = Selecting::None;
@@ -106,18 +150,18 @@ enum class Edit_Mode { Place, Select, Link };
 Edit_Mode mode = Edit_Mode::Select;
 
 // switches between directional and normal objects (Boxes)
-void switch_object(Level &lvl, Position<> pos) {
+void switch_object(Level &lvl, Journal &journal, Position<> pos) {
   Object *obj = lvl.get_object_at(pos);
   if (obj) {
     ObjectType type = obj->get_type();
 
     switch (type) {
     case ObjectType::Box: {
-      lvl.replace_object_at(pos, ObjectType::OneDirBox);
+      journal.replace_object_at(pos, ObjectType::OneDirBox);
       break;
     }
     case ObjectType::OneDirBox: {
-      lvl.replace_object_at(pos, ObjectType::Box);
+      journal.replace_object_at(pos, ObjectType::Box);
       break;
     }
     default:
@@ -127,18 +171,18 @@ void switch_object(Level &lvl, Position<> pos) {
 }
 
 // switches between directional and normal tiles (Floors)
-void switch_tile(Level &lvl, Position<> pos) {
+void switch_tile(Level &lvl, Journal &journal, Position<> pos) {
   Tile *tile = lvl.get_tile_at(pos);
   if (tile) {
     TileType type = tile->get_type();
 
     switch (type) {
     case TileType::Floor: {
-      lvl.replace_tile_at(pos, TileType::OneDir);
+      journal.replace_tile_at(pos, TileType::OneDir);
       break;
     }
     case TileType::OneDir: {
-      lvl.replace_tile_at(pos, TileType::Floor);
+      journal.replace_tile_at(pos, TileType::Floor);
       break;
     }
     default:
@@ -147,6 +191,32 @@ void switch_tile(Level &lvl, Position<> pos) {
   }
 }
 
+// places the currently selected tile or object at a position; a
+// tile or object of the same type is left as is
+void place(Level &lvl, Journal &journal, Position<> pos) {
+  if (is_placing_tiles) {
+    Tile *tile = lvl.get_tile_at(pos);
+    if (tile) {
+      if (currently_selected_tile_type == TileType::Roof)
+        journal.remove_tile_at(pos);
+      else if (tile->get_type() != currently_selected_tile_type)
+        journal.replace_tile_at(pos, currently_selected_tile_type);
+    } else if (currently_selected_tile_type != TileType::Roof) {
+      journal.create_tile(currently_selected_tile_type, pos);
+    }
+  } else {
+    Object *obj = lvl.get_object_at(pos);
+    if (obj) {
+      if (obj->get_type() != currently_selected_object_type)
+        journal.replace_object_at(
+          pos, currently_selected_object_type
+        );
+    } else {
+      journal.add_object(currently_selected_object_type, pos);
+    }
+  }
+}
+
 void switch_selection(Rectangle rec, bool is_tile) {
   currently_selected_outline_rec = {
     rec.x - 5,
@@ -159,6 +229,50 @@ void switch_selection(Rectangle rec, bool is_tile) {
   layer            = Selecting::None;
 }
 
+// the top left and bottom right cells of the selected region.
+std::pair<Position<>, Position<>> region_bounds() {
+  return {
+    {std::min(region_anchor->x, region_corner.x),
+     std::min(region_anchor->y, region_corner.y)},
+    {std::max(region_anchor->x, region_corner.x),
+     std::max(region_anchor->y, region_corner.y)}
+  };
+}
+
+// a line of text describing the result of a solvability check.
+std::string describe(const Report &report) {
+  std::string text;
+  switch (report.verdict) {
+  case Verdict::None:
+    text = "not checked";
+    break;
+  case Verdict::Invalid:
+    text = "not playable";
+    break;
+  case Verdict::Solvable:
+    text = std::format("solvable in {} moves", report.moves);
+    break;
+  case Verdict::Unsolvable:
+    text = "unsolvable";
+    break;
+  case Verdict::Unknown:
+    text = std::format("unknown after {} states", report.nodes);
+    break;
+  }
+  if (report.checking)
+    text += " (checking...)";
+  return text;
+}
+
+// a line of text describing the progress of a playtest.
+std::string describe(const Playtest &playtest) {
+  if (playtest.completed())
+    return std::format(
+      "completed in {} moves (r to restart)", playtest.moves()
+    );
+  return std::format("playing: {} moves", playtest.moves());
+}
+
 int main() {
   raylib::Color color_;
 
@@ -171,16 +285,42 @@ int main() {
 
   SetWindowMinSize(min_width, min_height);
 
+  NFD::Guard nfd_guard;
+
   Level level_       = Level("default");
   int   theme_result = level_.load_theme_assets();
 
   if (theme_result < 0)
     std::cerr << "Failed to load theme assets\n";
 
+  Journal journal_ = Journal(level_);
+
+  // checks the level for solvability in the background, whenever
+  // its revision differs from the last one submitted and no stroke
+  // is open.
+  Checker checker_;
+  u64     checked_revision = level_.get_revision() - 1;
+
+  // the game in progress while playtesting; editing is disabled
+  // while there is one.
+  std::optional<Playtest> playtest_;
+  // why the last playtest couldn't start, shown in the status line
+  // until the level changes.
+  std::string playtest_error;
+  u64         playtest_error_revision = 0;
+
   while (!window.ShouldClose() && !window_exit) {
     window.BeginDrawing();
     mouse_position = GetMousePosition();
 
+    // a playtest ends as soon as the level is changed under it (by
+    // resetting or importing, for example).
+    if (playtest_ && playtest_->revision() != level_.get_revision())
+      playtest_.reset();
+    if (!playtest_error.empty()
+        && playtest_error_revision != level_.get_revision())
+      playtest_error.clear();
+
     if (IsMouseButtonPressed(MOUSE_MIDDLE_BUTTON))
       mouse_start_position = GetMousePosition();
     if (IsMouseButtonDown(MOUSE_MIDDLE_BUTTON)) {
@@ -204,8 +344,34 @@ int main() {
     if (current_window_height < min_height)
       current_window_height = min_height;
 
+    const bool shift_down =
+      IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+    // region selection (shift and drag)
+    if (!playtest_ && shift_down && mode != Edit_Mode::Link
+        && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)
+        && is_inside(
+          mouse_position,
+          {tile_picker_width, grid_view_min_height},
+          {current_window_width, current_window_height}
+        )
+        && is_on_grid(mouse_position, grid_offset)) {
+      region_anchor =
+        tile_index(mouse_position, grid_offset, current_tile_size);
+      region_corner       = *region_anchor;
+      is_selecting_region = true;
+    }
+    if (is_selecting_region) {
+      if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+        is_selecting_region = false;
+      else if (is_on_grid(mouse_position, grid_offset))
+        region_corner =
+          tile_index(mouse_position, grid_offset, current_tile_size);
+    }
+
     // tile selection
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+    if (!playtest_ && !is_selecting_region
+        && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
       // checks whether:
       // 1) the mouse is inside the window's grid part
       // 2) the mouse is inside the actual grid
@@ -214,11 +380,7 @@ int main() {
             {tile_picker_width, grid_view_min_height},
             {current_window_width, current_window_height}
           )
-          && is_inside(
-            mouse_position,
-            grid_offset,
-            grid_end(grid_offset, current_tile_size)
-          )) {
+          && is_on_grid(mouse_position, grid_offset)) {
         Position<> next_selected_grid_tile_index =
           tile_index(mouse_position, grid_offset, current_tile_size);
         select_same =
@@ -226,40 +388,12 @@ int main() {
         selected_grid_tile_index = next_selected_grid_tile_index;
         switch (mode) {
         case (Edit_Mode::Place): {
-          if (is_placing_tiles) {
-            Tile *tile =
-              level_.get_tile_at(next_selected_grid_tile_index);
-            if (tile) {
-              if (currently_selected_tile_type == TileType::Roof) {
-                level_.remove_tile_at(next_selected_grid_tile_index);
-              } else {
-                level_.replace_tile_at(
-                  selected_grid_tile_index,
-                  currently_selected_tile_type
-                );
-              }
-            } else if (currently_selected_tile_type
-                       != TileType::Roof) {
-              level_.create_tile(
-                currently_selected_tile_type, selected_grid_tile_index
-              );
-            }
-
-          } else {
-            Object *obj =
-              level_.get_object_at(next_selected_grid_tile_index);
-            if (obj) {
-              level_.replace_object_at(
-                selected_grid_tile_index,
-                currently_selected_object_type
-              );
-            } else {
-              level_.add_object(
-                currently_selected_object_type,
-                selected_grid_tile_index
-              );
-            }
-          }
+          // a stroke merges everything placed until the button is
+          // released into a single undo step
+          journal_.begin_stroke();
+          place(level_, journal_, selected_grid_tile_index);
+          is_painting  = true;
+          last_painted = selected_grid_tile_index;
           break;
         }
         case (Edit_Mode::Select): {
@@ -282,29 +416,29 @@ int main() {
             level_.get_tile_at(selected_grid_tile_index);
           if (first_tile && second_tile) {
             // linking 2 portals together
-            if (Portal *first = dynamic_cast<Portal *>(first_tile)) {
+            if (Portal *first = tile_cast<Portal>(first_tile)) {
               if (Portal *second =
-                    dynamic_cast<Portal *>(second_tile)) {
-                level_.link_portals(
+                    tile_cast<Portal>(second_tile)) {
+                journal_.link_portals(
                   first->get_id(), second->get_id()
                 );
               }
             }
 
             // linking a button to a door
-            if (Button *first = dynamic_cast<Button *>(first_tile)) {
-              if (Door *second = dynamic_cast<Door *>(second_tile)) {
-                level_.link_door_button(
+            if (Button *first = tile_cast<Button>(first_tile)) {
+              if (Door *second = tile_cast<Door>(second_tile)) {
+                journal_.link_door_button(
                   second->get_id(), first->get_id()
                 );
               }
             }
 
             // linking a door to a button
-            if (Door *first = dynamic_cast<Door *>(first_tile)) {
+            if (Door *first = tile_cast<Door>(first_tile)) {
               if (Button *second =
-                    dynamic_cast<Button *>(second_tile)) {
-                level_.link_door_button(
+                    tile_cast<Button>(second_tile)) {
+                journal_.link_door_button(
                   first->get_id(), second->get_id()
                 );
               }
@@ -317,19 +451,157 @@ int main() {
       }
     }
 
+    // drag-painting
+    if (is_painting) {
+      if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON)
+          || mode != Edit_Mode::Place) {
+        journal_.end_stroke();
+        is_painting = false;
+      } else if (is_inside(
+                   mouse_position,
+                   {tile_picker_width, grid_view_min_height},
+                   {current_window_width, current_window_height}
+                 )
+                 && is_on_grid(mouse_position, grid_offset)) {
+        Position<> index =
+          tile_index(mouse_position, grid_offset, current_tile_size);
+        if (index != last_painted) {
+          place(level_, journal_, index);
+          last_painted = index;
+        }
+      }
+    }
+
+    const bool ctrl_down =
+      IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+
+    // undo (ctrl+z) and redo (ctrl+y or ctrl+shift+z)
+    if (!playtest_ && !edit_mode_theme && ctrl_down) {
+      if (IsKeyPressed(KEY_Z)) {
+        is_painting = false;
+        if (shift_down)
+          journal_.redo();
+        else
+          journal_.undo();
+      } else if (IsKeyPressed(KEY_Y)) {
+        is_painting = false;
+        journal_.redo();
+      }
+    }
+
+    // region edits: copy (ctrl+c), cut (ctrl+x), paste at the
+    // selected tile (ctrl+v), delete (delete), fill with the picked
+    // tile (f), flood fill from the selected tile (g), rotate
+    // clockwise (ctrl+r) and mirror (ctrl+m, ctrl+shift+m for up and
+    // down)
+    if (!playtest_ && !edit_mode_theme && !is_painting) {
+      // the area a flood fill may spread over: the region, or else
+      // the visible part of the grid
+      auto flood_area = visible_tiles(
+        grid_offset,
+        current_tile_size,
+        {tile_picker_width, grid_view_min_height},
+        {current_window_width, current_window_height}
+      );
+      if (region_anchor)
+        flood_area = region_bounds();
+      // roofs are what placing erases with, so they fill by erasing
+      const auto fill = [&](const std::vector<Position<>> &cells) {
+        if (currently_selected_tile_type == TileType::Roof)
+          journal_.clear_cells(cells);
+        else
+          journal_.fill_cells(cells, currently_selected_tile_type);
+      };
+
+      if (ctrl_down && IsKeyPressed(KEY_V)) {
+        journal_.paste(clipboard, selected_grid_tile_index);
+      } else if (IsKeyPressed(KEY_G) && is_placing_tiles) {
+        const auto [min, max] = flood_area;
+        fill(level_.flood_region(selected_grid_tile_index, min, max));
+      } else if (region_anchor) {
+        const auto [min, max] = region_bounds();
+        if (ctrl_down && IsKeyPressed(KEY_C)) {
+          clipboard = level_.copy_region(min, max);
+        } else if (ctrl_down && IsKeyPressed(KEY_X)) {
+          clipboard = level_.copy_region(min, max);
+          journal_.clear_region(min, max);
+        } else if (IsKeyPressed(KEY_DELETE)) {
+          journal_.clear_region(min, max);
+        } else if (IsKeyPressed(KEY_F) && is_placing_tiles) {
+          fill(cells_in(min, max));
+        } else if (ctrl_down
+                   && (IsKeyPressed(KEY_R) || IsKeyPressed(KEY_M))) {
+          const Transform transform =
+            IsKeyPressed(KEY_R) ? Transform::Rotate
+            : shift_down        ? Transform::MirrorVertical
+                                : Transform::MirrorHorizontal;
+          // the region follows the area, which a rotation reshapes
+          if (const auto corner =
+                journal_.transform_region(min, max, transform)) {
+            region_anchor = min;
+            region_corner = *corner;
+          }
+        }
+      }
+    }
+
+    // playtest moves (arrow keys or wasd) and restart (r)
+    if (playtest_ && !edit_mode_theme) {
+      if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W))
+        playtest_->step(Direction::Up);
+      else if (IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_S))
+        playtest_->step(Direction::Down);
+      else if (IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_A))
+        playtest_->step(Direction::Left);
+      else if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_D))
+        playtest_->step(Direction::Right);
+      else if (IsKeyPressed(KEY_R))
+        playtest_->restart();
+    }
+
+    // only the tiles inside the grid view are drawn
+    const auto [view_min, view_max] = visible_tiles(
+      grid_offset,
+      current_tile_size,
+      {tile_picker_width, grid_view_min_height},
+      {current_window_width, current_window_height}
+    );
+    const auto tile_screen_position = [&](Position<> pos) {
+      return raylib::Vector2 {
+        grid_offset.GetX() + current_tile_size * pos.x,
+        grid_offset.GetY() + current_tile_size * pos.y
+      };
+    };
+
     // GRID of Tiles
-    for (u32 y = 0; y < 31; y++) {
-      for (u32 x = 0; x < 31; x++) {
+    // empty cells are drawn as roofs
+    const Theme<Texture> &theme = level_.get_loaded_theme();
+    const Texture         roof  = *theme.sprites()[theme.ROOF];
+    for (u32 y = view_min.y; y <= view_max.y; y++)
+      for (u32 x = view_min.x; x <= view_max.x; x++)
         DrawTextureEx(
-          level_.tile_sprite_at({x, y}),
-          {grid_offset.GetX() + current_tile_size * x,
-           grid_offset.GetY() + current_tile_size * y},
+          roof,
+          tile_screen_position({x, y}),
+          0,
+          current_tile_size / 32,
+          raylib::Color::White()
+        );
+    level_.for_each_tile_in(
+      view_min, view_max, [&](Position<> pos, u32) {
+        // doors open and close while playtesting.
+        std::optional<Sprite> sprite;
+        if (playtest_)
+          sprite = playtest_->tile_sprite_at(pos);
+        DrawTextureEx(
+          sprite ? *theme.sprites()[*sprite]
+                 : level_.tile_sprite_at(pos),
+          tile_screen_position(pos),
           0,
           current_tile_size / 32,
           raylib::Color::White()
         );
       }
-    }
+    );
 
     // selection
     const Rectangle grid_selection = {
@@ -346,21 +618,34 @@ int main() {
     }
 
     // GRID of Objects
-    for (u32 y = 0; y < 31; y++) {
-      for (u32 x = 0; x < 31; x++) {
-        auto object = level_.object_sprite_at({x, y});
-        if (object.has_value()) {
+    // while playtesting, the objects are the game's.
+    if (playtest_)
+      playtest_->for_each_object_in(
+        view_min, view_max, [&](Position<> pos, Sprite sprite) {
           DrawTextureEx(
-            object.value(),
-            {grid_offset.GetX() + current_tile_size * x,
-             grid_offset.GetY() + current_tile_size * y},
+            *theme.sprites()[sprite],
+            tile_screen_position(pos),
             0,
             current_tile_size / 32,
             raylib::Color::White()
           );
         }
-      }
-    }
+      );
+    else
+      level_.for_each_object_in(
+        view_min, view_max, [&](Position<> pos, u32) {
+          auto object = level_.object_sprite_at(pos);
+          if (object.has_value()) {
+            DrawTextureEx(
+              object.value(),
+              tile_screen_position(pos),
+              0,
+              current_tile_size / 32,
+              raylib::Color::White()
+            );
+          }
+        }
+      );
 
     // Selecting::Object
     if (layer == Selecting::Object) {
@@ -369,9 +654,27 @@ int main() {
       );
     }
 
-    // deselecting the tile
-    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+    // deselecting the tile and the region
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
       layer = Selecting::None;
+      region_anchor.reset();
+    }
+
+    // showing the selected region
+    if (region_anchor && !playtest_) {
+      const auto [min, max]   = region_bounds();
+      const Rectangle outline = {
+        grid_offset.GetX() + current_tile_size * min.x,
+        grid_offset.GetY() + current_tile_size * min.y,
+        current_tile_size * (max.x - min.x + 1),
+        current_tile_size * (max.y - min.y + 1)
+      };
+      DrawRectangleLinesEx(
+        outline,
+        current_tile_size / thickness_coef,
+        raylib::Color::SkyBlue()
+      );
+    }
 
     // showing the link selection
     if (mode == Edit_Mode::Link) {
@@ -380,6 +683,58 @@ int main() {
       );
     }
 
+    // live list of the rules the level breaks, at the bottom right
+    // of the grid view.
+    const auto problems  = level_.problems();
+    f32        problem_y = current_window_height;
+    for (auto it = problems.rbegin(); it != problems.rend(); ++it) {
+      problem_y -= problem_font_size + problem_line_spacing;
+      const f32 width = MeasureText(it->c_str(), problem_font_size);
+      const f32 x     = current_window_width - width - problem_margin;
+      const Rectangle backdrop = {
+        x - problem_line_spacing,
+        problem_y - problem_line_spacing / 2.0f,
+        width + 2 * problem_line_spacing,
+        problem_font_size + problem_line_spacing
+      };
+      DrawRectangleRec(backdrop, Fade(raylib::Color::Black(), 0.6));
+      DrawText(
+        it->c_str(),
+        x,
+        problem_y,
+        problem_font_size,
+        raylib::Color::Orange()
+      );
+    }
+
+    // result of the last solvability check, the progress of the
+    // playtest, or why it couldn't start, at the top left of the
+    // grid view.
+    const bool        failed = !playtest_ && !playtest_error.empty();
+    const std::string status =
+      playtest_ ? describe(*playtest_)
+      : failed  ? playtest_error
+                : describe(checker_.report());
+    const f32 status_x = tile_picker_width + problem_margin;
+    const f32 status_y = grid_view_min_height + problem_margin;
+    const Rectangle status_backdrop = {
+      status_x - problem_line_spacing,
+      status_y - problem_line_spacing / 2.0f,
+      MeasureText(status.c_str(), problem_font_size)
+        + 2.0f * problem_line_spacing,
+      problem_font_size + problem_line_spacing
+    };
+    DrawRectangleRec(
+      status_backdrop, Fade(raylib::Color::Black(), 0.6)
+    );
+    DrawText(
+      status.c_str(),
+      status_x,
+      status_y,
+      problem_font_size,
+      failed ? raylib::Color::Orange() : raylib::Color::RayWhite()
+    );
+
     // DECORATIVE ELEMENTS
     // tile_picker
     const Rectangle tile_picker = {
@@ -448,7 +803,15 @@ int main() {
       taskbar_button_size
     };
     if (GuiButton(download_button, "Download")) {
-      // TODO
+      if (!level_.is_valid())
+        std::cerr << "Warning: saving an incomplete level\n";
+      if (const auto path = save_file_dialog()) {
+        try {
+          FromToJson::save(level_, *path);
+        } catch (const std::exception &ex) {
+          std::cerr << "Failed to save level: " << ex.what() << "\n";
+        }
+      }
     }
 
     // Import button
@@ -459,7 +822,39 @@ int main() {
       taskbar_button_size
     };
     if (GuiButton(import_button, "Import")) {
-      // TODO
+      if (const auto path = open_file_dialog()) {
+        try {
+          FromToJson::load(level_, *path);
+          journal_.clear();
+        } catch (const std::exception &ex) {
+          std::cerr << "Failed to load level: " << ex.what() << "\n";
+        }
+      }
+    }
+
+    // Play button, which switches between editing and playtesting
+    const Rectangle play_button = {
+      current_window_width - (5 * taskbar_button_size),
+      0,
+      taskbar_button_size,
+      taskbar_button_size
+    };
+    if (GuiButton(play_button, playtest_ ? "Edit" : "Play")) {
+      if (playtest_) {
+        playtest_.reset();
+      } else {
+        try {
+          if (journal_.in_stroke())
+            journal_.end_stroke();
+          is_painting = false;
+          playtest_.emplace(level_);
+          playtest_error.clear();
+        } catch (const std::exception &ex) {
+          playtest_error =
+            std::format("can't playtest: {}", ex.what());
+          playtest_error_revision = level_.get_revision();
+        }
+      }
     }
 
     // Reset button
@@ -471,6 +866,7 @@ int main() {
     };
     if (GuiButton(reset_button, "Reset")) {
       level_.reset();
+      journal_.clear();
       theme_result = level_.load_theme_assets();
     }
 
@@ -524,23 +920,11 @@ int main() {
       if (mode == Edit_Mode::Select) {
         switch (layer) {
         case Selecting::Tile: {
-          Tile *tile_ = level_.get_tile_at(selected_grid_tile_index);
-          if (tile_) {
-            if (OneDir *one_dir_ = dynamic_cast<OneDir *>(tile_))
-              one_dir_->rotate();
-            else if (Portal *portal_ = dynamic_cast<Portal *>(tile_))
-              portal_->rotate();
-          }
+          journal_.rotate_tile_at(selected_grid_tile_index);
           break;
         }
         case Selecting::Object: {
-          Object *object_ =
-            level_.get_object_at(selected_grid_tile_index);
-          if (object_) {
-            if (OneDirBox *one_dir_box_ =
-                  dynamic_cast<OneDirBox *>(object_))
-              one_dir_box_->rotate();
-          }
+          journal_.rotate_object_at(selected_grid_tile_index);
           break;
         }
         default:
@@ -614,11 +998,11 @@ int main() {
       mode = Edit_Mode::Select;
       switch (layer) {
       case Selecting::Tile: {
-        switch_tile(level_, selected_grid_tile_index);
+        switch_tile(level_, journal_, selected_grid_tile_index);
         break;
       }
       case Selecting::Object: {
-        switch_object(level_, selected_grid_tile_index);
+        switch_object(level_, journal_, selected_grid_tile_index);
         break;
       }
       default:
@@ -738,6 +1122,15 @@ int main() {
     }
     // DrawRectangleRec(box_tile, raylib::Color::Red());
 
+    // hands every new revision of the level to the solvability check
+    // once any open stroke ends: converting the level is linear in
+    // its size, too much to repeat for every cell a drag paints.
+    if (level_.get_revision() != checked_revision
+        && !journal_.in_stroke()) {
+      checked_revision = level_.get_revision();
+      checker_.submit(FromToJson::to_raw(level_));
+    }
+
     window.EndDrawing();
   }
 
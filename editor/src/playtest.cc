@@ -0,0 +1,273 @@
+#include "playtest.hh"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <raylib.h>
+
+#include "editor_level.hh"
+#include "level.hh"
+#include "loader.hh"
+#include "object.hh"
+#include "position.hh"
+#include "state.hh"
+#include "tile.hh"
+#include "utils.hh"
+
+namespace raw = sbokena::level;
+
+using sbokena::game::state::Doors;
+using sbokena::game::state::Goals;
+using sbokena::game::state::Objects;
+using sbokena::game::state::Portals;
+using sbokena::game::state::RawState;
+using sbokena::game::state::StepResult;
+using sbokena::game::state::Tiles;
+using sbokena::loader::InvalidLevelException;
+using sbokena::loader::Theme;
+using sbokena::position::Cell;
+using sbokena::position::CELL_LIMIT;
+using sbokena::position::POS_MAX;
+using sbokena::utils::assert_throw;
+using sbokena::utils::overload;
+
+namespace sbokena::editor::playtest {
+
+namespace {
+// the game's cell at an editor position.
+//
+// throws `InvalidLevelException`, as `LevelData` does, if the
+// position is past `CELL_LIMIT`, where it would collapse onto other
+// cells.
+Cell to_cell(const Position<> &pos) {
+  assert_throw(
+    pos.x < CELL_LIMIT && pos.y < CELL_LIMIT, InvalidLevelException {}
+  );
+  return pos;
+}
+
+// builds the game's state straight from an editor level.
+std::unique_ptr<RawState> build(const Level &level) {
+  // the editor already tracks the rules the game checks on load.
+  const auto problems = level.broken_rules();
+  if (!problems.empty())
+    throw std::runtime_error(problems.front());
+
+  // the tiles and goals are frozen, so they are gathered first and
+  // sorted once, instead of shifting on every insert.
+  std::vector<Tiles::value_type> tile_list;
+  std::vector<Cell>              goal_list;
+  Objects                        objects;
+  Doors                          doors;
+  Portals                        portals;
+
+  // editor ids are unique, so they serve as door and portal ids: a
+  // door group is keyed by the id of its door, and a portal pair by
+  // the smaller id of its two portals.
+  level.for_each_tile([&](const Position<> &pos, u32 id) {
+    const tile::Tile *t    = level.get_tile(id);
+    const Cell        cell = to_cell(pos);
+    switch (t->get_type()) {
+    case TileType::Floor:
+      tile_list.emplace_back(cell, raw::Floor {});
+      break;
+    case TileType::OneDir: {
+      const auto *one_dir = tile_cast<tile::OneDir>(t);
+      tile_list.emplace_back(
+        cell, raw::DirFloor {one_dir->get_dir_in()}
+      );
+      break;
+    }
+    case TileType::Goal:
+      tile_list.emplace_back(cell, raw::Goal {});
+      goal_list.push_back(cell);
+      break;
+    case TileType::Portal: {
+      const auto *portal = tile_cast<tile::Portal>(t);
+      const u32   key    = std::min(id, portal->get_linked());
+      tile_list.emplace_back(
+        cell,
+        raw::Portal {
+          .portal_id = key,
+          .in_dir    = portal->get_dir_in(),
+        }
+      );
+      const auto [it, first] =
+        portals.try_emplace(key, pos, POS_MAX<>);
+      if (!first)
+        it->second.second = pos;
+      break;
+    }
+    case TileType::Door:
+      tile_list.emplace_back(cell, raw::Door {id});
+      doors[id].first = pos;
+      break;
+    case TileType::Button: {
+      const u32 door = tile_cast<tile::Button>(t)->get_linked();
+      tile_list.emplace_back(cell, raw::Button {door});
+      doors[door].second.insert(cell);
+      break;
+    }
+    case TileType::Roof:
+      // roofs are walls, which the game doesn't store.
+      break;
+    }
+  });
+
+  level.for_each_object([&](const Position<> &pos, u32 id) {
+    const object::Object *o    = level.get_object(id);
+    const Cell            cell = to_cell(pos);
+    if (tile_cast<tile::Portal>(level.get_tile_at(pos)))
+      throw std::runtime_error("an object starts on a portal");
+    switch (o->get_type()) {
+    case ObjectType::Player:
+      objects.emplace(cell, raw::Player {});
+      break;
+    case ObjectType::Box:
+      objects.emplace(cell, raw::Box {});
+      break;
+    case ObjectType::OneDirBox: {
+      const auto *box = object_cast<object::OneDirBox>(o);
+      objects.emplace(cell, raw::DirBox {box->get_dir()});
+      break;
+    }
+    }
+  });
+
+  // resolving the portal exits throws on portal cycles.
+  return std::make_unique<RawState>(RawState {
+    .goals   = Goals(goal_list.begin(), goal_list.end()),
+    .tiles   = Tiles(tile_list.begin(), tile_list.end()),
+    .objects = std::move(objects),
+    .doors   = std::move(doors),
+    .portals = std::move(portals),
+  });
+}
+
+// the direction the player faces at the start.
+Direction player_dir_of(const Level &level) {
+  Direction dir = Direction::Down;
+  level.for_each_object([&](const Position<> &, u32 id) {
+    const object::Object *o = level.get_object(id);
+    if (const auto *player = object_cast<object::Player>(o))
+      dir = player->get_dir();
+  });
+  return dir;
+}
+
+// picks one of four values by direction.
+template <typename T>
+T select_dir(Direction dir, T up, T down, T left, T right) {
+  switch (dir) {
+  case Direction::Up:
+    return up;
+  case Direction::Down:
+    return down;
+  case Direction::Left:
+    return left;
+  case Direction::Right:
+    break;
+  }
+  return right;
+}
+} // namespace
+
+// starts playing a level from its current state.
+Playtest::Playtest(const Level &level)
+  : start(build(level)),
+    state(std::make_unique<RawState>(*start)),
+    start_revision(level.get_revision()),
+    start_dir(player_dir_of(level)),
+    player_dir(start_dir) {}
+
+Playtest::~Playtest() = default;
+
+// moves the player one step, as in the game.
+Outcome Playtest::step(Direction dir) {
+  // the game stops taking moves once the level is complete.
+  if (complete)
+    return Outcome::Blocked;
+  player_dir = dir;
+  switch (state->step(dir)) {
+  case StepResult::Ok:
+    ++move_count;
+    return Outcome::Moved;
+  case StepResult::LevelComplete:
+    ++move_count;
+    complete = true;
+    return Outcome::Completed;
+  default:
+    return Outcome::Blocked;
+  }
+}
+
+// puts every object back where it started.
+void Playtest::restart() {
+  state->objects = start->objects;
+  player_dir     = start_dir;
+  move_count     = 0;
+  complete       = false;
+}
+
+// the sprite of the tile at a position, if it looks different while
+// playing.
+std::optional<Sprite> Playtest::tile_sprite_at(Position<> pos) const {
+  const auto it = state->tiles.find(pos);
+  if (it == state->tiles.end())
+    return std::nullopt;
+  const auto *door = std::get_if<raw::Door>(&it->second);
+  if (!door)
+    return std::nullopt;
+  if (state->is_door_open(door->door_id))
+    return Theme<Texture>::DOOR_OPEN;
+  return Theme<Texture>::DOOR_CLOSED;
+}
+
+// calls `fn(pos, sprite)` for every object inside the area between
+// `min` and `max` (both inclusive).
+void Playtest::for_each_object_in(
+  const Position<>                              &min,
+  const Position<>                              &max,
+  const std::function<void(Position<>, Sprite)> &fn
+) const {
+  using Theme = sbokena::loader::Theme<Texture>;
+  for (const auto &[pos, obj] : state->objects) {
+    if (pos.x < min.x || pos.x > max.x || pos.y < min.y
+        || pos.y > max.y)
+      continue;
+    // clang-format off
+    const Sprite sprite = std::visit(overload {
+      [&](const raw::Player &) {
+        return select_dir(
+          player_dir,
+          Theme::PLAYER_N,
+          Theme::PLAYER_S,
+          Theme::PLAYER_W,
+          Theme::PLAYER_E
+        );
+      },
+      [&](const raw::Box &) {
+        return Theme::BOX;
+      },
+      [&](const raw::DirBox &box) {
+        return select_dir(
+          box.dir,
+          Theme::DIRBOX_N,
+          Theme::DIRBOX_S,
+          Theme::DIRBOX_W,
+          Theme::DIRBOX_E
+        );
+      },
+    }, obj);
+    // clang-format on
+    fn(pos, sprite);
+  }
+}
+
+} // namespace sbokena::editor::playtest
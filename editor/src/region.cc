@@ -0,0 +1,84 @@
+#include "region.hh"
+
+#include <utility>
+#include <vector>
+
+namespace sbokena::editor::region {
+
+// transforms the clip: moves its cells and links, and turns the
+// directions of its floors, portals, boxes and player to match.
+void Clip::apply(Transform transform) {
+  const u32  old_width  = width;
+  const u32  old_height = height;
+  const auto move       = [&](Position<> &offset) {
+    switch (transform) {
+    case Transform::Rotate:
+      // +y points down, so a clockwise turn sends (x, y) to (-y, x),
+      // shifted back into the region.
+      offset = {old_height - 1 - offset.y, offset.x};
+      break;
+    case Transform::MirrorHorizontal:
+      offset.x = old_width - 1 - offset.x;
+      break;
+    case Transform::MirrorVertical:
+      offset.y = old_height - 1 - offset.y;
+      break;
+    }
+  };
+
+  for (auto &cell : cells) {
+    move(cell.offset);
+    for (auto &link : cell.state.links)
+      move(link);
+    CellState &s = cell.state;
+    s.tile_dir   = transformed(s.tile_dir, transform);
+    s.object_dir = transformed(s.object_dir, transform);
+  }
+  if (transform == Transform::Rotate)
+    std::swap(width, height);
+}
+
+// a direction after a transform.
+Direction transformed(Direction dir, Transform transform) {
+  switch (transform) {
+  case Transform::Rotate:
+    switch (dir) {
+    case Direction::Up:
+      return Direction::Right;
+    case Direction::Right:
+      return Direction::Down;
+    case Direction::Down:
+      return Direction::Left;
+    case Direction::Left:
+      return Direction::Up;
+    }
+    break;
+  case Transform::MirrorHorizontal:
+    if (dir == Direction::Left || dir == Direction::Right)
+      return -dir;
+    break;
+  case Transform::MirrorVertical:
+    if (dir == Direction::Up || dir == Direction::Down)
+      return -dir;
+    break;
+  }
+  return dir;
+}
+
+// every cell of the area between `min` and `max` (both inclusive),
+// row by row.
+std::vector<Position<>>
+cells_in(const Position<> &min, const Position<> &max) {
+  std::vector<Position<>> cells;
+  if (min.x > max.x || min.y > max.y)
+    return cells;
+  cells.reserve(
+    static_cast<usize>(max.x - min.x + 1) * (max.y - min.y + 1)
+  );
+  for (u32 y = min.y; y <= max.y; ++y)
+    for (u32 x = min.x; x <= max.x; ++x)
+      cells.push_back({x, y});
+  return cells;
+}
+
+} // namespace sbokena::editor::region
@@ -0,0 +1,102 @@
+#include "solve_check.hh"
+
+#include <exception>
+#include <mutex>
+#include <stop_token>
+#include <utility>
+
+#include "loader.hh"
+#include "solver.hh"
+#include "state.hh"
+
+namespace solver = sbokena::game::solver;
+
+using sbokena::game::state::State;
+using sbokena::loader::LevelData;
+
+namespace sbokena::editor::solve_check {
+
+namespace {
+// validates a snapshot and runs the solver on it.
+Report check(const RawLevel &raw, std::stop_token stop) {
+  std::optional<State> state;
+  try {
+    state.emplace(LevelData {raw});
+  } catch (const std::exception &) {
+    return {.verdict = Verdict::Invalid};
+  }
+
+  const auto res =
+    solver::solve(state->inner(), solver::NODE_BUDGET, stop);
+  Report out {.moves = res.moves, .nodes = res.nodes};
+  switch (res.verdict) {
+  case solver::Verdict::Solvable:
+    out.verdict = Verdict::Solvable;
+    break;
+  case solver::Verdict::Unsolvable:
+    out.verdict = Verdict::Unsolvable;
+    break;
+  case solver::Verdict::Unknown:
+    out.verdict = Verdict::Unknown;
+    break;
+  }
+  return out;
+}
+} // namespace
+
+// starts the worker thread, which waits for a first snapshot.
+Checker::Checker()
+  : worker([this](std::stop_token stop) { run(stop); }) {}
+
+// cancels the check in progress and joins the worker thread.
+Checker::~Checker() {
+  worker.request_stop();
+  std::scoped_lock lock {mutex};
+  cancel.request_stop();
+  // the worker is joined as it is destroyed.
+}
+
+// hands a snapshot of the level to the worker, cancelling the check
+// in progress, if any.
+void Checker::submit(RawLevel level) {
+  {
+    std::scoped_lock lock {mutex};
+    pending = std::move(level);
+    cancel.request_stop();
+    last.checking = true;
+  }
+  wake.notify_one();
+}
+
+// the result of the last finished check.
+Report Checker::report() const {
+  std::scoped_lock lock {mutex};
+  return last;
+}
+
+// the worker thread's loop.
+void Checker::run(std::stop_token stop) {
+  std::unique_lock lock {mutex};
+  while (true) {
+    wake.wait(lock, stop, [&] { return pending.has_value(); });
+    if (stop.stop_requested())
+      return;
+    const RawLevel level = std::move(*pending);
+    pending.reset();
+    cancel = {};
+    const std::stop_token token = cancel.get_token();
+
+    lock.unlock();
+    const Report report = check(level, token);
+    lock.lock();
+
+    // a cancelled check didn't finish, so its result says nothing
+    // about either snapshot.
+    if (token.stop_requested())
+      continue;
+    last          = report;
+    last.checking = pending.has_value();
+  }
+}
+
+} // namespace sbokena::editor::solve_check
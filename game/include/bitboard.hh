@@ -0,0 +1,230 @@
+// bitboard encoding of the game state, for search & analysis.
+//
+// a `Layout` holds the immutable layers of a level (walls, floor,
+// goals, ...), and a `Board` holds the mutable ones (player and
+// boxes). a `Board` is a handful of flat words, so it's cheap to
+// copy, compare and hash.
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <span>
+#include <vector>
+
+#include "direction.hh"
+#include "position.hh"
+#include "state.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::game::state::RawState;
+using sbokena::position::Position;
+
+namespace sbokena::game::bitboard {
+
+// all directions, in the order of `dir_index`.
+constexpr std::array<Direction, 4> DIRECTIONS = {
+  Direction::Up,
+  Direction::Down,
+  Direction::Left,
+  Direction::Right,
+};
+
+// index of a direction into per-direction arrays.
+constexpr usize dir_index(Direction dir) noexcept {
+  return std::countr_zero(static_cast<u8>(dir));
+}
+
+// a set of bits with a size chosen at runtime.
+//
+// all operations work on whole words at a time. binary operations
+// require both operands to have the same size.
+class Bits {
+public:
+  using Word = u64;
+
+  static constexpr usize WORD_BITS = 64;
+
+  // create an empty set of 0 bits.
+  Bits() = default;
+
+  // create a set of `size` bits, all unset.
+  explicit Bits(usize size);
+
+  // number of bits in the set.
+  usize size() const noexcept {
+    return size_;
+  }
+
+  // the backing words. bits past `size()` are always unset.
+  std::span<const Word> words() const noexcept {
+    return words_;
+  }
+
+  // check a bit.
+  bool test(usize i) const noexcept {
+    return (words_[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+  }
+
+  // set a bit.
+  void set(usize i) noexcept {
+    words_[i / WORD_BITS] |= Word {1} << (i % WORD_BITS);
+  }
+
+  // unset a bit.
+  void reset(usize i) noexcept {
+    words_[i / WORD_BITS] &= ~(Word {1} << (i % WORD_BITS));
+  }
+
+  // number of set bits.
+  usize count() const noexcept;
+
+  // whether any bit is set.
+  bool any() const noexcept;
+
+  // index of the lowest set bit, or `size()` if none are set.
+  usize first() const noexcept;
+
+  // the set shifted by `n` bits towards higher indices, or towards
+  // lower indices if `n` is negative. bits shifted past either end
+  // are dropped.
+  [[nodiscard("shifted does not modify `this`")]]
+  Bits shifted(isize n) const;
+
+  // this set, without the bits set in `rhs`.
+  [[nodiscard("without does not modify `this`")]]
+  Bits without(const Bits &rhs) const;
+
+  Bits &operator&=(const Bits &rhs) noexcept;
+  Bits &operator|=(const Bits &rhs) noexcept;
+
+  // call `fn(i)` for every set bit `i`, in ascending order.
+  template <typename F>
+  void for_each(F &&fn) const {
+    for (usize w = 0; w < words_.size(); ++w)
+      for (Word word = words_[w]; word; word &= word - 1)
+        fn(w * WORD_BITS + std::countr_zero(word));
+  }
+
+  bool operator==(const Bits &) const = default;
+
+private:
+  usize             size_ = 0;
+  std::vector<Word> words_;
+};
+
+Bits operator&(Bits lhs, const Bits &rhs) noexcept;
+Bits operator|(Bits lhs, const Bits &rhs) noexcept;
+
+// the immutable layers of a level.
+//
+// cells are stored row-major, with a 1-cell `Wall` border around
+// the level's bounding box, so that shifting a layer by one cell in
+// any direction never wraps a bit onto another playable cell.
+class Layout {
+public:
+  // encode the tiles of a `RawState`.
+  explicit Layout(const RawState &);
+
+  // number of cells, including the border.
+  usize size() const noexcept {
+    return stride_ * rows_;
+  }
+
+  // number of cells in a row, including the border.
+  usize stride() const noexcept {
+    return stride_;
+  }
+
+  // whether a position lies inside the encoded area.
+  bool contains(Position<> pos) const noexcept;
+
+  // the cell index of a position. `pos` must be contained.
+  usize index(Position<> pos) const noexcept {
+    return (pos.y - origin_.y) * stride_ + (pos.x - origin_.x);
+  }
+
+  // the position of a cell index.
+  Position<> position(usize i) const noexcept {
+    return {
+      .x = static_cast<u32>(origin_.x + i % stride_),
+      .y = static_cast<u32>(origin_.y + i / stride_),
+    };
+  }
+
+  // index offset to the neighbouring cell in a direction.
+  isize offset(Direction dir) const noexcept;
+
+  // cells with any tile on them.
+  Bits floor;
+  // cells without a tile on them.
+  Bits walls;
+  // `Goal` tiles.
+  Bits goals;
+  // `Button` tiles.
+  Bits buttons;
+  // `Door` tiles.
+  Bits doors;
+  // `Portal` tiles.
+  Bits portals;
+  // `DirFloor` tiles, by direction.
+  std::array<Bits, 4> dirfloors;
+
+  // cells which any object may enter and exit in a direction
+  // without any further checks: `Floor`, `Goal`, `Button`, and
+  // `DirFloor` of that direction.
+  std::array<Bits, 4> passable;
+  // cells which an object may exit in a direction.
+  std::array<Bits, 4> exits;
+
+private:
+  // position of cell 0. may underflow for levels touching 0, which
+  // is fine, since positions are only ever added to it.
+  Position<> origin_;
+  usize      stride_;
+  usize      rows_;
+};
+
+// the mutable layers of a level.
+struct Board {
+  // encode the objects of a `RawState`.
+  Board(const Layout &, const RawState &);
+
+  // cell index of the player.
+  usize player;
+  // `Box` objects.
+  Bits boxes;
+  // `DirBox` objects, by direction.
+  std::array<Bits, 4> dirboxes;
+
+  // all `Box` and `DirBox` objects.
+  Bits all_boxes() const;
+
+  // number of goals with a box on them.
+  usize goals_filled(const Layout &) const noexcept;
+
+  // whether the level is completed, i.e. all goals have a box on
+  // them. see `RawState::step`.
+  bool complete(const Layout &) const noexcept;
+
+  // boxes which can be pushed one cell in `dir` by a player
+  // standing on any cell in `reach`.
+  //
+  // pushes involving `Door` or `Portal` targets depend on more than
+  // the box layers, and are never generated here. use `RawState`
+  // for those.
+  Bits pushes(const Layout &, Direction dir, const Bits &reach) const;
+
+  // push the box at cell `box` one cell in `dir`, moving the player
+  // onto `box`. the push must be one generated by `pushes`.
+  void push(const Layout &, usize box, Direction dir) noexcept;
+
+  // a hash of the board, for use in transposition tables.
+  u64 hash() const noexcept;
+
+  bool operator==(const Board &) const = default;
+};
+
+} // namespace sbokena::game::bitboard
@@ -0,0 +1,91 @@
+//! playing through a level pack.
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <optional>
+
+#include <raylib.h>
+
+#include "loader.hh"
+#include "pack.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::loader::Level;
+using sbokena::loader::Theme;
+using sbokena::pack::Pack;
+
+namespace sbokena::game::campaign {
+
+// the levels of a pack, played one after the other.
+//
+// the next level can be loaded on a background thread ahead of time
+// (see `prefetch`): read out of the pack, validated, and its theme
+// decoded, unless it is the theme already in VRAM. moving on to it
+// then only has to commit a new theme to VRAM, which has to happen
+// on the main thread.
+class Campaign {
+public:
+  Campaign()                            = delete;
+  Campaign(const Campaign &)            = delete;
+  Campaign &operator=(const Campaign &) = delete;
+  Campaign(Campaign &&)                 = delete;
+  Campaign &operator=(Campaign &&)      = delete;
+
+  // waits for a prefetch still running.
+  ~Campaign() = default;
+
+  // start a campaign at a level of an open pack.
+  Campaign(std::shared_ptr<Pack> pack, usize index);
+
+  // index of the level being played.
+  usize index() const noexcept {
+    return index_;
+  }
+
+  // whether there is a level after the one being played.
+  bool has_next() const noexcept {
+    return index_ + 1 < pack->entries().size();
+  }
+
+  // load the level being played, on the calling thread.
+  //
+  // throws if the level can't be read, or is invalid.
+  Level<Texture> load();
+
+  // start loading the next level on a background thread, if there is
+  // one and it isn't already loading.
+  void prefetch();
+
+  // move on to the next level, waiting for it if it is still loading.
+  // the level stays the same if this fails.
+  //
+  // throws if there is no next level, or if it can't be read or is
+  // invalid.
+  Level<Texture> advance();
+
+private:
+  // a level loaded on a background thread.
+  struct Fetched {
+    // the level, if its theme is the one already in VRAM.
+    std::unique_ptr<const Level<Texture>> ready;
+    // otherwise, the level with its theme decoded.
+    std::unique_ptr<const Level<Image>> decoded;
+  };
+
+  std::shared_ptr<Pack> pack;
+  usize                 index_;
+
+  // the theme of the last level loaded, kept in VRAM.
+  std::optional<Theme<Texture>> theme;
+
+  // the next level, if it is loading or loaded. declared last, so a
+  // running prefetch is waited for while `theme` is still held, and
+  // its own copy of the theme is never the one freeing the textures
+  // off the main thread.
+  std::future<Fetched> next;
+};
+
+} // namespace sbokena::game::campaign
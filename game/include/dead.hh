@@ -0,0 +1,26 @@
+// dead squares, i.e. the cells from which a box can never be pushed
+// onto a goal, wherever the player and the other boxes are.
+
+#pragma once
+
+#include <vector>
+
+#include "position.hh"
+#include "state.hh"
+
+using sbokena::game::state::RawState;
+using sbokena::position::Position;
+
+namespace sbokena::game::dead {
+
+// the dead squares of a state's level, in ascending order.
+//
+// a box's moves follow the same rules as `RawState::step`, except
+// that other boxes are ignored and every door is taken as open, and
+// the player is assumed to reach any cell behind the box. this only
+// ever adds moves, so a cell reported dead is dead in every state,
+// though a cell not reported may still be dead. `Portal` cells are
+// never reported, as no box rests on them.
+std::vector<Position<>> dead_squares(const RawState &);
+
+} // namespace sbokena::game::dead
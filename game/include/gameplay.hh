@@ -2,15 +2,21 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
 #include <optional>
 
 #include <raylib.h>
 
+#include "campaign.hh"
 #include "loader.hh"
 #include "scene.hh"
-#include "state.hh"
+#include "simulation.hh"
 
-using sbokena::game::state::State;
+using sbokena::game::campaign::Campaign;
+using sbokena::game::simulation::Move;
+using sbokena::game::simulation::Simulation;
+using sbokena::game::simulation::Snapshot;
 using namespace sbokena::loader;
 
 namespace sbokena::game::scene {
@@ -24,37 +30,114 @@ public:
   GameplayScene &operator=(GameplayScene &&)      = delete;
   ~GameplayScene()                                = default;
 
-  // create a `GameplayScene` from a `Level`.
-  GameplayScene(const Level<Texture> &);
+  // create a `GameplayScene` from a `Level`, which may be part of a
+  // `Campaign`.
+  GameplayScene(
+    const Level<Texture>     &,
+    std::shared_ptr<Campaign> campaign = nullptr
+  );
 
   void         draw() const override;
   UpdateResult update(Input) override;
 
+  // only while moves are still playing, or the simulation published
+  // something not yet drawn.
+  bool dirty() const override {
+    return queued > 0 || sim->version() != drawn_version;
+  }
+
 private:
-  State          state;
+  // start loading the next level of the campaign once this many
+  // boxes are left off goals.
+  static constexpr usize PREFETCH_BOXES_LEFT = 1;
+
   Level<Texture> level;
+  // the level's tiles, frozen for drawing.
+  LevelData::FrozenTiles tiles;
+
+  // the campaign the level is part of, if any.
+  std::shared_ptr<Campaign> campaign;
+
+  // the game state, stepped on its own thread. shared with the copy
+  // kept by the pause menu.
+  std::shared_ptr<Simulation> sim;
+  // the version of the last snapshot drawn.
+  mutable u64 drawn_version = 0;
 
   Position<> min;
   Position<> max;
   usize      width;
   usize      height;
 
-  u64       moves      = 0;
-  Direction player_dir = Direction::Down;
+  // ===== animation =====
+  //
+  // moves are applied by the simulation as soon as they are input,
+  // and only their animations wait for the ones before them to play.
+  // these play on a clock of fixed ticks, and frames are drawn
+  // between the last two ticks.
+
+  // how long a move takes to play alone, in seconds.
+  static constexpr f64 MOVE_TIME = 0.12;
+  // the length of a tick of the animation clock, in seconds.
+  static constexpr f64 TICK = 1.0 / 120;
+  // the most time the clock catches up with in one frame, in seconds.
+  static constexpr f64 MAX_LAG = 0.25;
+  // the most moves waiting to play, beyond which the oldest are
+  // skipped.
+  static constexpr usize MAX_QUEUED = 32;
+
+  // the moves waiting to play, as a ring starting at `queue_first`.
+  std::array<Move, MAX_QUEUED> queue;
+  usize                        queue_first = 0;
+  usize                        queued      = 0;
+
+  // how much of the queue has played, in moves, at the last two
+  // ticks.
+  f64 played_before = 0;
+  f64 played        = 0;
+  // time since the last tick, and when the clock last ran, in
+  // seconds.
+  f64 lag   = 0;
+  f64 clock = 0;
+
+  // the number of steps of the simulation queued so far.
+  u64 seen = 0;
+
+  // queue the animations of the steps in a snapshot not queued yet.
+  void animate(const Snapshot &);
+
+  // run the animation clock up to some time, in seconds.
+  void advance(f64 now);
+
+  // where an object at some position in a snapshot is drawn, in cells
+  // from `min`, given how much of the queue has played.
+  Vector2 drawn_at(Position<>, f64 progress, const Snapshot &) const;
+
+  // screen-space placement of the level grid.
+  struct Viewport {
+    Vector2 pos;
+    Vector2 size;
+    Vector2 cell_size;
+  };
+
+  // compute the placement of the level grid on the screen.
+  Viewport viewport() const;
+
+  // get the level position under a screen point, if any.
+  std::optional<Position<>> cell_at(Vector2) const;
 
   // draw the game state.
-  void draw_viewport() const;
+  void draw_viewport(const Snapshot &) const;
 
   // draw the gameplay HUD.
-  void draw_hud() const;
+  void draw_hud(const Snapshot &) const;
 
-  // get the sprite of a tile at some position.
-  // positions not in `tiles` will be shown as a `Wall`.
-  Texture tile_sprite_at(Position<>) const;
+  // get the sprite of a tile, or of a `Wall` if there is none.
+  Texture tile_sprite(const Tile *, const Snapshot &) const;
 
-  // get the sprite of an object at some position.
-  // positions not in `objects` will cause an exception.
-  std::optional<Texture> obj_sprite_at(Position<>) const;
+  // get the sprite of an object, with the player facing some
+  // direction.
+  Texture obj_sprite(const Object &, Direction player_dir) const;
 };
 
 } // namespace sbokena::game::scene
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <memory>
+
+#include "campaign.hh"
 #include "loader.hh"
 #include "scene.hh"
 
+using sbokena::game::campaign::Campaign;
 using sbokena::loader::Level;
 
 namespace sbokena::game::scene {
@@ -16,15 +20,28 @@ public:
   LevelCompleteScene &operator=(LevelCompleteScene &&)      = delete;
   ~LevelCompleteScene()                                     = default;
 
-  // create a `LevelCompleteScene` from `GameplayScene`
-  LevelCompleteScene(const Level<Texture> &, u64 moves);
+  // create a `LevelCompleteScene` from `GameplayScene`, and start
+  // loading the next level of the campaign, if any.
+  LevelCompleteScene(
+    const Level<Texture>     &,
+    u64                       moves,
+    std::shared_ptr<Campaign> campaign = nullptr
+  );
 
   void         draw() const override;
   UpdateResult update(Input) override;
 
+  // the stats don't change once shown.
+  bool dirty() const override {
+    return false;
+  }
+
 private:
   Level<Texture> level;
   u64            moves;
+
+  // the campaign the level is part of, if any.
+  std::shared_ptr<Campaign> campaign;
 };
 
 } // namespace sbokena::game::scene
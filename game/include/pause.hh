@@ -25,6 +25,11 @@ public:
   void         draw() const override;
   UpdateResult update(Input) override;
 
+  // the game is paused, so nothing moves.
+  bool dirty() const override {
+    return false;
+  }
+
 private:
   Level<Texture> level;
   u64            moves;
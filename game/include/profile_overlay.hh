@@ -0,0 +1,12 @@
+//! the profiler overlay, see `profile.hh`.
+
+#pragma once
+
+namespace sbokena::game::overlay {
+
+// draw the recorded frame times and scopes over the top right corner
+// of the screen: a graph of the last frames, their percentiles, and
+// the average time spent in every scope per frame.
+void draw_profile();
+
+} // namespace sbokena::game::overlay
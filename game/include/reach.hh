@@ -0,0 +1,171 @@
+// player reachability, i.e. the set of cells the player can walk to
+// without pushing anything.
+
+#pragma once
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "bitboard.hh"
+#include "direction.hh"
+#include "position.hh"
+#include "state.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::game::bitboard::Bits;
+using sbokena::game::bitboard::Layout;
+using sbokena::game::state::RawState;
+using sbokena::position::Position;
+
+namespace sbokena::game::reach {
+
+// the region reachable by the player in a `RawState`.
+//
+// movement follows the same rules as `RawState::step`: `DirFloor`s
+// may only be traversed in their direction, `Portal`s may only be
+// entered from their entrance side, and closed `Door`s can't be
+// entered. boxes are treated as obstacles.
+//
+// the movement graph is built once, so flooding is a plain
+// breadth-first search over cell indices. after a push, the region
+// is usually extended in place instead of being flooded again.
+class Reachability {
+public:
+  // build the movement graph of a state, and flood it from the
+  // player's position.
+  explicit Reachability(const RawState &);
+
+  // re-read the objects of a state, and flood it from scratch.
+  void flood(const RawState &);
+
+  // update the region after a successful push, in which the player
+  // moved from `player_from` onto `box_from`, and the box moved from
+  // `box_from` to `box_to`.
+  //
+  // this only re-floods the whole level if the player can't step
+  // back, a door changed state, or the box was pushed onto a
+  // reachable cell which a short search can't get around.
+  void update(
+    Position<> player_from, Position<> box_from, Position<> box_to
+  );
+
+  // update the region after a step of `state`, in which the player
+  // moved from `player_from`. does nothing if nothing was pushed.
+  void update(const RawState &state, Position<> player_from);
+
+  // a shortest non-pushing walk from `from` to `to`, or nothing if
+  // there isn't one. `from` must be in the region.
+  //
+  // the search runs backwards from `to`, and its distance field is
+  // kept until the next push or flood. it doesn't depend on where
+  // the player stands, so walking and asking for `to` again only
+  // costs the walk.
+  std::optional<std::vector<Direction>>
+  path(Position<> from, Position<> to);
+
+  // whether the player can walk to a position.
+  bool reachable(Position<> pos) const noexcept;
+
+  // number of reachable cells, including the player's own.
+  usize count() const noexcept {
+    return count_;
+  }
+
+  // number of times the region was flooded from scratch.
+  usize floods() const noexcept {
+    return floods_;
+  }
+
+  // number of times `path` searched the level.
+  usize searches() const noexcept {
+    return searches_;
+  }
+
+  // the top-left-most reachable cell.
+  //
+  // all states which only differ by a non-pushing walk share this
+  // position, so it can stand in for the player when hashing states.
+  Position<> normalized() const noexcept {
+    return layout_.position(min_);
+  }
+
+  // the reachable region, as a bitboard layer of `layout()`.
+  Bits region() const;
+
+  // the cell layout the region is indexed by.
+  const Layout &layout() const noexcept {
+    return layout_;
+  }
+
+private:
+  static constexpr u32 NONE = std::numeric_limits<u32>::max();
+
+  // whether the player may move along an edge of the graph.
+  bool enterable(u32 from, u32 to) const noexcept;
+
+  // forget the region, and flood it again from a cell.
+  void restart(u32 start) noexcept;
+
+  // mark a cell as reachable.
+  void mark(u32 cell) noexcept;
+
+  // breadth-first search from the cells already queued.
+  void search() noexcept;
+
+  // whether every cell the region enters from `cut` can still be
+  // reached from `start` without it, within a few cells.
+  bool bypassed(u32 start, u32 cut) noexcept;
+
+  Layout layout_;
+
+  // destination of a non-pushing move from a cell in a direction,
+  // after portal traversal, indexed by `cell * 4 + dir_index`.
+  // `NONE` if the move always fails.
+  std::vector<u32> next_;
+  // the moves into each cell, as indices into `next_`. those into
+  // cell `i` are `into_[into_start_[i]..into_start_[i + 1])`.
+  std::vector<u32> into_start_;
+  std::vector<u32> into_;
+  // door id slot of each `Door` cell, or `NONE`.
+  std::vector<u32> door_;
+  // door id slot of each `Button` cell, or `NONE`.
+  std::vector<u32> button_;
+  // number of boxes on the buttons of each door id slot.
+  std::vector<u32> pressed_;
+  // whether each cell holds a box.
+  std::vector<u8> blocked_;
+
+  // a cell is reachable iff its mark equals `gen_`.
+  std::vector<u32> mark_;
+  u32              gen_ = 0;
+  // search queue, kept around to avoid reallocating.
+  std::vector<u32> queue_;
+
+  usize count_  = 0;
+  u32   min_    = NONE;
+  usize floods_ = 0;
+
+  // cells seen by `bypassed`, iff their probe equals `probe_gen_`.
+  std::vector<u32> probe_;
+  u32              probe_gen_ = 0;
+
+  // bumped by every push and flood.
+  u32 version_ = 0;
+
+  // distance field towards `target_`, valid while `field_version_`
+  // equals `version_`. a cell can reach the target iff its `seen_`
+  // equals `field_gen_`.
+  u32              target_        = NONE;
+  u32              field_version_ = NONE;
+  u32              field_gen_     = 0;
+  usize            searches_      = 0;
+  std::vector<u32> seen_;
+  // next cell and direction index from each cell towards the target.
+  std::vector<u32> toward_;
+  std::vector<u8>  via_;
+};
+
+} // namespace sbokena::game::reach
@@ -27,6 +27,12 @@ Input from_queues(
   decltype(GetGamepadButtonPressed()) btn
 );
 
+// whether any input arrived since the last frame: a key or button
+// press, a mouse move, click or scroll, or a window resize.
+//
+// unlike `GetKeyPressed`, this doesn't consume any input.
+bool input_arrived();
+
 // the `Scene` updated normally.
 struct UpdateOk;
 
@@ -65,6 +71,17 @@ struct Scene {
   // this method is mostly used to react to player input, and to draw
   // GUI elements.
   virtual UpdateResult update(Input) = 0;
+
+  // whether drawing the scene again would change what is on screen
+  // without any new input, e.g. while an animation runs or until a
+  // message times out.
+  //
+  // this method is called once the last input has been handled and
+  // its result drawn. if it returns false, the game waits for input
+  // instead of drawing the same frame again.
+  virtual bool dirty() const {
+    return true;
+  }
 };
 
 // ===== impls for `UpdateResult` =====
@@ -0,0 +1,182 @@
+//! the game state, stepped on its own thread.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "direction.hh"
+#include "level.hh"
+#include "loader.hh"
+#include "position.hh"
+#include "reach.hh"
+#include "state.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::direction::Direction;
+using sbokena::game::reach::Reachability;
+using sbokena::game::state::Motion;
+using sbokena::game::state::State;
+using sbokena::position::Position;
+
+namespace sbokena::game::simulation {
+
+// an input for the simulation.
+//
+// - `Direction`: step once in that direction.
+// - `Position<>`: walk to that cell along a shortest path, if the
+//   player can reach it without pushing anything.
+using Command = std::variant<Direction, Position<>>;
+
+// a step which moved something.
+struct Move {
+  Direction             dir;
+  std::array<Motion, 2> motions;
+  usize                 count;
+};
+
+// the number of last moves kept in a snapshot.
+constexpr usize MOVE_LOG = 32;
+
+// what is drawn of the game state at some point.
+struct Snapshot {
+  // the number of snapshots published up to this one.
+  u64 version = 0;
+
+  // every object, by position.
+  std::vector<std::pair<Position<>, Object>> objects;
+  // whether each door is open, by id.
+  std::vector<std::pair<u32, bool>> doors;
+
+  // moves counted so far, see `GameplayScene`.
+  u64   moves  = 0;
+  usize points = 0;
+  // the direction of the last step, even one which failed.
+  Direction facing = Direction::Down;
+  // whether the level was completed.
+  bool complete = false;
+
+  // the number of steps which moved something, and the last of them,
+  // with step `i` at `log[i % MOVE_LOG]`.
+  u64                        steps = 0;
+  std::array<Move, MOVE_LOG> log {};
+
+  // whether a door is open. the door must exist.
+  bool is_door_open(u32 id) const;
+};
+
+// steps a level's state on a worker thread, fed by a queue of
+// commands.
+//
+// every batch of commands ends with a snapshot of the state being
+// published. snapshots are double-buffered: the worker fills one
+// while the other is read, and only waits for a reader if it has to
+// fill a snapshot again before the reader let go of it, so a slow
+// step never holds up drawing.
+class Simulation {
+public:
+  Simulation()                              = delete;
+  Simulation(const Simulation &)            = delete;
+  Simulation &operator=(const Simulation &) = delete;
+  Simulation(Simulation &&)                 = delete;
+  Simulation &operator=(Simulation &&)      = delete;
+
+  // publishes the starting state, and starts the worker thread.
+  explicit Simulation(const sbokena::loader::LevelData &);
+
+  // drops the commands not yet applied, and joins the worker thread.
+  ~Simulation();
+
+  // queue a command, applied once the ones before it are.
+  void send(Command);
+
+  // a published snapshot, which stays unchanged while the view is
+  // held. views should be dropped within a frame.
+  class View {
+  public:
+    View()                        = delete;
+    View(const View &)            = delete;
+    View &operator=(const View &) = delete;
+    View(View &&)                 = delete;
+    View &operator=(View &&)      = delete;
+    ~View();
+
+    const Snapshot &operator*() const noexcept {
+      return sim.buffers[index];
+    }
+
+    const Snapshot *operator->() const noexcept {
+      return &sim.buffers[index];
+    }
+
+  private:
+    friend class Simulation;
+
+    View(const Simulation &sim, usize index)
+      : sim {sim},
+        index {index} {}
+
+    const Simulation &sim;
+    usize             index;
+  };
+
+  // the latest snapshot.
+  View latest() const;
+
+  // the version of the latest snapshot, readable without a view.
+  u64 version() const noexcept {
+    return published.load(std::memory_order_acquire);
+  }
+
+private:
+  // the worker thread's loop.
+  void run(std::stop_token stop);
+
+  // apply a command to `state`.
+  void apply(Direction);
+  void apply(Position<>);
+
+  // fill the snapshot not being read, and swap it in.
+  void publish();
+
+  // only used by the worker, or before it starts. the counters are
+  // those of `Snapshot`.
+  State        state;
+  Reachability reach;
+  u64          moves    = 0;
+  Direction    facing   = Direction::Down;
+  bool         complete = false;
+
+  u64                        steps = 0;
+  std::array<Move, MOVE_LOG> log {};
+
+  // door ids, in the order of `Snapshot::doors`.
+  std::vector<u32> door_ids;
+
+  // the queued commands.
+  std::mutex                  input_lock;
+  std::condition_variable_any input_ready;
+  std::vector<Command>        inputs;
+
+  // both snapshots, the one last published, and how many views
+  // of each are held.
+  mutable std::mutex                  snapshot_lock;
+  mutable std::condition_variable_any snapshot_freed;
+  std::array<Snapshot, 2>             buffers;
+  usize                               front = 0;
+  mutable std::array<usize, 2>        readers {};
+  std::atomic<u64>                    published {0};
+
+  // declared last, so it is joined before the rest is destroyed.
+  std::jthread worker;
+};
+
+} // namespace sbokena::game::simulation
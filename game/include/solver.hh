@@ -0,0 +1,55 @@
+// a breadth-first solver, for checking whether a level can be
+// completed and in how few moves.
+
+#pragma once
+
+#include <stop_token>
+
+#include "state.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+using sbokena::game::state::RawState;
+
+namespace sbokena::game::solver {
+
+// the outcome of a search.
+enum struct Verdict {
+  // the level can be completed.
+  Solvable,
+  // every reachable state was searched, and none completes the
+  // level.
+  Unsolvable,
+  // the search ran out of nodes or was stopped first.
+  Unknown,
+};
+
+// the result of calling `solve`.
+struct Result {
+  Verdict verdict;
+  // the least number of moves completing the level, if `Solvable`.
+  usize moves;
+  // number of distinct states visited.
+  usize nodes;
+};
+
+// the default number of states `solve` visits before giving up,
+// about a second of searching on a desktop machine.
+inline constexpr usize NODE_BUDGET = 200'000;
+
+// search every state reachable from `start`, one move at a time,
+// until one completes the level.
+//
+// moves follow `RawState::step`, so the move count found is optimal.
+// states are deduplicated by their objects, and only looked up by
+// `RawState::hash`, so a hash collision never prunes a state which
+// wasn't searched. the search gives up after visiting `budget`
+// states, and checks `stop` between states, so it can be cancelled
+// from another thread.
+Result solve(
+  const RawState &start,
+  usize           budget = NODE_BUDGET,
+  std::stop_token stop   = {}
+);
+
+} // namespace sbokena::game::solver
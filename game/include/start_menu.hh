@@ -2,8 +2,10 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 
+#include "pack.hh"
 #include "scene.hh"
 #include "types.hh"
 
@@ -23,8 +25,19 @@ public:
   void         draw() const override;
   UpdateResult update(Input) override;
 
+  // only while a message is shown.
+  bool dirty() const override;
+
 private:
   std::optional<f64> show_failed_load = std::nullopt;
+
+  // the open level pack, listed in place of the menu.
+  std::shared_ptr<pack::Pack> pack = nullptr;
+  // index of the first listed level of the pack.
+  usize pack_scroll = 0;
+
+  // list the levels of the open pack, and play the one picked.
+  UpdateResult update_pack(Input);
 };
 
 }; // namespace sbokena::game::scene
@@ -2,13 +2,20 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include <raylib.h>
 
 #include "direction.hh"
 #include "level.hh"
 #include "loader.hh"
+#include "portal.hh"
 #include "position.hh"
 
 using namespace sbokena::level;
@@ -17,6 +24,12 @@ using sbokena::position::Position;
 
 namespace sbokena::game::state {
 
+// the level's tiles and objects, found here first, so that headers
+// declaring types of the same names (such as the editor's) can be
+// included before this one.
+using sbokena::level::Object;
+using sbokena::level::Tile;
+
 // the result of calling `State::step`.
 // see that method's documentation for details.
 enum struct StepResult {
@@ -30,12 +43,47 @@ enum struct StepResult {
   PushYourself
 };
 
+// the result of calling `State::step_many`.
+struct StepManyResult {
+  // index of the move which stopped the batch, or the number of
+  // moves if none did.
+  usize index;
+  // the result of that move, or `Ok`.
+  StepResult result;
+  // hash of the state after the batch, see `RawState::hash`.
+  u64 hash;
+};
+
+// an object moved by a step, see `RawState::motions`.
+struct Motion {
+  Position<> from;
+  Position<> to;
+  // whether it went through a chain of portals, entering the first at
+  // `portal_in` and leaving the last at `portal_out`.
+  bool       portal = false;
+  Position<> portal_in {};
+  Position<> portal_out {};
+};
+
+// parse a LURD move string, e.g. `"urRd3l"`.
+//
+// each of `l`, `u`, `r` and `d` is one move in that direction.
+// case is ignored, since pushes are implied by the level. a move may
+// be prefixed by a decimal count to repeat it.
+//
+// throws `std::invalid_argument` on any other character.
+std::vector<Direction> parse_lurd(std::string_view);
+
+// format moves as a LURD move string, without counts.
+std::string to_lurd(std::span<const Direction>);
+
 using Level   = sbokena::loader::Level<Texture>;
-using DoorSet = Level::DoorSet;
-using Goals   = Level::Goals;
-using Tiles   = Level::Tiles;
+// never changed by a step, so frozen.
+using DoorSet = Level::FrozenDoorSet;
+using Doors   = Level::FrozenDoors;
+using Goals   = Level::FrozenGoals;
+using Tiles   = Level::FrozenTiles;
 using Objects = Level::Objects;
-using Doors   = Level::Doors;
 using Portals = Level::Portals;
 
 // the raw state machine.
@@ -52,6 +100,20 @@ struct RawState {
   // can be used to determine the reason.
   StepResult step(Direction);
 
+  // advance the world state by several steps, stopping at the first
+  // step which doesn't return `Ok`.
+  //
+  // steps that fail leave the world state unchanged, so the state
+  // after the batch is the state after `result.index` moves, or one
+  // more if `result.result` is `LevelComplete`.
+  StepManyResult step_many(std::span<const Direction>);
+
+  // `step_many`, from a LURD move string. see `parse_lurd`.
+  StepManyResult step_many(std::string_view lurd);
+
+  // a hash of the objects' positions, for comparing states.
+  u64 hash() const noexcept;
+
   // query current points.
   usize points_query() const;
 
@@ -64,10 +126,6 @@ struct RawState {
   // given position, return tile at that position.
   std::optional<Tile> find_tile(Position<>) const;
 
-  // return both exit position from Portal and direction of exit.
-  std::pair<Position<>, Direction>
-  get_portal_exit(Position<> portal_from, u32 id) const;
-
   // check if a door is opened, aka. one of its corresponding button
   // is being pressed.
   bool is_door_open(u32 id) const;
@@ -88,7 +146,20 @@ struct RawState {
   // portals grouped by id.
   const Portals portals;
 
+  // resolved portal exits, by entrance position.
+  const portal::Exits exits =
+    portal::compile(tiles, portals, tiles.get_allocator().resource());
+
+  // the objects moved by the last step, pushed ones first. only
+  // meaningful if that step returned `Ok` or `LevelComplete`, in
+  // which case the player always moved, and at most one box did.
+  std::array<Motion, 2> motions {};
+  usize                 motion_count = 0;
+
 private:
+  // check whether every goal has a box on it.
+  bool is_complete() const;
+
   // update the position of object in the map.
   void update_position(Position<> from, Position<> to);
 
@@ -100,11 +171,14 @@ private:
 // a known valid state machine.
 class State {
 public:
-  // create a `State` from a `Level`.
-  State(const Level &);
+  // create a `State` from a validated level, with or without a
+  // theme.
+  State(const sbokena::loader::LevelData &);
+
+  // the copy gets an arena of its own.
+  State(const State &);
 
   State()                         = delete;
-  State(const State &)            = default;
   State &operator=(const State &) = delete;
   State(State &&)                 = delete;
   State &operator=(State &&)      = delete;
@@ -113,10 +187,20 @@ public:
   // forward to `RawState::step`.
   StepResult step(Direction);
 
+  // forward to `RawState::step_many`.
+  StepManyResult step_many(std::span<const Direction>);
+
+  // forward to `RawState::step_many`.
+  StepManyResult step_many(std::string_view lurd);
+
   // the inner `RawState`.
   const RawState &inner() const noexcept;
 
 private:
+  // what the level's containers draw from. declared first, so it
+  // outlives them.
+  std::unique_ptr<sbokena::loader::Arena> arena;
+
   RawState state_;
 };
 
@@ -0,0 +1,320 @@
+#include "bitboard.hh"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <variant>
+
+#include "level.hh"
+#include "utils.hh"
+
+using namespace sbokena::utils;
+
+namespace sbokena::game::bitboard {
+
+// ===== Bits =====
+
+// the word operations below are plain loops over contiguous
+// words, written so that they auto-vectorize in optimized builds.
+
+Bits::Bits(usize size)
+  : size_ {size},
+    words_((size + WORD_BITS - 1) / WORD_BITS, 0) {}
+
+usize Bits::count() const noexcept {
+  usize n = 0;
+  for (const Word word : words_)
+    n += std::popcount(word);
+  return n;
+}
+
+bool Bits::any() const noexcept {
+  Word acc = 0;
+  for (const Word word : words_)
+    acc |= word;
+  return acc != 0;
+}
+
+usize Bits::first() const noexcept {
+  for (usize w = 0; w < words_.size(); ++w)
+    if (words_[w])
+      return w * WORD_BITS + std::countr_zero(words_[w]);
+  return size_;
+}
+
+Bits Bits::shifted(isize n) const {
+  Bits        out {size_};
+  const usize len = words_.size();
+  const usize abs = n < 0 ? -n : n;
+  const usize ws  = abs / WORD_BITS;
+  const usize bs  = abs % WORD_BITS;
+
+  if (ws >= len)
+    return out;
+
+  if (n >= 0) {
+    // towards higher indices
+    for (usize w = len - 1; w >= ws; --w) {
+      Word word = words_[w - ws] << bs;
+      if (bs && w > ws)
+        word |= words_[w - ws - 1] >> (WORD_BITS - bs);
+      out.words_[w] = word;
+      if (w == 0)
+        break;
+    }
+  } else {
+    // towards lower indices
+    for (usize w = 0; w + ws < len; ++w) {
+      Word word = words_[w + ws] >> bs;
+      if (bs && w + ws + 1 < len)
+        word |= words_[w + ws + 1] << (WORD_BITS - bs);
+      out.words_[w] = word;
+    }
+  }
+
+  // drop bits shifted past the end
+  if (size_ % WORD_BITS)
+    out.words_.back() &= (Word {1} << (size_ % WORD_BITS)) - 1;
+  return out;
+}
+
+Bits Bits::without(const Bits &rhs) const {
+  Bits out {*this};
+  for (usize w = 0; w < words_.size(); ++w)
+    out.words_[w] &= ~rhs.words_[w];
+  return out;
+}
+
+Bits &Bits::operator&=(const Bits &rhs) noexcept {
+  for (usize w = 0; w < words_.size(); ++w)
+    words_[w] &= rhs.words_[w];
+  return *this;
+}
+
+Bits &Bits::operator|=(const Bits &rhs) noexcept {
+  for (usize w = 0; w < words_.size(); ++w)
+    words_[w] |= rhs.words_[w];
+  return *this;
+}
+
+Bits operator&(Bits lhs, const Bits &rhs) noexcept {
+  return lhs &= rhs;
+}
+
+Bits operator|(Bits lhs, const Bits &rhs) noexcept {
+  return lhs |= rhs;
+}
+
+// ===== Layout =====
+
+Layout::Layout(const RawState &state) {
+  assert_throw(
+    !state.tiles.empty(), std::logic_error {"level has no tiles"}
+  );
+
+  Position<> min = POS_MAX<>;
+  Position<> max = POS_MIN<>;
+  for (const auto &[pos, _] : state.tiles) {
+    min = {
+      .x = std::min<u32>(min.x, pos.x),
+      .y = std::min<u32>(min.y, pos.y),
+    };
+    max = {
+      .x = std::max<u32>(max.x, pos.x),
+      .y = std::max<u32>(max.y, pos.y),
+    };
+  }
+
+  // leave a 1-cell border on every side
+  origin_ = {.x = min.x - 1, .y = min.y - 1};
+  stride_ = static_cast<usize>(max.x - min.x) + 3;
+  rows_   = static_cast<usize>(max.y - min.y) + 3;
+
+  const usize n = size();
+  floor         = Bits {n};
+  goals         = Bits {n};
+  buttons       = Bits {n};
+  doors         = Bits {n};
+  portals       = Bits {n};
+  for (usize d = 0; d < 4; ++d) {
+    dirfloors[d] = Bits {n};
+    passable[d]  = Bits {n};
+    exits[d]     = Bits {n};
+  }
+
+  for (const auto &[pos, tile] : state.tiles) {
+    const usize i = index(pos);
+    floor.set(i);
+
+    switch (tile.index()) {
+    case index_of<Tile, Floor>():
+      for (usize d = 0; d < 4; ++d)
+        passable[d].set(i);
+      break;
+    case index_of<Tile, Goal>():
+      goals.set(i);
+      for (usize d = 0; d < 4; ++d)
+        passable[d].set(i);
+      break;
+    case index_of<Tile, Button>():
+      buttons.set(i);
+      for (usize d = 0; d < 4; ++d)
+        passable[d].set(i);
+      break;
+    case index_of<Tile, Door>():
+      doors.set(i);
+      for (usize d = 0; d < 4; ++d)
+        exits[d].set(i);
+      break;
+    case index_of<Tile, Portal>(): {
+      const auto &portal = std::get<Portal>(tile);
+      portals.set(i);
+      exits[dir_index(portal.in_dir)].set(i);
+      break;
+    }
+    case index_of<Tile, DirFloor>(): {
+      const usize d = dir_index(std::get<DirFloor>(tile).dir);
+      dirfloors[d].set(i);
+      passable[d].set(i);
+      break;
+    }
+    }
+  }
+
+  for (usize d = 0; d < 4; ++d)
+    exits[d] |= passable[d];
+
+  walls = Bits {n};
+  for (usize i = 0; i < n; ++i)
+    if (!floor.test(i))
+      walls.set(i);
+}
+
+bool Layout::contains(Position<> pos) const noexcept {
+  const usize x = pos.x - origin_.x;
+  const usize y = pos.y - origin_.y;
+  return x < stride_ && y < rows_;
+}
+
+isize Layout::offset(Direction dir) const noexcept {
+  const isize stride = stride_;
+  switch (dir) {
+  case Direction::Up:
+    return -stride;
+  case Direction::Down:
+    return stride;
+  case Direction::Left:
+    return -1;
+  case Direction::Right:
+    return 1;
+  }
+  return 0;
+}
+
+// ===== Board =====
+
+Board::Board(const Layout &layout, const RawState &state)
+  : player {layout.size()},
+    boxes {layout.size()} {
+  for (auto &layer : dirboxes)
+    layer = Bits {layout.size()};
+
+  for (const auto &[pos, obj] : state.objects) {
+    const usize i = layout.index(pos);
+    switch (obj.index()) {
+    case index_of<Object, Player>():
+      player = i;
+      break;
+    case index_of<Object, Box>():
+      boxes.set(i);
+      break;
+    case index_of<Object, DirBox>():
+      dirboxes[dir_index(std::get<DirBox>(obj).dir)].set(i);
+      break;
+    }
+  }
+}
+
+Bits Board::all_boxes() const {
+  Bits out = boxes;
+  for (const auto &layer : dirboxes)
+    out |= layer;
+  return out;
+}
+
+usize Board::goals_filled(const Layout &layout) const noexcept {
+  // popcount(boxes & goals), without materializing the union
+  const auto  goals = layout.goals.words();
+  const auto  plain = boxes.words();
+  usize       n     = 0;
+  for (usize w = 0; w < goals.size(); ++w) {
+    Bits::Word word = plain[w];
+    for (const auto &layer : dirboxes)
+      word |= layer.words()[w];
+    n += std::popcount(word & goals[w]);
+  }
+  return n;
+}
+
+bool Board::complete(const Layout &layout) const noexcept {
+  const usize goals = layout.goals.count();
+  return goals > 0 && goals_filled(layout) == goals;
+}
+
+Bits Board::pushes(
+  const Layout &layout, Direction dir, const Bits &reach
+) const {
+  const usize d   = dir_index(dir);
+  const isize off = layout.offset(dir);
+
+  // box cells the player could push from, i.e. one cell ahead of a
+  // reachable cell that can be exited in `dir`
+  Bits from = (reach & layout.exits[d]).shifted(off);
+  // box cells the box could be pushed from, i.e. one cell behind a
+  // free, enterable cell
+  Bits into = layout.passable[d].without(all_boxes()).shifted(-off);
+
+  // boxes which may move in `dir`, and whose cell the player may
+  // then enter in `dir`
+  Bits movable = boxes | dirboxes[d];
+  movable &= layout.passable[d] | layout.doors;
+
+  return movable & from & into;
+}
+
+void Board::push(
+  const Layout &layout, usize box, Direction dir
+) noexcept {
+  const usize to = box + layout.offset(dir);
+
+  if (boxes.test(box)) {
+    boxes.reset(box);
+    boxes.set(to);
+  } else {
+    auto &layer = dirboxes[dir_index(dir)];
+    layer.reset(box);
+    layer.set(to);
+  }
+
+  player = box;
+}
+
+u64 Board::hash() const noexcept {
+  // splitmix64 finalizer, folded over every word
+  const auto mix = [](u64 x) {
+    x += 0x9e3779b97f4a7c15;
+    x  = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x  = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+  };
+
+  u64 h = mix(player);
+  for (const auto word : boxes.words())
+    h = mix(h ^ word);
+  for (const auto &layer : dirboxes)
+    for (const auto word : layer.words())
+      h = mix(h ^ word);
+  return h;
+}
+
+} // namespace sbokena::game::bitboard
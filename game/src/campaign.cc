@@ -0,0 +1,84 @@
+#include "campaign.hh"
+
+#include <fstream>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+
+#include "level.hh"
+#include "pack.hh"
+#include "profile.hh"
+
+using sbokena::level::RawLevel;
+using sbokena::pack::read_entry;
+
+namespace sbokena::game::campaign {
+
+Campaign::Campaign(std::shared_ptr<Pack> pack, usize index)
+  : pack {std::move(pack)},
+    index_ {index} {}
+
+Level<Texture> Campaign::load() {
+  SBK_PROFILE_SCOPE("Campaign::load");
+  // a prefetch may still be using the theme.
+  next = {};
+
+  // the raw level is only needed until it is validated.
+  std::pmr::monotonic_buffer_resource scratch;
+
+  const RawLevel raw = pack->load(index_, &scratch);
+  if (!theme || theme->name() != raw.theme)
+    theme.emplace(raw.theme, pack->path());
+  return Level<Texture> {raw, *theme};
+}
+
+void Campaign::prefetch() {
+  if (next.valid() || !has_next())
+    return;
+
+  // the pack's stream belongs to the main thread, so the level is
+  // read through another one.
+  const auto fetch = [pack  = pack,
+                      entry = pack->entries()[index_ + 1],
+                      theme = theme] {
+    SBK_PROFILE_SCOPE("Campaign::prefetch");
+    std::pmr::monotonic_buffer_resource scratch;
+
+    std::ifstream  file {pack->path(), std::ios::binary};
+    const RawLevel raw = read_entry(file, entry, &scratch);
+
+    Fetched fetched;
+    if (theme && theme->name() == raw.theme)
+      fetched.ready =
+        std::make_unique<const Level<Texture>>(raw, *theme);
+    else
+      fetched.decoded = std::make_unique<const Level<Image>>(
+        raw, Theme<Image> {raw.theme, pack->path()}
+      );
+    return fetched;
+  };
+  next = std::async(std::launch::async, fetch);
+}
+
+Level<Texture> Campaign::advance() {
+  SBK_PROFILE_SCOPE("Campaign::advance");
+  if (!has_next())
+    throw std::out_of_range("campaign: no next level");
+
+  prefetch();
+  // the prefetch is spent either way, so a level which failed is
+  // read again on the next try.
+  Fetched fetched = next.get();
+  if (!fetched.ready)
+    fetched.ready = std::make_unique<const Level<Texture>>(
+      *fetched.decoded
+    );
+
+  ++index_;
+  theme = fetched.ready->theme();
+  return Level<Texture> {*fetched.ready};
+}
+
+} // namespace sbokena::game::campaign
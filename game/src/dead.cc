@@ -0,0 +1,110 @@
+#include "dead.hh"
+
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "bitboard.hh"
+#include "state.hh"
+
+using sbokena::game::bitboard::DIRECTIONS;
+
+namespace sbokena::game::dead {
+
+namespace {
+// where a box on `from` lands when pushed in `dir`, following
+// `RawState::move_object`, or nothing if it can't move.
+std::optional<Position<>>
+push(const RawState &state, Position<> from, Direction dir) {
+  const Tile &from_tile = state.tiles.at(from);
+  if (!state.is_valid_dir(from_tile, dir))
+    return std::nullopt;
+
+  Position<> to   = from.move(dir);
+  Direction  last = dir;
+  auto       it   = state.tiles.find(to);
+  if (it == state.tiles.end())
+    return std::nullopt;
+
+  // a portal chain lands the box on the first cell past it.
+  if (std::holds_alternative<Portal>(it->second)) {
+    if (!state.is_valid_dir(it->second, dir))
+      return std::nullopt;
+    const auto exit = state.exits.find(to);
+    if (exit == state.exits.end() || !exit->second.open)
+      return std::nullopt;
+    for (const Direction hop : DIRECTIONS)
+      if ((exit->second.dirs & static_cast<u8>(hop))
+          && !state.is_valid_dir(from_tile, hop))
+        return std::nullopt;
+    to   = exit->second.pos;
+    last = exit->second.dir;
+    it   = state.tiles.find(to);
+    if (it == state.tiles.end())
+      return std::nullopt;
+  }
+
+  // a `DirFloor` is only checked when entered from its neighbour.
+  if (std::holds_alternative<DirFloor>(it->second)
+      && from.move(last) == to
+      && !state.is_valid_dir(it->second, last))
+    return std::nullopt;
+  return to;
+}
+} // namespace
+
+std::vector<Position<>> dead_squares(const RawState &state) {
+  const auto rests = [&](Position<> pos) {
+    const auto it = state.tiles.find(pos);
+    return it != state.tiles.end()
+        && !std::holds_alternative<Portal>(it->second);
+  };
+
+  // the player can push from any cell behind the box, or from a
+  // portal chain landing on the box.
+  std::set<std::pair<Position<>, Direction>> portal_pushes;
+  for (const auto &[_, exit] : state.exits)
+    if (exit.open)
+      portal_pushes.emplace(exit.pos, exit.dir);
+
+  // every push, backwards: the cells a box can be pushed from onto
+  // each cell.
+  std::map<Position<>, std::vector<Position<>>> pushed_from;
+  for (const auto &[pos, _] : state.tiles) {
+    if (!rests(pos))
+      continue;
+    for (const Direction dir : DIRECTIONS) {
+      if (!rests(pos.move(-dir))
+          && !portal_pushes.contains({pos, dir}))
+        continue;
+      if (const auto to = push(state, pos, dir))
+        pushed_from[*to].push_back(pos);
+    }
+  }
+
+  // the live cells are those a goal can be pushed back from.
+  const auto &goals = state.goals;
+  std::set<Position<>>    live(goals.begin(), goals.end());
+  std::vector<Position<>> queue(goals.begin(), goals.end());
+  while (!queue.empty()) {
+    const Position<> pos = queue.back();
+    queue.pop_back();
+    const auto it = pushed_from.find(pos);
+    if (it == pushed_from.end())
+      continue;
+    for (const Position<> from : it->second)
+      if (live.insert(from).second)
+        queue.push_back(from);
+  }
+
+  std::vector<Position<>> dead;
+  for (const auto &[pos, _] : state.tiles)
+    if (rests(pos) && !live.contains(pos))
+      dead.push_back(pos);
+  return dead;
+}
+
+} // namespace sbokena::game::dead
@@ -4,6 +4,7 @@
 #include <format>
 #include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 
 #include <raygui.h>
@@ -16,8 +17,9 @@
 #include "loader.hh"
 #include "pause.hh"
 #include "position.hh"
+#include "profile.hh"
 #include "scene.hh"
-#include "state.hh"
+#include "simulation.hh"
 #include "utils.hh"
 
 using namespace std::string_view_literals;
@@ -25,24 +27,29 @@ using namespace std::string_view_literals;
 using namespace sbokena::utils;
 using namespace sbokena::position;
 using sbokena::direction::Direction;
-using sbokena::game::state::StepResult;
+using sbokena::game::simulation::MOVE_LOG;
 using sbokena::loader::Level;
 
 namespace sbokena::game::scene {
 
-GameplayScene::GameplayScene(const Level<Texture> &level)
-  : state {level},
-    level {level},
+GameplayScene::GameplayScene(
+  const Level<Texture> &level, std::shared_ptr<Campaign> campaign
+)
+  : level {level},
+    tiles {level.freeze_tiles()},
+    campaign {std::move(campaign)},
+    sim {std::make_shared<Simulation>(level)},
     min {POS_MAX<>},
     max {POS_MIN<>} {
-  for (const auto &[pos, _] : state.inner().tiles) {
+  SBK_PROFILE_SCOPE("GameplayScene::GameplayScene");
+  for (const auto &[pos, _] : tiles) {
     min = {
-      .x = std::min(min.x, pos.x),
-      .y = std::min(min.y, pos.y),
+      .x = std::min<u32>(min.x, pos.x),
+      .y = std::min<u32>(min.y, pos.y),
     };
     max = {
-      .x = std::max(max.x, pos.x),
-      .y = std::max(max.y, pos.y),
+      .x = std::max<u32>(max.x, pos.x),
+      .y = std::max<u32>(max.y, pos.y),
     };
   }
 
@@ -55,46 +62,59 @@ void GameplayScene::draw() const {
   // TODO: show level background art?
   ClearBackground(DARKGREEN);
 
-  draw_viewport();
-  draw_hud();
+  const Simulation::View view = sim->latest();
+  drawn_version               = view->version;
+  draw_viewport(*view);
+  draw_hud(*view);
 }
 
 UpdateResult GameplayScene::update(Input in) {
-  const auto step = [&](Direction dir) -> UpdateResult {
-    switch (state.step(dir)) {
-    case StepResult::Ok:
-      ++moves;
-      break;
+  advance(GetTime());
 
-    case StepResult::LevelComplete:
+  u64 moves;
+  {
+    const Simulation::View view = sim->latest();
+    const Snapshot        &snap = *view;
+    moves                       = snap.moves;
+
+    if (snap.steps != seen) {
+      animate(snap);
+
+      // the next level loads while the last boxes are pushed.
+      const usize boxes_left = level.goals().size() - snap.points;
+      if (campaign && boxes_left <= PREFETCH_BOXES_LEFT)
+        campaign->prefetch();
+    }
+
+    // the level is over once its last move has played.
+    if (snap.complete && queued)
+      return UpdateOk {};
+    if (snap.complete)
       return UpdateTransition {
         .next = std::unique_ptr<Scene> {
-          new LevelCompleteScene {level, moves}
+          new LevelCompleteScene {level, moves, campaign}
         },
       };
+  }
 
-    // TODO: play animations
-    case StepResult::HitWall:
-    case StepResult::InvalidDirection:
-    case StepResult::PushTwoObjects:
-    case StepResult::PushYourself:
-    case StepResult::SlamOnDoor:
-      break;
-    }
-
-    player_dir = dir;
-    return UpdateOk {};
-  };
+  // click-to-move: walk to the clicked cell along a shortest path.
+  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+    if (const auto cell = cell_at(GetMousePosition()))
+      sim->send(*cell);
 
   switch (in) {
   case Input::INPUT_UP:
-    return step(Direction::Up);
+    sim->send(Direction::Up);
+    break;
   case Input::INPUT_DOWN:
-    return step(Direction::Down);
+    sim->send(Direction::Down);
+    break;
   case Input::INPUT_LEFT:
-    return step(Direction::Left);
+    sim->send(Direction::Left);
+    break;
   case Input::INPUT_RIGHT:
-    return step(Direction::Right);
+    sim->send(Direction::Right);
+    break;
 
   case Input::INPUT_MENU:
   case Input::INPUT_BACK:
@@ -116,41 +136,154 @@ UpdateResult GameplayScene::update(Input in) {
   return UpdateOk {};
 }
 
-void GameplayScene::draw_viewport() const {
-  const usize   screen_w = GetScreenWidth();
-  const usize   screen_h = GetScreenHeight();
-  const Vector2 screen_size {
-    .x = static_cast<f32>(screen_w),
-    .y = static_cast<f32>(screen_h),
+void GameplayScene::animate(const Snapshot &snap) {
+  // steps too old to be in the snapshot's log are skipped.
+  seen = std::max(seen, snap.steps - std::min(snap.steps, MOVE_LOG));
+  for (; seen < snap.steps; ++seen) {
+    // skip the oldest move rather than lose track of the newest.
+    if (queued == MAX_QUEUED) {
+      --queued;
+      queue_first   = (queue_first + 1) % MAX_QUEUED;
+      played_before = played = 0;
+    }
+    queue[(queue_first + queued++) % MAX_QUEUED] =
+      snap.log[seen % MOVE_LOG];
+  }
+}
+
+void GameplayScene::advance(f64 now) {
+  // measured here rather than with `GetFrameTime`, which counts the
+  // time spent waiting for input too.
+  const f64 elapsed = now - clock;
+  clock             = now;
+  if (!queued) {
+    lag = 0;
+    return;
+  }
+
+  lag = std::min(lag + elapsed, MAX_LAG);
+  for (; lag >= TICK && queued; lag -= TICK) {
+    // moves play faster the more of them wait, so the animation
+    // never trails far behind the input.
+    played_before  = played;
+    played        += TICK / MOVE_TIME * queued;
+    while (queued && played >= 1) {
+      --queued;
+      queue_first    = (queue_first + 1) % MAX_QUEUED;
+      played        -= 1;
+      played_before -= 1;
+    }
+  }
+
+  if (!queued)
+    played_before = played = lag = 0;
+}
+
+Vector2 GameplayScene::drawn_at(
+  Position<> pos, f64 progress, const Snapshot &snap
+) const {
+  const auto cell = [&](Position<> p) {
+    return Vector2 {
+      .x = static_cast<f32>(p.x - min.x),
+      .y = static_cast<f32>(p.y - min.y),
+    };
+  };
+  // undo a move which hasn't started playing.
+  const auto undo = [&](const Move &move) {
+    for (usize j = 0; j < move.count; ++j)
+      if (move.motions[j].to == pos) {
+        pos = move.motions[j].from;
+        return;
+      }
   };
 
-  // ===== draw viewport background =====
+  // steps published since the queue was last fed haven't even been
+  // queued yet.
+  const u64 logged = std::min(snap.steps - seen, MOVE_LOG);
+  for (u64 i = snap.steps; i > snap.steps - logged; --i)
+    undo(snap.log[(i - 1) % MOVE_LOG]);
+
+  // then the queued moves, newest first, up to the one playing.
+  const usize playing = static_cast<usize>(progress);
+  for (usize i = queued; i-- > playing;) {
+    const Move &move = queue[(queue_first + i) % MAX_QUEUED];
+    if (i > playing) {
+      undo(move);
+      continue;
+    }
+    for (usize j = 0; j < move.count; ++j) {
+      const Motion &motion = move.motions[j];
+      if (motion.to != pos)
+        continue;
+
+      const f32 t = progress - playing;
+      if (!motion.portal)
+        return Vector2Lerp(cell(motion.from), cell(motion.to), t);
+      // into the first portal, then out of the last one.
+      if (t < 0.5f)
+        return Vector2Lerp(
+          cell(motion.from), cell(motion.portal_in), 2 * t
+        );
+      return Vector2Lerp(
+        cell(motion.portal_out), cell(motion.to), 2 * t - 1
+      );
+    }
+  }
+  return cell(pos);
+}
 
-  const f32     level_aspect  = ([&]() {
-    const f32 width_  = width;
-    const f32 height_ = height;
-    return width_ / height_;
-  })();
-  const Vector2 viewport_size = ([&]() -> Vector2 {
-    const f32 screen_w_ = screen_w;
-    const f32 screen_h_ = screen_h;
-    if (screen_h_ * level_aspect > screen_w_)
-      return {screen_w_, screen_w_ / level_aspect};
+GameplayScene::Viewport GameplayScene::viewport() const {
+  const f32 screen_w = GetScreenWidth();
+  const f32 screen_h = GetScreenHeight();
+
+  const f32     level_aspect = static_cast<f32>(width) / height;
+  const Vector2 size         = ([&]() -> Vector2 {
+    if (screen_h * level_aspect > screen_w)
+      return {screen_w, screen_w / level_aspect};
     else
-      return {screen_h_ * level_aspect, screen_h_};
+      return {screen_h * level_aspect, screen_h};
   })();
-  const Vector2 viewport_pos  = (screen_size - viewport_size) / 2;
-  DrawRectangleV(viewport_pos, viewport_size, BLACK);
-
-  // ===== draw level grid ====
-
   const Vector2 level_size {
     .x = static_cast<f32>(width),
     .y = static_cast<f32>(height),
   };
-  const Vector2 cell_size = viewport_size / level_size;
+
+  return {
+    .pos       = (Vector2 {screen_w, screen_h} - size) / 2,
+    .size      = size,
+    .cell_size = size / level_size,
+  };
+}
+
+std::optional<Position<>>
+GameplayScene::cell_at(Vector2 point) const {
+  const Viewport view = viewport();
+  const Vector2  cell = (point - view.pos) / view.cell_size;
+  if (cell.x < 0 || cell.y < 0 || cell.x >= width || cell.y >= height)
+    return std::nullopt;
+  return Position<> {
+    .x = min.x + static_cast<u32>(cell.x),
+    .y = min.y + static_cast<u32>(cell.y),
+  };
+}
+
+void GameplayScene::draw_viewport(const Snapshot &snap) const {
+  SBK_PROFILE_SCOPE("GameplayScene::draw_viewport");
+  const Viewport view = viewport();
+
+  // ===== draw viewport background =====
+
+  DrawRectangleV(view.pos, view.size, BLACK);
+
+  // ===== draw level grid ====
+
+  const Vector2 cell_size = view.cell_size;
   const f32 sprite_scale  = cell_size.x / level.theme().tile_size();
 
+  // the tiles are in the same row-major order as the grid, so each
+  // one is found by walking them alongside it.
+  auto tile = tiles.begin();
+
   using Index = decltype(Position<>::x);
   for (Index y = 0; y < height; ++y)
     for (Index x = 0; x < width; ++x) {
@@ -159,22 +292,43 @@ void GameplayScene::draw_viewport() const {
         .y = min.y + y,
       };
       const Vector2 cell_pos {
-        .x = viewport_pos.x + x * cell_size.x,
-        .y = viewport_pos.y + y * cell_size.y,
+        .x = view.pos.x + x * cell_size.x,
+        .y = view.pos.y + y * cell_size.y,
       };
 
-      const auto tile_sprite = tile_sprite_at(cell_index_pos);
-      const auto obj_sprite_ = obj_sprite_at(cell_index_pos);
+      const Tile *here = nullptr;
+      if (tile != tiles.end()
+          && static_cast<Position<>>(tile->first) == cell_index_pos)
+        here = &(tile++)->second;
 
-      DrawTextureEx(tile_sprite, cell_pos, 0, sprite_scale, WHITE);
-      if (obj_sprite_) {
-        const auto &obj_sprite = obj_sprite_.value();
-        DrawTextureEx(obj_sprite, cell_pos, 0, sprite_scale, WHITE);
-      }
+      const auto sprite = tile_sprite(here, snap);
+      DrawTextureEx(sprite, cell_pos, 0, sprite_scale, WHITE);
     }
+
+  // ===== draw objects =====
+
+  // between the last two ticks of the animation clock, and never
+  // back into a move which already finished.
+  const f64 alpha = lag / TICK;
+  const f64 drawn =
+    std::max(played_before + (played - played_before) * alpha, 0.0);
+  // the player faces the way of the move playing.
+  const usize playing = static_cast<usize>(drawn);
+  const Direction facing =
+    queued ? queue[(queue_first + playing) % MAX_QUEUED].dir
+           : snap.facing;
+
+  // after every tile, so that moving objects are drawn over them.
+  for (const auto &[pos, obj] : snap.objects) {
+    const Vector2 cell_pos =
+      view.pos + drawn_at(pos, drawn, snap) * cell_size;
+    const Texture sprite = obj_sprite(obj, facing);
+    DrawTextureEx(sprite, cell_pos, 0, sprite_scale, WHITE);
+  }
 }
 
-void GameplayScene::draw_hud() const {
+void GameplayScene::draw_hud(const Snapshot &snap) const {
+  SBK_PROFILE_SCOPE("GameplayScene::draw_hud");
   const Font font = GuiGetFont();
 
   const Vector2 ctr_view_pos {
@@ -190,7 +344,7 @@ void GameplayScene::draw_hud() const {
   // ===== draw move counter =====
 
   const std::string_view move_ctr = "moves"sv;
-  const std::string      move_cnt = std::format("{}", moves);
+  const std::string      move_cnt = std::format("{}", snap.moves);
 
   const Vector2 move_ctr_size =
     MeasureTextEx(font, move_ctr.data(), ctr_font_size, ctr_spacing);
@@ -227,8 +381,7 @@ void GameplayScene::draw_hud() const {
   // ===== draw goal counter =====
 
   const std::string_view goal_ctr = "goals"sv;
-  const std::string      goal_cnt =
-    std::format("{}", state.inner().points_query());
+  const std::string      goal_cnt = std::format("{}", snap.points);
 
   const Vector2 goal_ctr_size =
     MeasureTextEx(font, goal_ctr.data(), ctr_font_size, ctr_spacing);
@@ -274,10 +427,11 @@ T select_dir(Direction dir, T up, T down, T left, T right) {
   }
 }
 
-Texture GameplayScene::tile_sprite_at(Position<> pos) const {
+Texture GameplayScene::tile_sprite(
+  const Tile *tile, const Snapshot &snap
+) const {
   const auto &theme   = level.theme();
   const auto &sprites = theme.sprites();
-  const auto  tile    = state.inner().find_tile(pos);
 
   if (!tile)
     return *sprites[theme.WALL];
@@ -291,7 +445,7 @@ Texture GameplayScene::tile_sprite_at(Position<> pos) const {
         return *sprites[theme.BUTTON];
       },
       [&](const Door &door) -> const auto & {
-        const bool open = state.inner().is_door_open(door.door_id);
+        const bool open = snap.is_door_open(door.door_id);
         return *sprites[open ? theme.DOOR_OPEN : theme.DOOR_CLOSED];
       },
       [&](const Portal &portal) -> const auto & {
@@ -316,18 +470,15 @@ Texture GameplayScene::tile_sprite_at(Position<> pos) const {
         return *sprites[theme.GOAL];
       }
     },
-    tile.value()
+    *tile
   );
 }
 
-std::optional<Texture>
-GameplayScene::obj_sprite_at(Position<> pos) const {
+Texture GameplayScene::obj_sprite(
+  const Object &obj, Direction player_dir
+) const {
   const auto &theme   = level.theme();
   const auto &sprites = theme.sprites();
-  const auto  obj     = state.inner().find_object(pos);
-
-  if (!obj)
-    return std::nullopt;
 
   return std::visit(
     overload {
@@ -353,7 +504,7 @@ GameplayScene::obj_sprite_at(Position<> pos) const {
         )];
       },
     },
-    obj.value()
+    obj
   );
 }
 
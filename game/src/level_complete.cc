@@ -1,12 +1,16 @@
 #include "level_complete.hh"
 
+#include <exception>
 #include <memory>
+#include <print>
 #include <string>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 #include <raygui.h>
 #include <raylib.h>
 
+#include "gameplay.hh"
 #include "level.hh"
 #include "scene.hh"
 #include "start_menu.hh"
@@ -18,10 +22,17 @@ using sbokena::level::Difficulty;
 namespace sbokena::game::scene {
 
 LevelCompleteScene::LevelCompleteScene(
-  const Level<Texture> &level, u64 moves
+  const Level<Texture>     &level,
+  u64                       moves,
+  std::shared_ptr<Campaign> campaign
 )
   : level {level},
-    moves {moves} {}
+    moves {moves},
+    campaign {std::move(campaign)} {
+  // usually already started by `GameplayScene`.
+  if (this->campaign)
+    this->campaign->prefetch();
+}
 
 void LevelCompleteScene::draw() const {
   ClearBackground(VIOLET);
@@ -144,7 +155,7 @@ void LevelCompleteScene::draw() const {
   );
 }
 
-UpdateResult LevelCompleteScene::update(Input) {
+UpdateResult LevelCompleteScene::update(Input input) {
   const usize screen_w = GetScreenWidth();
   const usize screen_h = GetScreenHeight();
 
@@ -154,20 +165,48 @@ UpdateResult LevelCompleteScene::update(Input) {
     .y = std::min(200.0f, static_cast<f32>(screen_h) / 6),
   };
 
+  // the next level of the campaign sits right of `home`.
+  const bool has_next = campaign && campaign->has_next();
+  const f32  view_w   = has_next ? btn_size.x * 2.2f : btn_size.x;
+
   const Rectangle back_bounds = {
-    .x      = screen_w / 2 - btn_size.x / 2,
+    .x      = screen_w / 2 - view_w / 2,
+    .y      = static_cast<f32>(screen_h) * 3 / 4,
+    .width  = btn_size.x,
+    .height = btn_size.y
+  };
+  const Rectangle next_bounds = {
+    .x      = screen_w / 2 + view_w / 2 - btn_size.x,
     .y      = static_cast<f32>(screen_h) * 3 / 4,
     .width  = btn_size.x,
     .height = btn_size.y
   };
 
   const bool back = GuiButton(back_bounds, "home");
+  const bool next = has_next
+                 && (GuiButton(next_bounds, "next")
+                     || input == Input::INPUT_ENTER);
 
   if (back)
     return UpdateTransition {
       .next = std::unique_ptr<Scene> {new StartMenuScene},
     };
 
+  if (next) {
+    // prefetched since the last pushes, so usually instant.
+    try {
+      const Level<Texture> next_level = campaign->advance();
+      return UpdateTransition {
+        .next = std::unique_ptr<Scene> {
+          new GameplayScene {next_level, campaign}
+        },
+      };
+    } catch (std::exception &ex) {
+      std::println("level load failed: {}", ex.what());
+      campaign.reset();
+    }
+  }
+
   return UpdateOk {};
 }
 
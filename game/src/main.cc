@@ -8,6 +8,8 @@
 
 #include "level_complete.hh"
 #include "pause.hh"
+#include "profile.hh"
+#include "profile_overlay.hh"
 #include "scene.hh"
 #include "start_menu.hh"
 #include "types.hh"
@@ -33,6 +35,12 @@ constexpr u32 SCREEN_H_MAX        = 2160;
 constexpr u32 RAYGUI_TEXT_SIZE    = 30;
 constexpr u32 RAYGUI_TEXT_SPACING = 4;
 
+// frames drawn after an input: one to handle it, and one to show its
+// result.
+constexpr u32 FRAMES_AFTER_INPUT = 2;
+// how often input is checked for while idle, in seconds.
+constexpr f64 IDLE_WAIT = 1.0 / 60;
+
 i32 main() {
   // ===== initialize raylib =====
 
@@ -53,27 +61,80 @@ i32 main() {
 
   NFD::Guard _nfd;
 
+  // ===== initialize profiler =====
+
+#ifdef SBOKENA_PROFILE
+  // writes a trace on exit, if `SBOKENA_TRACE` is set.
+  sbokena::profile::TraceSession _trace;
+
+  // whether the overlay is shown, toggled with F3.
+  bool show_profile = false;
+#endif
+
   // ===== main loop =====
 
+  // draw only when the screen would change, unless asked to draw
+  // every frame.
+  const char *render      = std::getenv("SBOKENA_RENDER");
+  const bool  on_demand   = !render || render != "continuous"sv;
+  u32         frames_left = FRAMES_AFTER_INPUT;
+
   std::unique_ptr<Scene> cur {new StartMenuScene};
   std::unique_ptr<Scene> next {nullptr};
 
   while (!WindowShouldClose()) {
+    // ===== idle phase =====
+
+#ifdef SBOKENA_PROFILE
+    const bool overlay_dirty = show_profile;
+#else
+    const bool overlay_dirty = false;
+#endif
+
+    const bool idle = !frames_left && !overlay_dirty && !cur->dirty();
+    if (on_demand && idle) {
+      SBK_PROFILE_SCOPE("idle");
+      // what `EndDrawing` would do, minus the drawing. the input
+      // polled is then handled by the next frame drawn.
+      WaitTime(IDLE_WAIT);
+      PollInputEvents();
+      if (input_arrived())
+        frames_left = FRAMES_AFTER_INPUT;
+      continue;
+    }
+    if (frames_left)
+      --frames_left;
+
+    SBK_PROFILE_FRAME();
+
     // ===== draw phase =====
 
     BeginDrawing();
-    Deferred _ {EndDrawing};
-    cur->draw();
+    Deferred _ {[] {
+      // includes waiting for vsync.
+      SBK_PROFILE_SCOPE("present");
+      EndDrawing();
+    }};
+    {
+      SBK_PROFILE_SCOPE("draw");
+      cur->draw();
+    }
 
     // ===== input phase =====
 
-    const auto  key   = GetKeyPressed();
-    const auto  btn   = GetGamepadButtonPressed();
-    const Input input = from_queues(key, btn);
+    const Input input = [] {
+      SBK_PROFILE_SCOPE("input");
+      const auto key = GetKeyPressed();
+      const auto btn = GetGamepadButtonPressed();
+      return from_queues(key, btn);
+    }();
 
     // ===== update phase =====
 
-    UpdateResult res = cur->update(input);
+    UpdateResult res = [&] {
+      SBK_PROFILE_SCOPE("update");
+      return cur->update(input);
+    }();
     switch (res.index()) {
     // scene doesn't want to transition
     case index_of<UpdateResult, UpdateOk>():
@@ -92,9 +153,19 @@ i32 main() {
       return EXIT_SUCCESS;
     }
 
+#ifdef SBOKENA_PROFILE
+    if (IsKeyPressed(KEY_F3))
+      show_profile = !show_profile;
+    if (show_profile)
+      sbokena::game::overlay::draw_profile();
+#endif
+
     // ===== transition phase =====
 
-    if (next)
-      cur = std::move(next);
+    if (next) {
+      SBK_PROFILE_SCOPE("transition");
+      cur         = std::move(next);
+      frames_left = FRAMES_AFTER_INPUT;
+    }
   }
 }
@@ -0,0 +1,86 @@
+#include "profile_overlay.hh"
+
+#include <algorithm>
+#include <format>
+#include <string>
+
+#include <raylib.h>
+
+#include "profile.hh"
+#include "types.hh"
+
+using namespace sbokena::types;
+
+namespace profile = sbokena::profile;
+
+namespace sbokena::game::overlay {
+
+void draw_profile() {
+  const profile::Summary sum = profile::summary();
+
+  // ===== layout =====
+
+  // the time of a frame at 60 FPS, and the top of the graph.
+  const f32 budget_ms = 1000.0f / 60;
+  const f32 graph_ms  = budget_ms * 2;
+
+  const i32 pad       = 8;
+  const i32 font_size = 10;
+  const i32 line_h    = font_size + 4;
+  const i32 graph_w   = profile::FRAMES;
+  const i32 graph_h   = 60;
+  const i32 lines     = 1 + static_cast<i32>(sum.phases.size());
+
+  const i32 width  = graph_w + 2 * pad;
+  const i32 height = graph_h + lines * line_h + 3 * pad;
+  const i32 x      = GetScreenWidth() - width - pad;
+  const i32 y      = pad;
+
+  DrawRectangle(x, y, width, height, Fade(BLACK, 0.75f));
+
+  // ===== draw frame graph =====
+
+  // one bar per frame, newest on the right.
+  const i32 graph_x = x + pad;
+  const i32 graph_y = y + pad;
+  const i32 first   = graph_w - static_cast<i32>(sum.frames.size());
+  for (usize i = 0; i < sum.frames.size(); ++i) {
+    const f32   ms = sum.frames[i];
+    const i32   h  = std::min(ms / graph_ms, 1.0f) * graph_h;
+    const Color color =
+      ms <= budget_ms ? GREEN : (ms <= graph_ms ? ORANGE : RED);
+    DrawRectangle(
+      graph_x + first + static_cast<i32>(i),
+      graph_y + graph_h - h,
+      1,
+      h,
+      color
+    );
+  }
+
+  // the budget sits halfway up the graph.
+  const i32 budget_y = graph_y + graph_h / 2;
+  DrawLine(graph_x, budget_y, graph_x + graph_w, budget_y, GRAY);
+
+  // ===== draw times =====
+
+  i32 text_y = graph_y + graph_h + pad;
+
+  const std::string frames = std::format(
+    "frame ms  p50 {:.1f}  p95 {:.1f}  p99 {:.1f}  max {:.1f}",
+    sum.p50,
+    sum.p95,
+    sum.p99,
+    sum.max
+  );
+  DrawText(frames.c_str(), graph_x, text_y, font_size, WHITE);
+
+  for (const auto &[name, ms] : sum.phases) {
+    text_y += line_h;
+    const std::string line =
+      std::format("{:<24}{:7.2f} ms", name, ms);
+    DrawText(line.c_str(), graph_x, text_y, font_size, LIGHTGRAY);
+  }
+}
+
+} // namespace sbokena::game::overlay
@@ -0,0 +1,343 @@
+#include "reach.hh"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <variant>
+
+#include "level.hh"
+#include "portal.hh"
+#include "utils.hh"
+
+using namespace sbokena::utils;
+using sbokena::game::bitboard::DIRECTIONS;
+using sbokena::game::bitboard::dir_index;
+
+namespace sbokena::game::reach {
+
+Reachability::Reachability(const RawState &state)
+  : layout_ {state} {
+  const usize n = layout_.size();
+  next_.assign(n * 4, NONE);
+  door_.assign(n, NONE);
+  button_.assign(n, NONE);
+  mark_.assign(n, 0);
+  queue_.reserve(n);
+
+  // give every door id a dense slot.
+  std::unordered_map<u32, u32> slots;
+  const auto slot = [&](u32 id) {
+    return slots.try_emplace(id, slots.size()).first->second;
+  };
+  for (const auto &[pos, tile] : state.tiles) {
+    if (const auto *door = std::get_if<Door>(&tile))
+      door_[layout_.index(pos)] = slot(door->door_id);
+    else if (const auto *button = std::get_if<Button>(&tile))
+      button_[layout_.index(pos)] = slot(button->door_id);
+  }
+  pressed_.assign(slots.size(), 0);
+
+  // the destination of every non-pushing move, following the same
+  // checks as `RawState::move_object`. portals are assumed to be
+  // free of objects, since boxes pushed into one always come out of
+  // the other end.
+  for (const auto &[from, from_tile] : state.tiles) {
+    const usize i = layout_.index(from);
+    for (const Direction dir : DIRECTIONS) {
+      if (!state.is_valid_dir(from_tile, dir))
+        continue;
+
+      const Position<> to      = from.move(dir);
+      const auto       to_tile = state.find_tile(to);
+      if (!to_tile)
+        continue;
+
+      if (const auto *portal = std::get_if<Portal>(&*to_tile)) {
+        const auto iter = state.exits.find(to);
+        if (portal->in_dir != dir || iter == state.exits.end())
+          continue;
+        const portal::Exit &exit = iter->second;
+
+        // the exit check is repeated for every hop.
+        bool valid = exit.open;
+        for (const Direction hop : DIRECTIONS)
+          if (exit.dirs & static_cast<u8>(hop))
+            valid &= state.is_valid_dir(from_tile, hop);
+
+        // the chain may end on a wall, or on a `DirFloor`, which is
+        // checked as if it was entered from `from`.
+        const auto out_tile = state.find_tile(exit.pos);
+        if (!valid || !out_tile)
+          continue;
+        if (std::holds_alternative<DirFloor>(*out_tile)
+            && from.move(exit.dir) == exit.pos
+            && !state.is_valid_dir(*out_tile, exit.dir))
+          continue;
+
+        next_[i * 4 + dir_index(dir)] = layout_.index(exit.pos);
+        continue;
+      }
+
+      if (std::holds_alternative<DirFloor>(*to_tile)
+          && !state.is_valid_dir(*to_tile, dir))
+        continue;
+
+      next_[i * 4 + dir_index(dir)] = layout_.index(to);
+    }
+  }
+
+  // invert the moves, counting those into each cell first.
+  into_start_.assign(n + 1, 0);
+  for (const u32 to : next_)
+    if (to != NONE)
+      ++into_start_[to + 1];
+  std::partial_sum(
+    into_start_.begin(), into_start_.end(), into_start_.begin()
+  );
+  into_.resize(into_start_[n]);
+  std::vector<u32> fill {into_start_.begin(), into_start_.end() - 1};
+  for (usize move = 0; move < next_.size(); ++move)
+    if (next_[move] != NONE)
+      into_[fill[next_[move]]++] = move;
+
+  flood(state);
+}
+
+void Reachability::flood(const RawState &state) {
+  blocked_.assign(layout_.size(), 0);
+  std::fill(pressed_.begin(), pressed_.end(), 0);
+
+  u32 player = NONE;
+  for (const auto &[pos, obj] : state.objects) {
+    const u32 i = layout_.index(pos);
+    if (std::holds_alternative<Player>(obj)) {
+      player = i;
+      continue;
+    }
+    blocked_[i] = 1;
+    if (button_[i] != NONE)
+      ++pressed_[button_[i]];
+  }
+  assert_throw(
+    player != NONE, std::logic_error {"level has no player"}
+  );
+
+  restart(player);
+}
+
+void Reachability::update(
+  Position<> player_from, Position<> box_from, Position<> box_to
+) {
+  const u32 from = layout_.index(box_from);
+  const u32 to   = layout_.index(box_to);
+
+  blocked_[from] = 0;
+  blocked_[to]   = 1;
+
+  // a door toggles when its button count crosses 0.
+  bool toggled = false;
+  if (button_[from] != NONE)
+    toggled |= --pressed_[button_[from]] == 0;
+  if (button_[to] != NONE)
+    toggled |= pressed_[button_[to]]++ == 0;
+
+  // if the player can walk back, every cell reachable before the
+  // push still is, but for `to` and what was only reachable through
+  // it, and `from` is the only newly freed cell. so the region only
+  // needs to grow from there.
+  const u32 back     = layout_.index(player_from);
+  bool      can_back = false;
+  for (usize d = 0; d < 4; ++d)
+    can_back |= next_[from * 4 + d] == back && enterable(from, back);
+
+  // the box may have cut the region in two, unless the cells past
+  // `to` are still found around it. the top-left-most cell is only
+  // kept track of as the region grows, so losing it re-floods too.
+  const bool cut = mark_[to] == gen_;
+  ++version_;
+  if (toggled || !can_back
+      || (cut && (to == min_ || !bypassed(from, to)))) {
+    restart(from);
+    return;
+  }
+
+  if (cut) {
+    mark_[to] = 0;
+    --count_;
+  }
+  queue_.clear();
+  mark(from);
+  search();
+}
+
+bool Reachability::reachable(Position<> pos) const noexcept {
+  return layout_.contains(pos) && mark_[layout_.index(pos)] == gen_;
+}
+
+Bits Reachability::region() const {
+  Bits out {layout_.size()};
+  for (usize i = 0; i < mark_.size(); ++i)
+    if (mark_[i] == gen_)
+      out.set(i);
+  return out;
+}
+
+bool Reachability::enterable(u32 from, u32 to) const noexcept {
+  if (blocked_[to])
+    return false;
+  const u32 door = door_[to];
+  // the player keeps a door open while standing on its button.
+  return door == NONE || pressed_[door] > 0 || button_[from] == door;
+}
+
+void Reachability::update(
+  const RawState &state, Position<> player_from
+) {
+  const Position<> player = state.find_player();
+  // a walk never ends on a box.
+  if (!blocked_[layout_.index(player)])
+    return;
+
+  // the pushed box is the only one on an unblocked cell.
+  for (const auto &[pos, obj] : state.objects)
+    if (!std::holds_alternative<Player>(obj)
+        && !blocked_[layout_.index(pos)]) {
+      update(player_from, player, pos);
+      return;
+    }
+}
+
+std::optional<std::vector<Direction>>
+Reachability::path(Position<> from, Position<> to) {
+  if (!reachable(to))
+    return std::nullopt;
+
+  const u32 target = layout_.index(to);
+  if (target_ != target || field_version_ != version_) {
+    if (seen_.empty()) {
+      seen_.assign(layout_.size(), 0);
+      toward_.assign(layout_.size(), NONE);
+      via_.assign(layout_.size(), 0);
+    }
+    if (++field_gen_ == 0) {
+      std::fill(seen_.begin(), seen_.end(), 0);
+      field_gen_ = 1;
+    }
+    target_        = target;
+    field_version_ = version_;
+    ++searches_;
+
+    // breadth-first search over the moves into each cell, reusing
+    // the region's queue.
+    queue_.clear();
+    queue_.push_back(target);
+    seen_[target] = field_gen_;
+    for (usize head = 0; head < queue_.size(); ++head) {
+      const u32 cell = queue_[head];
+      const u32 end = into_start_[cell + 1];
+      for (u32 i = into_start_[cell]; i < end; ++i) {
+        const u32 move = into_[i];
+        const u32 prev = move / 4;
+        if (seen_[prev] == field_gen_ || !enterable(prev, cell))
+          continue;
+        seen_[prev]   = field_gen_;
+        toward_[prev] = cell;
+        via_[prev]    = move % 4;
+        queue_.push_back(prev);
+      }
+    }
+  }
+
+  u32 cell = layout_.index(from);
+  if (seen_[cell] != field_gen_)
+    return std::nullopt;
+
+  std::vector<Direction> out;
+  for (; cell != target; cell = toward_[cell])
+    out.push_back(DIRECTIONS[via_[cell]]);
+  return out;
+}
+
+void Reachability::restart(u32 start) noexcept {
+  // start a new generation, clearing the marks when it wraps around.
+  if (++gen_ == 0) {
+    std::fill(mark_.begin(), mark_.end(), 0);
+    gen_ = 1;
+  }
+  count_ = 0;
+  min_   = NONE;
+  ++floods_;
+  ++version_;
+
+  queue_.clear();
+  mark(start);
+  search();
+}
+
+void Reachability::mark(u32 cell) noexcept {
+  mark_[cell] = gen_;
+  ++count_;
+  min_ = std::min(min_, cell);
+  queue_.push_back(cell);
+}
+
+bool Reachability::bypassed(u32 start, u32 cut) noexcept {
+  // any walk through `cut` goes on to one of these.
+  std::array<u32, 4> targets {};
+  usize              left = 0;
+  for (usize d = 0; d < 4; ++d) {
+    const u32 next = next_[cut * 4 + d];
+    if (next != NONE && mark_[next] == gen_
+        && std::find(targets.begin(), targets.begin() + left, next)
+             == targets.begin() + left)
+      targets[left++] = next;
+  }
+
+  if (probe_.empty())
+    probe_.assign(layout_.size(), 0);
+  if (++probe_gen_ == 0) {
+    std::fill(probe_.begin(), probe_.end(), 0);
+    probe_gen_ = 1;
+  }
+
+  // in open floor, the cells around the box are a few steps away.
+  // `cut` is blocked by now, so the search never enters it.
+  constexpr usize PROBE_LIMIT = 64;
+  const auto      end         = targets.begin() + left;
+  queue_.clear();
+  queue_.push_back(start);
+  probe_[start] = probe_gen_;
+  for (usize head = 0;
+       left > 0 && head < queue_.size() && head < PROBE_LIMIT;
+       ++head) {
+    const u32 cell = queue_[head];
+    for (usize d = 0; d < 4; ++d) {
+      const u32 next = next_[cell * 4 + d];
+      if (next == NONE || probe_[next] == probe_gen_
+          || !enterable(cell, next))
+        continue;
+      probe_[next] = probe_gen_;
+      left -= std::find(targets.begin(), end, next) != end;
+      queue_.push_back(next);
+    }
+  }
+  return left == 0;
+}
+
+void Reachability::search() noexcept {
+  // `queue_` never holds a cell twice, and has room for every cell,
+  // so pushing never reallocates.
+  for (usize head = 0; head < queue_.size(); ++head) {
+    const u32 cell = queue_[head];
+    for (usize d = 0; d < 4; ++d) {
+      const u32 to = next_[cell * 4 + d];
+      if (to == NONE || mark_[to] == gen_ || !enterable(cell, to))
+        continue;
+      mark(to);
+    }
+  }
+}
+
+} // namespace sbokena::game::reach
@@ -2,6 +2,10 @@
 
 #include <raylib.h>
 
+#include "types.hh"
+
+using namespace sbokena::types;
+
 namespace sbokena::game::scene {
 
 Input from_queues(
@@ -49,4 +53,26 @@ Input from_queues(
   }
 }
 
+bool input_arrived() {
+  if (IsWindowResized() || GetGamepadButtonPressed())
+    return true;
+
+  const Vector2 delta = GetMouseDelta();
+  if (delta.x || delta.y || GetMouseWheelMove())
+    return true;
+  for (const auto btn : {
+         MOUSE_BUTTON_LEFT,
+         MOUSE_BUTTON_RIGHT,
+         MOUSE_BUTTON_MIDDLE,
+       })
+    if (IsMouseButtonPressed(btn) || IsMouseButtonReleased(btn))
+      return true;
+
+  // key codes are sparse, but checking all of them is still cheap.
+  for (i32 key = KEY_SPACE; key <= KEY_KB_MENU; ++key)
+    if (IsKeyPressed(key) || IsKeyPressedRepeat(key))
+      return true;
+  return false;
+}
+
 } // namespace sbokena::game::scene
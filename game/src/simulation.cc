@@ -0,0 +1,153 @@
+#include "simulation.hh"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "profile.hh"
+#include "state.hh"
+
+using sbokena::game::state::RawState;
+using sbokena::game::state::StepResult;
+
+namespace sbokena::game::simulation {
+
+bool Snapshot::is_door_open(u32 id) const {
+  const auto iter = std::ranges::lower_bound(
+    doors, id, {}, &std::pair<u32, bool>::first
+  );
+  return iter->second;
+}
+
+Simulation::Simulation(const sbokena::loader::LevelData &level)
+  : state {level},
+    reach {state.inner()} {
+  for (const auto &[id, _] : state.inner().doors)
+    door_ids.push_back(id);
+  std::ranges::sort(door_ids);
+
+  // both snapshots are sized once, so publishing doesn't allocate.
+  for (Snapshot &snapshot : buffers) {
+    snapshot.objects.reserve(state.inner().objects.size());
+    snapshot.doors.reserve(door_ids.size());
+  }
+  publish();
+
+  worker = std::jthread {[this](std::stop_token stop) { run(stop); }};
+}
+
+Simulation::~Simulation() {
+  worker.request_stop();
+  // the worker is joined as it is destroyed.
+}
+
+void Simulation::send(Command command) {
+  {
+    std::scoped_lock _ {input_lock};
+    inputs.push_back(command);
+  }
+  input_ready.notify_one();
+}
+
+Simulation::View Simulation::latest() const {
+  std::scoped_lock _ {snapshot_lock};
+  ++readers[front];
+  return View {*this, front};
+}
+
+Simulation::View::~View() {
+  {
+    std::scoped_lock _ {sim.snapshot_lock};
+    --sim.readers[index];
+  }
+  sim.snapshot_freed.notify_one();
+}
+
+void Simulation::run(std::stop_token stop) {
+  std::vector<Command> batch;
+  while (true) {
+    {
+      std::unique_lock lock {input_lock};
+      input_ready.wait(lock, stop, [&] { return !inputs.empty(); });
+      if (stop.stop_requested())
+        return;
+      batch.swap(inputs);
+    }
+
+    for (const Command &command : batch)
+      std::visit([&](const auto &cmd) { apply(cmd); }, command);
+    batch.clear();
+    publish();
+  }
+}
+
+void Simulation::apply(Direction dir) {
+  SBK_PROFILE_SCOPE("Simulation::apply");
+  if (complete)
+    return;
+  const Position<> player_from = state.inner().find_player();
+
+  facing = dir;
+  switch (state.step(dir)) {
+  case StepResult::Ok:
+    ++moves;
+    reach.update(state.inner(), player_from);
+    break;
+
+  case StepResult::LevelComplete:
+    complete = true;
+    break;
+
+  case StepResult::HitWall:
+  case StepResult::InvalidDirection:
+  case StepResult::PushTwoObjects:
+  case StepResult::PushYourself:
+  case StepResult::SlamOnDoor:
+    return;
+  }
+
+  const RawState &inner   = state.inner();
+  log[steps++ % MOVE_LOG] = {
+    .dir     = dir,
+    .motions = inner.motions,
+    .count   = inner.motion_count,
+  };
+}
+
+void Simulation::apply(Position<> cell) {
+  const auto path = reach.path(state.inner().find_player(), cell);
+  if (path)
+    for (const Direction dir : *path)
+      apply(dir);
+}
+
+void Simulation::publish() {
+  SBK_PROFILE_SCOPE("Simulation::publish");
+  std::unique_lock lock {snapshot_lock};
+  // only the front snapshot gets new readers, so once the back one
+  // is let go of, it can be filled without holding the lock.
+  const usize back = 1 - front;
+  snapshot_freed.wait(lock, [&] { return readers[back] == 0; });
+  lock.unlock();
+
+  const RawState &inner    = state.inner();
+  Snapshot       &snapshot = buffers[back];
+  snapshot.objects.assign(inner.objects.begin(), inner.objects.end());
+  snapshot.doors.clear();
+  for (const u32 id : door_ids)
+    snapshot.doors.emplace_back(id, inner.is_door_open(id));
+  snapshot.version  = published.load(std::memory_order_relaxed) + 1;
+  snapshot.moves    = moves;
+  snapshot.points   = inner.points_query();
+  snapshot.facing   = facing;
+  snapshot.complete = complete;
+  snapshot.steps    = steps;
+  snapshot.log      = log;
+
+  lock.lock();
+  front = back;
+  published.store(snapshot.version, std::memory_order_release);
+}
+
+} // namespace sbokena::game::simulation
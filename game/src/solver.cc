@@ -0,0 +1,138 @@
+#include "solver.hh"
+
+#include <algorithm>
+#include <stop_token>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "bitboard.hh"
+#include "state.hh"
+
+using sbokena::game::bitboard::DIRECTIONS;
+using sbokena::game::bitboard::dir_index;
+using sbokena::game::state::Objects;
+using sbokena::game::state::StepResult;
+
+namespace sbokena::game::solver {
+
+namespace {
+// every state visited, keyed by `RawState::hash`, but told apart by
+// their objects, so that two states with equal hashes are never
+// mistaken for one another.
+//
+// each state is packed into one word per object, in the order of
+// `RawState::objects`. objects are never added or removed, so every
+// state takes the same number of words.
+class Seen {
+public:
+  explicit Seen(usize width)
+    : width {width} {}
+
+  Seen(const Seen &)            = delete;
+  Seen &operator=(const Seen &) = delete;
+
+  // add the objects of a state, unless an equal state was added
+  // already.
+  bool insert(const RawState &state) {
+    const usize id = hashes.size();
+    for (const auto &[pos, obj] : state.objects) {
+      u64 kind = obj.index();
+      if (const auto *box = std::get_if<DirBox>(&obj))
+        kind |= dir_index(box->dir) << 2;
+      words.push_back(u64 {pos.y} << 32 | u64 {pos.x} << 16 | kind);
+    }
+    hashes.push_back(state.hash());
+
+    if (ids.insert(id).second)
+      return true;
+    words.resize(id * width);
+    hashes.pop_back();
+    return false;
+  }
+
+  // number of distinct states added.
+  usize size() const noexcept {
+    return hashes.size();
+  }
+
+private:
+  struct Hash {
+    const Seen *seen;
+
+    usize operator()(usize id) const noexcept {
+      return seen->hashes[id];
+    }
+  };
+
+  struct Equal {
+    const Seen *seen;
+
+    bool operator()(usize a, usize b) const noexcept {
+      const auto  words = seen->words.begin();
+      const usize width = seen->width;
+      return std::equal(
+        words + a * width, words + (a + 1) * width, words + b * width
+      );
+    }
+  };
+
+  usize            width;
+  std::vector<u64> words;
+  std::vector<u64> hashes;
+  // ids of the states, indexing `hashes` and, by `width`, `words`.
+  std::unordered_set<usize, Hash, Equal> ids {
+    0, Hash {this}, Equal {this}
+  };
+};
+} // namespace
+
+Result
+solve(const RawState &start, usize budget, std::stop_token stop) {
+  // every state shares the tiles of `start`, so only the objects are
+  // stored per state, and moves are tried on a single scratch state.
+  RawState scratch = start;
+
+  Seen seen {start.objects.size()};
+  seen.insert(start);
+  std::vector<Objects> layer {start.objects};
+  std::vector<Objects> next;
+
+  const auto result = [&](Verdict verdict, usize moves) {
+    return Result {
+      .verdict = verdict,
+      .moves   = moves,
+      .nodes   = seen.size(),
+    };
+  };
+
+  // breadth-first, one layer per move, so the first completed state
+  // found is one of the fewest moves.
+  for (usize depth = 1; !layer.empty(); ++depth) {
+    for (const Objects &objects : layer) {
+      if (stop.stop_requested() || seen.size() >= budget)
+        return result(Verdict::Unknown, 0);
+
+      // failed steps leave the state unchanged, so it only needs to
+      // be restored after a successful one.
+      scratch.objects = objects;
+      for (const auto dir : DIRECTIONS) {
+        const auto res = scratch.step(dir);
+        if (res == StepResult::LevelComplete)
+          return result(Verdict::Solvable, depth);
+        if (res != StepResult::Ok)
+          continue;
+        if (seen.insert(scratch))
+          next.push_back(scratch.objects);
+        scratch.objects = objects;
+      }
+    }
+    layer.swap(next);
+    next.clear();
+  }
+
+  return result(Verdict::Unsolvable, 0);
+}
+
+} // namespace sbokena::game::solver
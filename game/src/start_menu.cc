@@ -2,33 +2,63 @@
 
 #include <algorithm>
 #include <exception>
+#include <format>
 #include <fstream>
+#include <memory>
+#include <memory_resource>
 #include <print>
-#include <sstream>
+#include <string>
 
-#include <nlohmann/json.hpp>
 #include <raygui.h>
 #include <raylib.h>
 #include <raymath.h>
 
+#include "campaign.hh"
 #include "gameplay.hh"
 #include "level.hh"
 #include "loader.hh"
+#include "pack.hh"
 #include "scene.hh"
 #include "types.hh"
 #include "utils.hh"
 
 using namespace std::string_view_literals;
 
-using nlohmann::json;
-
 using namespace sbokena::level;
 using namespace sbokena::types;
 using namespace sbokena::utils;
 using namespace sbokena::loader;
+using sbokena::game::campaign::Campaign;
+using sbokena::pack::Pack;
 
 namespace sbokena::game::scene {
 
+namespace {
+// start playing a level, looking for its theme upwards from a path.
+UpdateResult play(const RawLevel &raw_level, const fs::path &path) {
+  const Theme<Texture> theme {raw_level.theme, path};
+  const Level<Texture> level {raw_level, theme};
+
+  return UpdateTransition {
+    .next = std::unique_ptr<Scene> {new GameplayScene {level}},
+  };
+}
+
+const char *diff_name(Difficulty diff) {
+  switch (diff) {
+  case Difficulty::Unknown:
+    return "unknown";
+  case Difficulty::Easy:
+    return "easy";
+  case Difficulty::Medium:
+    return "medium";
+  case Difficulty::Hard:
+    return "hard";
+  }
+  return "unknown";
+}
+} // namespace
+
 void StartMenuScene::draw() const {
   ClearBackground(VIOLET);
 
@@ -58,7 +88,11 @@ void StartMenuScene::draw() const {
   );
 }
 
-UpdateResult StartMenuScene::update(Input) {
+bool StartMenuScene::dirty() const {
+  return show_failed_load.has_value();
+}
+
+UpdateResult StartMenuScene::update(Input input) {
   const usize screen_w = GetScreenWidth();
   const usize screen_h = GetScreenHeight();
   const Font  font     = GuiGetFont();
@@ -73,7 +107,7 @@ UpdateResult StartMenuScene::update(Input) {
     .x = static_cast<float>(screen_w / 2),
     .y = static_cast<float>(screen_h * 2 / 3),
   };
-  const Vector2 view_size = view_btn_size * Vector2 {.x = 1, .y = 2};
+  const Vector2 view_size = view_btn_size * Vector2 {.x = 1, .y = 3};
   const Vector2 view_pos  = view_center - view_size / 2;
 
   // ===== draw messages =====
@@ -101,6 +135,9 @@ UpdateResult StartMenuScene::update(Input) {
       show_failed_load.reset();
   }
 
+  if (pack)
+    return update_pack(input);
+
   // ===== draw buttons =====
 
   const Rectangle load_bounds = {
@@ -109,15 +146,22 @@ UpdateResult StartMenuScene::update(Input) {
     .width  = view_btn_size.x,
     .height = view_btn_size.y * 0.9f,
   };
-  const Rectangle quit_bounds = {
+  const Rectangle pack_bounds = {
     .x      = view_pos.x,
     .y      = view_pos.y + view_btn_size.y,
     .width  = view_btn_size.x,
     .height = view_btn_size.y * 0.9f,
   };
+  const Rectangle quit_bounds = {
+    .x      = view_pos.x,
+    .y      = view_pos.y + view_btn_size.y * 2,
+    .width  = view_btn_size.x,
+    .height = view_btn_size.y * 0.9f,
+  };
 
-  const bool load = GuiButton(load_bounds, "load");
-  const bool quit = GuiButton(quit_bounds, "quit");
+  const bool load      = GuiButton(load_bounds, "load");
+  const bool open_pack = GuiButton(pack_bounds, "pack");
+  const bool quit      = GuiButton(quit_bounds, "quit");
 
   // ===== handle buttons =====
 
@@ -128,17 +172,9 @@ UpdateResult StartMenuScene::update(Input) {
     const auto path = _path.value();
 
     try {
-      std::ifstream     file {path};
-      std::stringstream buf;
-      buf << file.rdbuf();
-
-      const RawLevel       raw_level = json::parse(buf.str());
-      const Theme<Texture> theme {raw_level.theme, path};
-      const Level<Texture> level {raw_level, theme};
-
-      return UpdateTransition {
-        .next = std::unique_ptr<Scene> {new GameplayScene {level}},
-      };
+      std::ifstream                       file {path};
+      std::pmr::monotonic_buffer_resource scratch;
+      return play(read_json(file, &scratch), path);
     } catch (std::exception &ex) {
       std::println("level load failed: {}", ex.what());
       show_failed_load = GetTime();
@@ -146,10 +182,147 @@ UpdateResult StartMenuScene::update(Input) {
     }
   }
 
+  if (open_pack) {
+    const auto path = open_file_dialog(PACK_FILTER);
+    if (!path)
+      return UpdateOk {};
+
+    // only the index is read here, however many levels there are.
+    try {
+      pack        = std::make_shared<Pack>(path.value());
+      pack_scroll = 0;
+    } catch (std::exception &ex) {
+      std::println("pack load failed: {}", ex.what());
+      show_failed_load = GetTime();
+    }
+    return UpdateOk {};
+  }
+
   if (quit)
     return UpdateClose {};
 
   return UpdateOk {};
 }
 
+UpdateResult StartMenuScene::update_pack(Input input) {
+  const usize screen_w = GetScreenWidth();
+  const usize screen_h = GetScreenHeight();
+  const Font  font     = GuiGetFont();
+  const auto  entries  = pack->entries();
+
+  // the list spans the screen below the title, one button per row.
+  const Rectangle list_bounds {
+    .x      = static_cast<f32>(screen_w) / 10,
+    .y      = static_cast<f32>(screen_h) * 0.4f,
+    .width  = static_cast<f32>(screen_w) * 0.8f,
+    .height = static_cast<f32>(screen_h) * 0.45f,
+  };
+  const f32   row_h = 40;
+  const usize rows  = std::max<usize>(list_bounds.height / row_h, 1);
+
+  // ===== scroll =====
+
+  // rows scrolled by one notch of the mouse wheel.
+  const f32 wheel_rows = 3;
+
+  i64 scroll = static_cast<i64>(pack_scroll);
+  scroll -= static_cast<i64>(GetMouseWheelMove() * wheel_rows);
+  switch (input) {
+  case Input::INPUT_UP:
+    --scroll;
+    break;
+  case Input::INPUT_DOWN:
+    ++scroll;
+    break;
+  case Input::INPUT_LEFT:
+    scroll -= static_cast<i64>(rows);
+    break;
+  case Input::INPUT_RIGHT:
+    scroll += static_cast<i64>(rows);
+    break;
+  default:
+    break;
+  }
+  const usize last =
+    entries.size() > rows ? entries.size() - rows : 0;
+  pack_scroll = static_cast<usize>(std::clamp<i64>(scroll, 0, last));
+
+  // ===== draw list =====
+
+  // only the visible rows are drawn, so the list costs the same
+  // whatever the size of the pack.
+  std::optional<usize> picked;
+  const usize end = std::min(pack_scroll + rows, entries.size());
+  for (usize i = pack_scroll; i < end; ++i) {
+    const auto       &entry = entries[i];
+    const std::string label = std::format(
+      "{}. {} ({}, {}x{})",
+      i + 1,
+      entry.name.empty() ? "untitled" : entry.name,
+      diff_name(entry.diff),
+      entry.width,
+      entry.height
+    );
+    const Rectangle bounds {
+      .x      = list_bounds.x,
+      .y      = list_bounds.y + (i - pack_scroll) * row_h,
+      .width  = list_bounds.width,
+      .height = row_h * 0.9f,
+    };
+    if (GuiButton(bounds, label.c_str()))
+      picked = i;
+  }
+
+  const std::string shown =
+    entries.empty()
+      ? std::string {"empty pack"}
+      : std::format(
+          "{}-{} of {}", pack_scroll + 1, end, entries.size()
+        );
+  const f32 shown_font_size = 24;
+  const f32 shown_spacing   = 5;
+  DrawTextEx(
+    font,
+    shown.c_str(),
+    {list_bounds.x, list_bounds.y - shown_font_size - 10},
+    shown_font_size,
+    shown_spacing,
+    WHITE
+  );
+
+  const Rectangle back_bounds {
+    .x      = list_bounds.x,
+    .y      = list_bounds.y + list_bounds.height + 10,
+    .width  = std::min(300.0f, static_cast<f32>(screen_w) / 6),
+    .height = row_h,
+  };
+  const bool back = GuiButton(back_bounds, "back");
+
+  // ===== handle input =====
+
+  if (back || input == Input::INPUT_BACK) {
+    pack.reset();
+    return UpdateOk {};
+  }
+
+  if (picked) {
+    // the level is read only now, straight from its offset, and the
+    // levels after it are played in order.
+    try {
+      const auto campaign =
+        std::make_shared<Campaign>(pack, picked.value());
+      return UpdateTransition {
+        .next = std::unique_ptr<Scene> {
+          new GameplayScene {campaign->load(), campaign}
+        },
+      };
+    } catch (std::exception &ex) {
+      std::println("level load failed: {}", ex.what());
+      show_failed_load = GetTime();
+    }
+  }
+
+  return UpdateOk {};
+}
+
 } // namespace sbokena::game::scene
@@ -1,34 +1,265 @@
 #include "state.hh"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "level.hh"
+#include "profile.hh"
 #include "utils.hh"
 
 using namespace sbokena::utils;
 
 namespace sbokena::game::state {
 
-State::State(const Level &level)
-  : state_ {
-      .goals   = level.goals(),
-      .tiles   = level.tiles(),
-      .objects = level.objects(),
-      .doors   = level.doors(),
-      .portals = level.portals()
+std::vector<Direction> parse_lurd(std::string_view lurd) {
+  std::vector<Direction> out;
+  out.reserve(lurd.size());
+
+  usize count = 0;
+  for (const char c : lurd) {
+    if (c >= '0' && c <= '9') {
+      count = count * 10 + (c - '0');
+      continue;
+    }
+
+    Direction dir;
+    switch (std::tolower(static_cast<unsigned char>(c))) {
+    case 'l':
+      dir = Direction::Left;
+      break;
+    case 'u':
+      dir = Direction::Up;
+      break;
+    case 'r':
+      dir = Direction::Right;
+      break;
+    case 'd':
+      dir = Direction::Down;
+      break;
+    default:
+      throw std::invalid_argument {
+        std::string {"invalid LURD move: "} + c
+      };
+    }
+
+    out.insert(out.end(), count ? count : 1, dir);
+    count = 0;
+  }
+
+  assert_throw(
+    count == 0, std::invalid_argument {"LURD count without a move"}
+  );
+  return out;
+}
+
+std::string to_lurd(std::span<const Direction> dirs) {
+  std::string out;
+  out.reserve(dirs.size());
+  for (const Direction dir : dirs)
+    switch (dir) {
+    case Direction::Up:
+      out += 'u';
+      break;
+    case Direction::Down:
+      out += 'd';
+      break;
+    case Direction::Left:
+      out += 'l';
+      break;
+    case Direction::Right:
+      out += 'r';
+      break;
+    }
+  return out;
+}
+
+State::State(const sbokena::loader::LevelData &level)
+  : arena {sbokena::loader::make_arena(level.tiles().size())},
+    state_ {
+      .goals   = level.freeze_goals(arena.get()),
+      .tiles   = level.freeze_tiles(arena.get()),
+      .objects = Objects(level.objects(), arena.get()),
+      .doors   = level.freeze_doors(arena.get()),
+      .portals = Portals(level.portals(), arena.get())
+    } {}
+
+State::State(const State &other)
+  : arena {sbokena::loader::make_arena(other.state_.tiles.size())},
+    state_ {
+      .goals        = Goals(other.state_.goals, arena.get()),
+      .tiles        = Tiles(other.state_.tiles, arena.get()),
+      .objects      = Objects(other.state_.objects, arena.get()),
+      .doors        = Doors(other.state_.doors, arena.get()),
+      .portals      = Portals(other.state_.portals, arena.get()),
+      .exits        = portal::Exits(other.state_.exits, arena.get()),
+      .motions      = other.state_.motions,
+      .motion_count = other.state_.motion_count
     } {}
 
 StepResult State::step(Direction dir) {
+  SBK_PROFILE_SCOPE("State::step");
   return state_.step(dir);
 }
 
+StepManyResult State::step_many(std::span<const Direction> dirs) {
+  return state_.step_many(dirs);
+}
+
+StepManyResult State::step_many(std::string_view lurd) {
+  return state_.step_many(lurd);
+}
+
 const RawState &State::inner() const noexcept {
   return state_;
 }
 
+// ===== rule tables =====
+
+namespace {
+// tiles and objects are told apart by their alternative and, for the
+// directed ones, their direction. the kind of an undirected one uses
+// the first direction.
+constexpr usize DIRS = 4;
+
+constexpr usize TILE_KINDS   = std::variant_size_v<Tile> * DIRS;
+constexpr usize OBJECT_KINDS = std::variant_size_v<Object> * DIRS + 1;
+// the kind standing for no object.
+constexpr usize NO_OBJECT = OBJECT_KINDS - 1;
+
+// the index of a direction, from 0 to 3.
+constexpr usize dir_index(Direction dir) noexcept {
+  return std::countr_zero(static_cast<u8>(dir));
+}
+
+// the direction a tile or an object is tied to.
+template <typename T>
+constexpr Direction tied_dir(const T &) noexcept {
+  return Direction::Up;
+}
+
+constexpr Direction tied_dir(const DirFloor &floor) noexcept {
+  return floor.dir;
+}
+
+constexpr Direction tied_dir(const Portal &portal) noexcept {
+  return portal.in_dir;
+}
+
+constexpr Direction tied_dir(const DirBox &box) noexcept {
+  return box.dir;
+}
+
+template <typename V>
+constexpr usize kind_of(const V &v) noexcept {
+  const auto dir = [](const auto &alt) {
+    return dir_index(tied_dir(alt));
+  };
+  return v.index() * DIRS + std::visit(dir, v);
+}
+
+// the directions in which an object may leave a tile of each kind.
+constexpr auto EXIT_MASK = [] {
+  std::array<u8, TILE_KINDS> masks {};
+  for (usize kind = 0; kind < TILE_KINDS; ++kind) {
+    const usize alt  = kind / DIRS;
+    const bool  tied = alt == index_of<Tile, DirFloor>()
+                    || alt == index_of<Tile, Portal>();
+    masks[kind] = tied ? 1 << (kind % DIRS) : 0b1111;
+  }
+  return masks;
+}();
+
+// the directions in which the player may push an object of each
+// kind.
+constexpr auto PUSH_MASK = [] {
+  std::array<u8, OBJECT_KINDS> masks {};
+  for (usize kind = 0; kind < OBJECT_KINDS; ++kind) {
+    const bool tied = kind / DIRS == index_of<Object, DirBox>();
+    masks[kind]     = tied ? 1 << (kind % DIRS) : 0b1111;
+  }
+  return masks;
+}();
+
+// how a tile is entered, once the object on it is pushed away.
+enum struct Enter : u8 {
+  Open,
+  // a `DirFloor` against its direction, which is only open to
+  // objects leaving a portal onto it.
+  Exit,
+  // a closed `Door` is slammed on.
+  Door,
+  // an entrance of a `Portal`.
+  Portal,
+  // a `Portal` from the wrong side.
+  Closed,
+};
+
+// what moving onto a tile does.
+struct Rule {
+  // the move fails at once, unless this is `Ok`.
+  StepResult fail = StepResult::Ok;
+  // the object on the tile is pushed first.
+  bool  push  = false;
+  Enter enter = Enter::Open;
+};
+
+constexpr Rule
+make_rule(bool player, usize tile, usize dir, usize object) {
+  Rule rule;
+
+  if (object != NO_OBJECT) {
+    if (!player)
+      rule.fail = StepResult::PushTwoObjects;
+    else if (object / DIRS == index_of<Object, Player>())
+      rule.fail = StepResult::PushYourself;
+    else if (!(PUSH_MASK[object] & 1 << dir))
+      rule.fail = StepResult::InvalidDirection;
+    else
+      rule.push = true;
+  }
+
+  const usize alt     = tile / DIRS;
+  const bool  forward = tile % DIRS == dir;
+  if (alt == index_of<Tile, DirFloor>())
+    rule.enter = forward ? Enter::Open : Enter::Exit;
+  else if (alt == index_of<Tile, Portal>())
+    rule.enter = forward ? Enter::Portal : Enter::Closed;
+  else if (alt == index_of<Tile, Door>())
+    // an object under the door kept it open.
+    rule.enter = object == NO_OBJECT ? Enter::Door : Enter::Open;
+  return rule;
+}
+
+// the index of a rule in `RULES`.
+constexpr usize
+rule_index(bool player, usize tile, usize dir, usize object) {
+  return ((player * TILE_KINDS + tile) * DIRS + dir) * OBJECT_KINDS
+       + object;
+}
+
+// every rule, by whether the player moves, the kind of the tile, the
+// direction, and the kind of the object on the tile.
+constexpr auto RULES = [] {
+  std::array<Rule, 2 * TILE_KINDS * DIRS * OBJECT_KINDS> rules {};
+  for (const bool player : {false, true})
+    for (usize tile = 0; tile < TILE_KINDS; ++tile)
+      for (usize dir = 0; dir < DIRS; ++dir)
+        for (usize object = 0; object < OBJECT_KINDS; ++object)
+          rules[rule_index(player, tile, dir, object)] =
+            make_rule(player, tile, dir, object);
+  return rules;
+}();
+} // namespace
+
 Position<> RawState::find_player() const {
   const auto iter =
     std::find_if(objects.begin(), objects.end(), [](const auto &p) {
@@ -52,22 +283,6 @@ std::optional<Tile> RawState::find_tile(const Position<> pos) const {
   return {iter->second};
 }
 
-std::pair<Position<>, Direction>
-RawState::get_portal_exit(Position<> portal_from, u32 id) const {
-  auto portal_iter = portals.find(id);
-  assert_throw(
-    portal_iter != portals.end(),
-    std::logic_error {"portal not found"}
-  );
-  const auto      portal_pair = portal_iter->second;
-  const auto      portal_to   = portal_from == portal_pair.first
-                                ? portal_pair.second
-                                : portal_pair.first;
-  const Tile      portal_to_  = find_tile(portal_to).value();
-  const Direction out_dir     = -std::get<Portal>(portal_to_).in_dir;
-  return {portal_to.move(out_dir), out_dir};
-}
-
 usize RawState::points_query() const {
   return std::ranges::count_if(
     goals.begin(), goals.end(), [&](Position<> p) {
@@ -89,18 +304,11 @@ bool RawState::is_door_open(const u32 id) const {
 }
 
 bool RawState::is_valid_dir(const Tile &tile, Direction dir) const {
-  if (std::holds_alternative<DirFloor>(tile))
-    return std::get<DirFloor>(tile).dir == dir;
-  if (std::holds_alternative<Portal>(tile))
-    return std::get<Portal>(tile).in_dir == dir;
-  // if not either DirFloor or Portal, the direction is always true.
-  return true;
+  return EXIT_MASK[kind_of(tile)] & static_cast<u8>(dir);
 }
 
 bool RawState::is_valid_dir(const Object &box, Direction step) const {
-  if (std::holds_alternative<DirBox>(box))
-    return std::get<DirBox>(box).dir == step;
-  return true;
+  return PUSH_MASK[kind_of(box)] & static_cast<u8>(step);
 }
 
 void RawState::update_position(
@@ -113,99 +321,188 @@ void RawState::update_position(
   auto handle  = objects.extract(from);
   handle.key() = to;
   objects.insert(std::move(handle));
+
+  if (motion_count < motions.size())
+    motions[motion_count++] = {.from = from, .to = to};
 }
 
 std::optional<StepResult>
 RawState::move_object(Direction dir, Position<> from, Position<> to) {
-  const Object self = objects.at(from);
-
-  // on exit event: check if current tile is DirFloor.
-  const Tile from_tile = tiles.at(from);
+  // only the player pushes.
+  const bool  player    = objects.at(from).index()
+                     == index_of<Object, Player>();
+  const Tile &from_tile = tiles.at(from);
+  const usize from_kind = kind_of(from_tile);
 
   // check validity of exit.
-  if (!is_valid_dir(from_tile, dir))
+  if (!(EXIT_MASK[from_kind] & static_cast<u8>(dir)))
     return StepResult::InvalidDirection;
 
-  // find destination tile.
-  const auto to_tile_ = find_tile(to);
-
   // hit wall.
-  if (!to_tile_)
+  const auto to_iter = tiles.find(to);
+  if (to_iter == tiles.end())
     return StepResult::HitWall;
-  const Tile to_tile = to_tile_.value();
-
-  const auto to_object_ = find_object(to);
-  if (to_object_) {
-    Object to_object = to_object_.value();
-    // only call move_object when self is player and object is not.
-    if (std::holds_alternative<Player>(self)
-        && !std::holds_alternative<Player>(to_object)) {
-      // check moving direction of object
-      if (!is_valid_dir(to_object, dir))
-        return StepResult::InvalidDirection;
-
-      // return if not okay, else continue to moving self.
-      const auto res = move_object(dir, to, to.move(dir));
-      if (res)
-        return res;
-    } else
-      // self is Box, cannot push anything.
-      if (!std::holds_alternative<Player>(self))
-        return StepResult::PushTwoObjects;
-      else
-        return StepResult::PushYourself;
-  }
+  const Tile &to_tile = to_iter->second;
+
+  const auto  object_iter = objects.find(to);
+  const usize object      = object_iter == objects.end()
+                            ? NO_OBJECT
+                            : kind_of(object_iter->second);
 
-  switch (to_tile.index()) {
-  case index_of<Tile, Floor>():
-  case index_of<Tile, Goal>():
-  case index_of<Tile, Button>():
-    update_position(from, to);
+  const usize index =
+    rule_index(player, kind_of(to_tile), dir_index(dir), object);
+  const Rule &rule = RULES[index];
+  if (rule.fail != StepResult::Ok)
+    return rule.fail;
+
+  // return if the push failed, else continue to moving self.
+  if (rule.push)
+    if (const auto res = move_object(dir, to, to.move(dir)))
+      return res;
+
+  switch (rule.enter) {
+  case Enter::Open:
     break;
-  case index_of<Tile, DirFloor>():
-    // if not from Portal, must check direction.
+  case Enter::Exit:
+    // only coming out of a portal, which lands beside it.
     if (from.move(dir) == to)
-      if (!is_valid_dir(to_tile, dir))
-        return StepResult::InvalidDirection;
-    update_position(from, to);
+      return StepResult::InvalidDirection;
     break;
-  case index_of<Tile, Door>(): {
-    const Door &door = std::get<Door>(to_tile);
-    // if door is not opened and there's no object under door to be
-    // pushed, slam on door.
-    if (!is_door_open(door.door_id) && !to_object_)
+  case Enter::Door:
+    if (!is_door_open(std::get<Door>(to_tile).door_id))
       return StepResult::SlamOnDoor;
-    update_position(from, to);
     break;
-  }
-  case index_of<Tile, Portal>(): {
-    // always check direction when enter Portal.
-    if (!is_valid_dir(to_tile, dir))
+  case Enter::Closed:
+    return StepResult::InvalidDirection;
+  case Enter::Portal: {
+    const auto exit_iter = exits.find(to);
+    assert_throw(
+      exit_iter != exits.end(), std::logic_error {"portal not found"}
+    );
+    const portal::Exit &exit = exit_iter->second;
+
+    // every portal along the chain must be entered from its entrance
+    // side, and `from` must be exitable in every hop's direction.
+    if (!exit.open || (exit.dirs & ~EXIT_MASK[from_kind]))
       return StepResult::InvalidDirection;
-    const auto [p_exit, out_dir] =
-      get_portal_exit(to, std::get<Portal>(to_tile).portal_id);
 
-    // call move_object on position exiting Portal.
-    const auto res_port = move_object(out_dir, from, p_exit);
+    // call move_object on the final position exiting the chain.
+    const auto res_port = move_object(exit.dir, from, exit.pos);
     if (res_port)
       return res_port;
+
+    // the mover moved last, after anything it pushed out of the
+    // chain.
+    Motion &motion    = motions[motion_count - 1];
+    motion.portal     = true;
+    motion.portal_in  = to;
+    motion.portal_out = exit.pos.move(-exit.dir);
+    return std::nullopt;
   }
   }
+
+  update_position(from, to);
   return std::nullopt;
 }
 
+bool RawState::is_complete() const {
+  return goals.size() > 0 && points_query() == goals.size();
+}
+
 StepResult RawState::step(Direction input) {
   Position<> player_from = find_player();
+  motion_count           = 0;
 
   const auto res =
     move_object(input, player_from, player_from.move(input));
   // return res if there is any invalid move.
   if (res)
     return res.value();
-  else if (goals.size() > 0 && points_query() == goals.size())
+  else if (is_complete())
     return StepResult::LevelComplete;
   else
     return StepResult::Ok;
 }
 
+StepManyResult RawState::step_many(std::span<const Direction> dirs) {
+  // same as calling `step` in a loop, but the player, the kind of
+  // its tile and the boxes on goals are tracked across steps instead
+  // of searched for, and plain walks skip `move_object`.
+  Position<> player    = find_player();
+  usize      from_kind = kind_of(tiles.at(player));
+  usize      points    = points_query();
+
+  const auto done = [&](usize i, StepResult result) {
+    return StepManyResult {
+      .index  = i,
+      .result = result,
+      .hash   = hash(),
+    };
+  };
+
+  for (usize i = 0; i < dirs.size(); ++i) {
+    motion_count = 0;
+
+    const Direction  dir  = dirs[i];
+    const Position<> next = player.move(dir);
+    const auto       iter = tiles.find(next);
+
+    // walking onto an empty open tile, which moves no box.
+    if (iter != tiles.end() && !objects.contains(next)
+        && (EXIT_MASK[from_kind] & static_cast<u8>(dir))) {
+      const usize to_kind = kind_of(iter->second);
+      const usize index =
+        rule_index(true, to_kind, dir_index(dir), NO_OBJECT);
+      if (RULES[index].enter == Enter::Open) {
+        update_position(player, next);
+        player    = next;
+        from_kind = to_kind;
+        if (points == goals.size() && !goals.empty())
+          return done(i, StepResult::LevelComplete);
+        continue;
+      }
+    }
+
+    if (const auto res = move_object(dir, player, next))
+      return done(i, res.value());
+
+    // the player moved last, after the box it pushed, if any.
+    for (usize m = 0; m + 1 < motion_count; ++m) {
+      points -= goals.contains(motions[m].from);
+      points += goals.contains(motions[m].to);
+    }
+    player    = motions[motion_count - 1].to;
+    from_kind = kind_of(tiles.at(player));
+
+    if (points == goals.size() && !goals.empty())
+      return done(i, StepResult::LevelComplete);
+  }
+
+  return done(dirs.size(), StepResult::Ok);
+}
+
+StepManyResult RawState::step_many(std::string_view lurd) {
+  return step_many(parse_lurd(lurd));
+}
+
+u64 RawState::hash() const noexcept {
+  // splitmix64 finalizer, folded over every object
+  const auto mix = [](u64 x) {
+    x += 0x9e3779b97f4a7c15;
+    x  = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x  = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+  };
+
+  u64 h = mix(objects.size());
+  for (const auto &[pos, obj] : objects) {
+    u64 kind = obj.index();
+    if (const auto *db = std::get_if<DirBox>(&obj))
+      kind |= static_cast<u64>(db->dir) << 8;
+    h = mix(h ^ ((u64 {pos.x} << 32) | pos.y));
+    h = mix(h ^ kind);
+  }
+  return h;
+}
+
 } // namespace sbokena::game::state
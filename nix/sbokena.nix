@@ -214,6 +214,7 @@ in
       runHook preInstall
 
       install -Dm755 \
+        build/cli/sbokena \
         build/editor/editor \
         build/game/game \
         -t $out/bin
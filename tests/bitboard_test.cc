@@ -0,0 +1,189 @@
+// bitboard encoding tests.
+
+#include <gtest/gtest.h>
+
+#include "bitboard.hh"
+#include "direction.hh"
+#include "level.hh"
+#include "state.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::game::state::RawState;
+using sbokena::game::state::StepResult;
+
+namespace sbokena::game::bitboard {
+
+TEST(game, bitboard_bits_shift) {
+  // shifts must carry bits across word boundaries
+  Bits bits {130};
+  bits.set(0);
+  bits.set(63);
+  bits.set(129);
+
+  const Bits up = bits.shifted(1);
+  ASSERT_TRUE(up.test(1));
+  ASSERT_TRUE(up.test(64));
+  // shifted past the end
+  ASSERT_EQ(up.count(), 2);
+
+  const Bits down = bits.shifted(-64);
+  ASSERT_TRUE(down.test(65));
+  ASSERT_EQ(down.count(), 1);
+
+  ASSERT_EQ(bits.first(), 0);
+  ASSERT_EQ(Bits {130}.first(), 130);
+}
+
+TEST(game, bitboard_layout) {
+  // ██████
+  // █p☐ g█
+  // █  b █
+  // ██████
+  const RawState st = {
+    .goals = {{.x = 4, .y = 1}},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 4, .y = 1}, {Goal {}}},
+        {{.x = 1, .y = 2}, {Floor {}}},
+        {{.x = 2, .y = 2}, {Floor {}}},
+        {{.x = 3, .y = 2}, {Button {.door_id = 0}}},
+        {{.x = 4, .y = 2}, {DirFloor {.dir = Direction::Up}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 2, .y = 1}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  const Layout layout {st};
+  ASSERT_EQ(layout.stride(), 6);
+  ASSERT_EQ(layout.size(), 24);
+  ASSERT_EQ(layout.floor.count(), 8);
+  ASSERT_EQ(layout.walls.count(), 16);
+  ASSERT_EQ(layout.goals.count(), 1);
+  ASSERT_EQ(layout.buttons.count(), 1);
+
+  const Position<> pos {.x = 3, .y = 2};
+  ASSERT_TRUE(layout.contains(pos));
+  ASSERT_EQ(layout.position(layout.index(pos)), pos);
+  ASSERT_TRUE(layout.buttons.test(layout.index(pos)));
+
+  // the DirFloor may only be traversed upwards
+  const usize df = layout.index({.x = 4, .y = 2});
+  ASSERT_TRUE(layout.dirfloors[dir_index(Direction::Up)].test(df));
+  ASSERT_TRUE(layout.passable[dir_index(Direction::Up)].test(df));
+  ASSERT_FALSE(layout.passable[dir_index(Direction::Left)].test(df));
+}
+
+TEST(game, bitboard_push) {
+  // ██████
+  // █p☐ g█
+  // █    █
+  // ██████
+  RawState st = {
+    .goals = {{.x = 4, .y = 1}},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 4, .y = 1}, {Goal {}}},
+        {{.x = 1, .y = 2}, {Floor {}}},
+        {{.x = 2, .y = 2}, {Floor {}}},
+        {{.x = 3, .y = 2}, {Floor {}}},
+        {{.x = 4, .y = 2}, {Floor {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 2, .y = 1}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  const Layout layout {st};
+  Board        board {layout, st};
+  const usize  box = layout.index({.x = 2, .y = 1});
+
+  // the player stands left of the box
+  Bits reach {layout.size()};
+  reach.set(board.player);
+
+  const Bits right = board.pushes(layout, Direction::Right, reach);
+  ASSERT_TRUE(right.test(box));
+  ASSERT_FALSE(board.pushes(layout, Direction::Left, reach).any());
+  // the box can't be pushed up into a wall, even when reachable
+  reach.set(layout.index({.x = 2, .y = 2}));
+  ASSERT_FALSE(board.pushes(layout, Direction::Up, reach).any());
+
+  // copies compare and hash equal
+  Board copy = board;
+  ASSERT_EQ(copy, board);
+  ASSERT_EQ(copy.hash(), board.hash());
+
+  board.push(layout, box, Direction::Right);
+  ASSERT_NE(copy, board);
+  ASSERT_EQ(board.player, box);
+  ASSERT_FALSE(board.complete(layout));
+
+  // the bitboard push agrees with `RawState::step`
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  ASSERT_EQ(Board(layout, st), board);
+
+  const usize next = layout.index({.x = 3, .y = 1});
+  board.push(layout, next, Direction::Right);
+  ASSERT_EQ(board.goals_filled(layout), 1);
+  ASSERT_TRUE(board.complete(layout));
+}
+
+TEST(game, bitboard_push_dirbox) {
+  // █████
+  // █   █
+  // █p˄ █
+  // █   █
+  // █████
+  const RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 1, .y = 2}, {Floor {}}},
+        {{.x = 2, .y = 2}, {Floor {}}},
+        {{.x = 3, .y = 2}, {Floor {}}},
+        {{.x = 1, .y = 3}, {Floor {}}},
+        {{.x = 2, .y = 3}, {Floor {}}},
+        {{.x = 3, .y = 3}, {Floor {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 2}, {Player {}}},
+        {{.x = 2, .y = 2}, {DirBox {.dir = Direction::Up}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  const Layout layout {st};
+  const Board  board {layout, st};
+
+  // every non-wall cell is reachable
+  const Bits reach = layout.floor;
+
+  // a DirBox only moves in its own direction
+  ASSERT_FALSE(board.pushes(layout, Direction::Right, reach).any());
+  ASSERT_FALSE(board.pushes(layout, Direction::Left, reach).any());
+  ASSERT_FALSE(board.pushes(layout, Direction::Down, reach).any());
+  ASSERT_EQ(board.pushes(layout, Direction::Up, reach).count(), 1);
+}
+
+} // namespace sbokena::game::bitboard
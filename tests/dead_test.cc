@@ -0,0 +1,81 @@
+// dead square tests.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dead.hh"
+#include "direction.hh"
+#include "level.hh"
+#include "position.hh"
+#include "state.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::game::state::RawState;
+using sbokena::game::state::Tiles;
+using sbokena::position::Position;
+
+namespace sbokena::game::dead {
+
+TEST(game, dead_squares_room) {
+  // ██████
+  // █p   █
+  // █ b. █
+  // █    █
+  // ██████
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 4; ++x)
+      tiles.insert({{.x = x, .y = y}, {Floor {}}});
+  tiles.insert_or_assign({.x = 3, .y = 2}, Tile {Goal {}});
+
+  const RawState st = {
+    .goals   = {{.x = 3, .y = 2}},
+    .tiles   = tiles,
+    .objects = {{{.x = 1, .y = 1}, {Player {}}},
+                {{.x = 2, .y = 2}, {Box {}}}},
+    .doors   = {},
+    .portals = {},
+  };
+
+  // the corners, and the walls the goal isn't on.
+  const std::vector<Position<>> expected = {
+    {.x = 1, .y = 1},
+    {.x = 2, .y = 1},
+    {.x = 3, .y = 1},
+    {.x = 4, .y = 1},
+    {.x = 1, .y = 2},
+    {.x = 4, .y = 2},
+    {.x = 1, .y = 3},
+    {.x = 2, .y = 3},
+    {.x = 3, .y = 3},
+    {.x = 4, .y = 3},
+  };
+  ASSERT_EQ(dead_squares(st), expected);
+}
+
+TEST(game, dead_squares_dir_floor) {
+  // █████
+  // █p>.█
+  // █████
+  // the box can't leave the one-way floor to the left.
+  const RawState st = {
+    .goals = {{.x = 1, .y = 1}},
+    .tiles =
+      {{{.x = 1, .y = 1}, {Goal {}}},
+       {{.x = 2, .y = 1}, {DirFloor {.dir = Direction::Right}}},
+       {{.x = 3, .y = 1}, {Floor {}}}},
+    .objects = {{{.x = 1, .y = 1}, {Player {}}}},
+    .doors   = {},
+    .portals = {},
+  };
+
+  const std::vector<Position<>> expected = {
+    {.x = 2, .y = 1},
+    {.x = 3, .y = 1},
+  };
+  ASSERT_EQ(dead_squares(st), expected);
+}
+
+} // namespace sbokena::game::dead
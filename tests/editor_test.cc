@@ -0,0 +1,215 @@
+// editor level model tests.
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "editor_level.hh"
+#include "from_to_json.hh"
+#include "journal.hh"
+#include "object.hh"
+#include "position.hh"
+#include "region.hh"
+#include "tile.hh"
+
+using sbokena::direction::Direction;
+using sbokena::editor::journal::Journal;
+using sbokena::editor::level::Difficulty;
+using sbokena::editor::level::Level;
+using sbokena::editor::region::CellState;
+using sbokena::editor::region::Transform;
+using sbokena::position::Position;
+
+namespace sbokena::editor {
+
+using Cells = std::vector<Position<>>;
+
+// the state of every cell holding a tile, by position. links are
+// sorted, as rebuilt doors may list their buttons in another order.
+std::map<Position<>, CellState> cells_of(const Level &level) {
+  std::map<Position<>, CellState> out;
+  level.for_each_tile([&](const Position<> &pos, u32) {
+    CellState state = level.cell_state(pos);
+    std::sort(state.links.begin(), state.links.end());
+    out.emplace(pos, std::move(state));
+  });
+  return out;
+}
+
+// the links of a cell, sorted.
+Cells links_at(const Level &level, Position<> pos) {
+  return cells_of(level).at(pos).links;
+}
+
+TEST(editor, journal_stroke) {
+  Level   level {"stroke"};
+  Journal journal {level};
+  ASSERT_NE(journal.create_tile(TileType::Floor, {0, 0}), NULL_ID);
+  const u32  untouched = level.get_tile_at({0, 0})->get_id();
+  const auto before    = cells_of(level);
+
+  // everything painted in a stroke is a single entry, even a cell
+  // painted twice.
+  journal.begin_stroke();
+  for (u32 x = 1; x <= 3; ++x)
+    ASSERT_NE(journal.create_tile(TileType::Floor, {x, 0}), NULL_ID);
+  ASSERT_NE(journal.replace_tile_at({1, 0}, TileType::Goal), NULL_ID);
+  ASSERT_NE(journal.add_object(ObjectType::Box, {2, 0}), NULL_ID);
+  ASSERT_TRUE(journal.in_stroke());
+  journal.end_stroke();
+  const auto after = cells_of(level);
+  ASSERT_EQ(after.size(), 4);
+  ASSERT_EQ(after.at({1, 0}).tile, TileType::Goal);
+
+  // undoing only rebuilds the cells of the stroke.
+  ASSERT_TRUE(journal.undo());
+  ASSERT_EQ(cells_of(level), before);
+  ASSERT_EQ(level.get_tile_at({0, 0})->get_id(), untouched);
+  ASSERT_TRUE(journal.can_redo());
+
+  ASSERT_TRUE(journal.redo());
+  ASSERT_EQ(cells_of(level), after);
+  ASSERT_FALSE(journal.can_redo());
+
+  ASSERT_TRUE(journal.undo());
+  ASSERT_TRUE(journal.undo());
+  ASSERT_FALSE(journal.undo());
+  ASSERT_TRUE(cells_of(level).empty());
+  ASSERT_TRUE(journal.redo());
+  ASSERT_TRUE(journal.redo());
+  ASSERT_EQ(cells_of(level), after);
+}
+
+TEST(editor, journal_links) {
+  Level     level {"links"};
+  Journal   journal {level};
+  const u32 portal_a = level.create_tile(TileType::Portal, {0, 0});
+  const u32 portal_b = level.create_tile(TileType::Portal, {2, 0});
+  const u32 door     = level.create_tile(TileType::Door, {0, 1});
+  const u32 button   = level.create_tile(TileType::Button, {1, 1});
+  const auto unlinked = cells_of(level);
+
+  ASSERT_TRUE(journal.link_portals(portal_a, portal_b));
+  ASSERT_TRUE(journal.link_door_button(door, button));
+  const auto linked = cells_of(level);
+  ASSERT_EQ(links_at(level, {0, 0}), (Cells {{2, 0}}));
+  ASSERT_EQ(links_at(level, {0, 1}), (Cells {{1, 1}}));
+
+  // undoing a link unlinks both of its ends.
+  ASSERT_TRUE(journal.undo());
+  ASSERT_TRUE(links_at(level, {0, 1}).empty());
+  ASSERT_TRUE(links_at(level, {1, 1}).empty());
+  ASSERT_EQ(links_at(level, {2, 0}), (Cells {{0, 0}}));
+  ASSERT_EQ(level.counts().unlinked_buttons, 1);
+
+  ASSERT_TRUE(journal.undo());
+  ASSERT_EQ(cells_of(level), unlinked);
+  ASSERT_EQ(level.counts().unpaired_portals, 2);
+
+  ASSERT_TRUE(journal.redo());
+  ASSERT_TRUE(journal.redo());
+  ASSERT_EQ(cells_of(level), linked);
+  ASSERT_EQ(level.counts().unpaired_portals, 0);
+  ASSERT_EQ(level.counts().unlinked_doors, 0);
+}
+
+TEST(editor, region_rotate) {
+  // a row of a door, its button under a box, a portal paired with
+  // one outside the region, and a one direction floor.
+  Level     level {"rotate"};
+  Journal   journal {level};
+  const u32 door   = level.create_tile(TileType::Door, {0, 0});
+  const u32 button = level.create_tile(TileType::Button, {1, 0});
+  const u32 inside = level.create_tile(TileType::Portal, {2, 0});
+  const u32 floor  = level.create_tile(TileType::OneDir, {3, 0});
+  const u32 beyond = level.create_tile(TileType::Portal, {5, 5});
+  tile_cast<Portal>(level.get_tile(inside))
+    ->set_dir_in(Direction::Right);
+  tile_cast<OneDir>(level.get_tile(floor))
+    ->set_dir_in(Direction::Left);
+  ASSERT_TRUE(level.link_door_button(door, button));
+  ASSERT_TRUE(level.link_portals(inside, beyond));
+  const u32 box = level.add_object(ObjectType::OneDirBox, {1, 0});
+  object_cast<OneDirBox>(level.get_object(box))
+    ->set_dir(Direction::Up);
+  const auto before = cells_of(level);
+
+  // a quarter turn clockwise stands the row up.
+  const auto max =
+    journal.transform_region({0, 0}, {3, 0}, Transform::Rotate);
+  ASSERT_EQ(max, (Position<> {0, 3}));
+  const auto after = cells_of(level);
+  ASSERT_EQ(after.size(), 5);
+  for (u32 x = 1; x <= 3; ++x)
+    ASSERT_FALSE(level.has_tile_at({x, 0}));
+
+  ASSERT_EQ(after.at({0, 0}).tile, TileType::Door);
+  ASSERT_EQ(after.at({0, 0}).links, (Cells {{0, 1}}));
+  ASSERT_EQ(after.at({0, 1}).tile, TileType::Button);
+  ASSERT_EQ(after.at({0, 1}).links, (Cells {{0, 0}}));
+  ASSERT_EQ(after.at({0, 1}).object, ObjectType::OneDirBox);
+  ASSERT_EQ(after.at({0, 1}).object_dir, Direction::Right);
+  ASSERT_EQ(after.at({0, 2}).tile, TileType::Portal);
+  ASSERT_EQ(after.at({0, 2}).tile_dir, Direction::Down);
+  ASSERT_EQ(after.at({0, 2}).links, (Cells {{5, 5}}));
+  ASSERT_EQ(after.at({5, 5}).links, (Cells {{0, 2}}));
+  ASSERT_EQ(after.at({0, 3}).tile, TileType::OneDir);
+  ASSERT_EQ(after.at({0, 3}).tile_dir, Direction::Up);
+  ASSERT_EQ(level.counts().unpaired_portals, 0);
+  ASSERT_EQ(level.counts().unlinked_buttons, 0);
+
+  // mirroring turns the directions across the axis only.
+  ASSERT_TRUE(journal.transform_region(
+    {0, 0}, {0, 3}, Transform::MirrorHorizontal
+  ));
+  ASSERT_EQ(cells_of(level).at({0, 1}).object_dir, Direction::Left);
+  ASSERT_EQ(cells_of(level).at({0, 3}).tile_dir, Direction::Up);
+
+  ASSERT_TRUE(journal.undo());
+  ASSERT_EQ(cells_of(level), after);
+  ASSERT_TRUE(journal.undo());
+  ASSERT_EQ(cells_of(level), before);
+}
+
+TEST(editor, raw_round_trip) {
+  Level level {"round trip"};
+  level.get_condition().set_difficulty(Difficulty::Hard);
+  for (u32 x = 0; x <= 2; ++x)
+    level.create_tile(TileType::Floor, {x, 0});
+  level.create_tile(TileType::Goal, {0, 1});
+  level.create_tile(TileType::Goal, {1, 1});
+  const u32 floor = level.create_tile(TileType::OneDir, {2, 1});
+  tile_cast<OneDir>(level.get_tile(floor))
+    ->set_dir_in(Direction::Down);
+  const u32 a = level.create_tile(TileType::Portal, {0, 2});
+  const u32 b = level.create_tile(TileType::Portal, {2, 2});
+  tile_cast<Portal>(level.get_tile(a))->set_dir_in(Direction::Left);
+  ASSERT_TRUE(level.link_portals(a, b));
+  const u32 door = level.create_tile(TileType::Door, {0, 3});
+  for (u32 x = 1; x <= 2; ++x)
+    ASSERT_TRUE(level.link_door_button(
+      door, level.create_tile(TileType::Button, {x, 3})
+    ));
+  level.add_object(ObjectType::Player, {0, 0});
+  level.add_object(ObjectType::Box, {1, 0});
+  const u32 box = level.add_object(ObjectType::OneDirBox, {2, 0});
+  object_cast<OneDirBox>(level.get_object(box))
+    ->set_dir(Direction::Left);
+
+  const auto raw = from_to_json::to_raw(level);
+  ASSERT_EQ(raw.tiles.size(), 11);
+  ASSERT_EQ(raw.objects.size(), 3);
+
+  Level copy {"other"};
+  copy.create_tile(TileType::Floor, {7, 7});
+  from_to_json::from_raw(raw, copy);
+  ASSERT_EQ(copy.get_name(), "round trip");
+  ASSERT_EQ(copy.get_condition().difficulty, Difficulty::Hard);
+  ASSERT_EQ(cells_of(copy), cells_of(level));
+  ASSERT_EQ(copy.problems(), level.problems());
+}
+
+} // namespace sbokena::editor
@@ -0,0 +1,83 @@
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat.hh"
+
+namespace sbokena::flat {
+
+TEST(common, flat_map) {
+  // sorted, keeping the first of equal keys.
+  FlatMap<int, std::string> map {{3, "c"}, {1, "a"}, {3, "x"}};
+  ASSERT_EQ(map.size(), 2);
+  ASSERT_EQ(map.begin()->first, 1);
+  ASSERT_EQ(map.at(3), "c");
+  ASSERT_THROW(map.at(2), std::out_of_range);
+
+  ASSERT_TRUE(map.emplace(2, "b").second);
+  ASSERT_FALSE(map.try_emplace(2, "y").second);
+  ASSERT_FALSE(map.insert_or_assign(2, "z").second);
+  ASSERT_EQ(map.at(2), "z");
+
+  std::vector<int> keys;
+  for (const auto &[key, _] : map)
+    keys.push_back(key);
+  ASSERT_EQ(keys, (std::vector {1, 2, 3}));
+
+  ASSERT_EQ(map.erase(2), 1);
+  ASSERT_EQ(map.erase(2), 0);
+  ASSERT_FALSE(map.contains(2));
+  ASSERT_EQ(map.find(2), map.end());
+}
+
+TEST(common, flat_set) {
+  FlatSet<int> set {5, 1, 5, 3};
+  ASSERT_EQ(set.size(), 3);
+  ASSERT_EQ(*set.begin(), 1);
+  ASSERT_FALSE(set.insert(3).second);
+  ASSERT_TRUE(set.insert(4).second);
+  ASSERT_EQ(set, (FlatSet<int> {1, 3, 4, 5}));
+  ASSERT_EQ(set.erase(1), 1);
+  ASSERT_FALSE(set.contains(1));
+}
+
+TEST(common, flat_sorted_unique) {
+  // taken as they are, from a container which is sorted already.
+  const std::map<int, char> map {{2, 'b'}, {1, 'a'}};
+  const FlatMap<int, char>  frozen {
+    sorted_unique, map.begin(), map.end()
+  };
+  ASSERT_EQ(frozen, (FlatMap<int, char> {{1, 'a'}, {2, 'b'}}));
+
+  const std::set<int> set {3, 1, 2};
+  const FlatSet<int>  keys {sorted_unique, set.begin(), set.end()};
+  ASSERT_EQ(keys, (FlatSet<int> {1, 2, 3}));
+}
+
+TEST(common, flat_memory) {
+  std::pmr::monotonic_buffer_resource arena;
+
+  // nested in a `std::pmr` container, it draws from the same arena.
+  std::pmr::unordered_map<int, std::pair<int, FlatSet<int>>> groups {
+    &arena
+  };
+  groups[7].second.insert(1);
+  ASSERT_EQ(groups[7].second.get_allocator().resource(), &arena);
+
+  // copies use the default resource, unless given one.
+  const FlatSet<int> copy {groups[7].second};
+  ASSERT_EQ(
+    copy.get_allocator().resource(), std::pmr::get_default_resource()
+  );
+  const FlatSet<int> placed {groups[7].second, &arena};
+  ASSERT_EQ(placed.get_allocator().resource(), &arena);
+}
+
+} // namespace sbokena::flat
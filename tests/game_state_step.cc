@@ -1002,6 +1002,100 @@ TEST(game, state_case_1) {
   ASSERT_EQ(st1.step(Direction::Right), StepResult::PushTwoObjects);
 }
 
+TEST(game, state_walk_portal_chain) {
+  // ████████████
+  // █p▸██◂▸██◂ █
+  // ████████████
+  RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+        {{.x = 5, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Left}}},
+        {{.x = 6, .y = 1},
+         {Portal {.portal_id = 1, .in_dir = Direction::Right}}},
+        {{.x = 9, .y = 1},
+         {Portal {.portal_id = 1, .in_dir = Direction::Left}}},
+        {{.x = 10, .y = 1}, {Floor {}}},
+      },
+    .objects = {{{.x = 1, .y = 1}, {Player {}}}},
+    .doors   = {},
+    .portals =
+      {
+        {0, {{.x = 2, .y = 1}, {.x = 5, .y = 1}}},
+        {1, {{.x = 6, .y = 1}, {.x = 9, .y = 1}}},
+      },
+  };
+
+  // both portals are traversed in one step
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  std::get<Player>(st.objects.at({.x = 10, .y = 1}));
+
+  // and back again
+  ASSERT_EQ(st.step(Direction::Left), StepResult::Ok);
+  std::get<Player>(st.objects.at({.x = 1, .y = 1}));
+}
+
+TEST(game, state_motions) {
+  // ████████
+  // █p☐┤├  █
+  // ████████
+  RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1},
+         {Portal {.portal_id = 1, .in_dir = Direction::Right}}},
+        {{.x = 4, .y = 1},
+         {Portal {.portal_id = 1, .in_dir = Direction::Left}}},
+        {{.x = 5, .y = 1}, {Floor {}}},
+        {{.x = 6, .y = 1}, {Floor {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 2, .y = 1}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {{1, {{.x = 3, .y = 1}, {.x = 4, .y = 1}}}},
+  };
+
+  // the box goes through the portal, pushed by the player.
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  ASSERT_EQ(st.motion_count, 2);
+  const Motion box = st.motions[0];
+  ASSERT_EQ(box.from, (Position<> {.x = 2, .y = 1}));
+  ASSERT_EQ(box.to, (Position<> {.x = 5, .y = 1}));
+  ASSERT_TRUE(box.portal);
+  ASSERT_EQ(box.portal_in, (Position<> {.x = 3, .y = 1}));
+  ASSERT_EQ(box.portal_out, (Position<> {.x = 4, .y = 1}));
+  const Motion player = st.motions[1];
+  ASSERT_EQ(player.from, (Position<> {.x = 1, .y = 1}));
+  ASSERT_EQ(player.to, (Position<> {.x = 2, .y = 1}));
+  ASSERT_FALSE(player.portal);
+
+  // then the player follows it, and pushes it again.
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  ASSERT_EQ(st.motion_count, 2);
+  ASSERT_FALSE(st.motions[0].portal);
+  ASSERT_EQ(st.motions[0].to, (Position<> {.x = 6, .y = 1}));
+  ASSERT_TRUE(st.motions[1].portal);
+  ASSERT_EQ(st.motions[1].to, (Position<> {.x = 5, .y = 1}));
+
+  // a step back through the portal only moves the player.
+  ASSERT_EQ(st.step(Direction::Left), StepResult::Ok);
+  ASSERT_EQ(st.motion_count, 1);
+  ASSERT_EQ(st.motions[0].from, (Position<> {.x = 5, .y = 1}));
+  ASSERT_EQ(st.motions[0].to, (Position<> {.x = 2, .y = 1}));
+  ASSERT_EQ(st.motions[0].portal_in, (Position<> {.x = 4, .y = 1}));
+  ASSERT_EQ(st.motions[0].portal_out, (Position<> {.x = 3, .y = 1}));
+}
+
 // TODO: test multiple buttons and one door
 
 } // namespace sbokena::game::state
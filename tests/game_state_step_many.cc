@@ -0,0 +1,168 @@
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "level.hh"
+#include "position.hh"
+#include "state.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::position::Cell;
+
+namespace sbokena::game::state {
+
+TEST(game, state_parse_lurd) {
+  using enum Direction;
+
+  ASSERT_EQ(
+    parse_lurd("3rUl2D"),
+    (std::vector {Right, Right, Right, Up, Left, Down, Down})
+  );
+  ASSERT_EQ(parse_lurd(""), std::vector<Direction> {});
+  ASSERT_EQ(to_lurd(parse_lurd("LU2R")), "lurr");
+
+  ASSERT_THROW(parse_lurd("lx"), std::invalid_argument);
+  ASSERT_THROW(parse_lurd("l3"), std::invalid_argument);
+}
+
+TEST(game, state_step_many) {
+  // ███████
+  // █p☐ g █
+  // ███████
+  const RawState init = {
+    .goals = {{.x = 4, .y = 1}},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 4, .y = 1}, {Goal {}}},
+        {{.x = 5, .y = 1}, {Floor {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 2, .y = 1}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  // stops at the first failing move, which isn't applied
+  RawState   st  = init;
+  const auto res = st.step_many("lRu");
+  ASSERT_EQ(res.index, 0);
+  ASSERT_EQ(res.result, StepResult::HitWall);
+  ASSERT_EQ(res.hash, init.hash());
+
+  // stops when the level is complete, which is applied
+  const auto done = st.step_many("3r");
+  ASSERT_EQ(done.index, 1);
+  ASSERT_EQ(done.result, StepResult::LevelComplete);
+  std::get<Box>(st.objects.at({.x = 4, .y = 1}));
+
+  // agrees with single steps
+  RawState single = init;
+  ASSERT_EQ(single.step(Direction::Right), StepResult::Ok);
+  ASSERT_EQ(single.step(Direction::Right), StepResult::LevelComplete);
+  ASSERT_EQ(done.hash, single.hash());
+  ASSERT_NE(done.hash, init.hash());
+}
+
+namespace {
+// `step` in a loop, stopping as `step_many` does.
+StepManyResult step_each(RawState &st, std::string_view lurd) {
+  const auto dirs = parse_lurd(lurd);
+  usize      i    = 0;
+  StepResult res  = StepResult::Ok;
+  while (i < dirs.size() && res == StepResult::Ok)
+    res = st.step(dirs[i++]);
+  if (res != StepResult::Ok)
+    --i;
+  return {.index = i, .result = res, .hash = st.hash()};
+}
+} // namespace
+
+TEST(game, state_step_many_agrees) {
+  // ██████
+  // █ g  █
+  // █p☐☐g█
+  // █    █
+  // ██████
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 4; ++x)
+      tiles.emplace(Cell {.x = x, .y = y}, Floor {});
+  tiles.insert_or_assign({.x = 2, .y = 1}, Goal {});
+  tiles.insert_or_assign({.x = 4, .y = 2}, Goal {});
+
+  const RawState init = {
+    .goals = {{.x = 2, .y = 1}, {.x = 4, .y = 2}},
+    .tiles = std::move(tiles),
+    .objects =
+      {
+        {{.x = 1, .y = 2}, {Player {}}},
+        {{.x = 2, .y = 2}, {Box {}}},
+        {{.x = 3, .y = 2}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  // walks, pushes, failures and completion, from the start and from
+  // a state which is already complete.
+  RawState   solved = init;
+  const auto solve  = solved.step_many("dRuR");
+  ASSERT_EQ(solve.index, 3);
+  ASSERT_EQ(solve.result, StepResult::LevelComplete);
+  for (const RawState &start : {init, solved})
+    for (const auto lurd :
+         {"", "l", "rr", "dRurrdL", "drrUluL", "uuu", "dldrr"}) {
+      RawState   many   = start;
+      RawState   single = start;
+      const auto a      = many.step_many(lurd);
+      const auto b      = step_each(single, lurd);
+      ASSERT_EQ(a.index, b.index) << lurd;
+      ASSERT_EQ(a.result, b.result) << lurd;
+      ASSERT_EQ(a.hash, b.hash) << lurd;
+    }
+}
+
+TEST(game, state_step_many_portal) {
+  // █████████
+  // █p▸██◂☐g█
+  // █████████
+  RawState st = {
+    .goals = {{.x = 7, .y = 1}},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+        {{.x = 5, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Left}}},
+        {{.x = 6, .y = 1}, {Floor {}}},
+        {{.x = 7, .y = 1}, {Goal {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 6, .y = 1}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {{0, {{.x = 2, .y = 1}, {.x = 5, .y = 1}}}},
+  };
+
+  // pushing through a portal completes the level
+  const auto res = st.step_many("r");
+  ASSERT_EQ(res.index, 0);
+  ASSERT_EQ(res.result, StepResult::LevelComplete);
+  std::get<Player>(st.objects.at({.x = 6, .y = 1}));
+}
+
+} // namespace sbokena::game::state
@@ -1,3 +1,5 @@
+#include <sstream>
+#include <stdexcept>
 #include <string_view>
 
 #include <gtest/gtest.h>
@@ -106,10 +108,10 @@ TEST(common, level_ser) {
       R"("tiles":[)"
         R"([{"x":0,"y":0},)"
         R"({"type":0}],)"
-        R"([{"x":0,"y":1},)"
-        R"({"door_id":0,"type":1}],)"
         R"([{"x":1,"y":0},)"
         R"({"type":5}],)"
+        R"([{"x":0,"y":1},)"
+        R"({"door_id":0,"type":1}],)"
         R"([{"x":1,"y":1},)"
         R"({"door_id":0,"type":2}])"
       "]"
@@ -165,4 +167,121 @@ TEST(common, level_de) {
   ASSERT_EQ(std::get<DirBox>(o11).dir, Direction::Left);
 }
 
+TEST(common, level_stream) {
+  const RawLevel l {
+    .name  = "quote \" and \\ level",
+    .theme = "dev",
+    .diff  = Difficulty::Hard,
+    .tiles =
+      {
+        {{.x = 0, .y = 0}, {Floor {}}},
+        {{.x = 1, .y = 0}, {Goal {}}},
+        {{.x = 0, .y = 1}, {Button {.door_id = 7}}},
+        {{.x = 1, .y = 1}, {Door {.door_id = 7}}},
+        {{.x = 2, .y = 0}, {DirFloor {.dir = Direction::Left}}},
+        {{.x = 2, .y = 1},
+         {Portal {.portal_id = 3, .in_dir = Direction::Up}}},
+        {{.x = 2, .y = 2},
+         {Portal {.portal_id = 3, .in_dir = Direction::Right}}},
+      },
+    .objects = {
+      {{.x = 0, .y = 0}, {Player {}}},
+      {{.x = 0, .y = 1}, {Box {}}},
+      {{.x = 2, .y = 0}, {DirBox {.dir = Direction::Down}}},
+    },
+  };
+
+  std::stringstream ss;
+  write_json(ss, l);
+  const std::string text = ss.str();
+
+  // the streamed text is the same level as the `json` one.
+  ASSERT_EQ(json::parse(text), json(l));
+  // and reads back the same.
+  ASSERT_EQ(json(read_json(ss)), json(l));
+
+  // reading accepts what `to_json` writes.
+  std::stringstream dumped {json(l).dump(2)};
+  ASSERT_EQ(json(read_json(dumped)), json(l));
+}
+
+TEST(common, level_cbor) {
+  const RawLevel l {
+    .name  = "binary level",
+    .theme = "dev",
+    .diff  = Difficulty::Medium,
+    .tiles =
+      {
+        {{.x = 0, .y = 0}, {Floor {}}},
+        {{.x = 1, .y = 0}, {Goal {}}},
+        {{.x = 0, .y = 1}, {Button {.door_id = 7}}},
+        {{.x = 1, .y = 1}, {Door {.door_id = 7}}},
+        {{.x = 2, .y = 1},
+         {Portal {.portal_id = 3, .in_dir = Direction::Up}}},
+        {{.x = 3, .y = 1}, {DirFloor {.dir = Direction::Right}}},
+        // values past a byte, and past two.
+        {{.x = 300, .y = 40000}, {Button {.door_id = 100000}}},
+      },
+    .objects = {
+      {{.x = 0, .y = 0}, {Player {}}},
+      {{.x = 1, .y = 1}, {DirBox {.dir = Direction::Down}}},
+      {{.x = 3, .y = 1}, {Box {}}},
+    },
+  };
+
+  // the streamed bytes are the same level as the `json` one.
+  std::stringstream ss;
+  write_cbor(ss, l);
+  ASSERT_EQ(json::from_cbor(ss.str()), json(l));
+  ASSERT_EQ(json(read_cbor(ss)), json(l));
+
+  // a truncated level doesn't read.
+  const std::string bytes = ss.str();
+  std::stringstream cut {bytes.substr(0, bytes.size() / 2)};
+  ASSERT_THROW(read_cbor(cut), std::runtime_error);
+}
+
+TEST(common, level_stream_invalid) {
+  const auto read = [](std::string_view text) {
+    std::stringstream ss {std::string {text}};
+    return read_json(ss);
+  };
+
+  // well-formed.
+  read(R"({"name":"","theme":"","diff":"Easy","tiles":[],)"
+       R"("objects":[],"unknown":[{"x":[]}]})");
+
+  // missing level fields.
+  ASSERT_THROW(
+    read(R"({"name":"","theme":"","tiles":[],"objects":[]})"),
+    std::runtime_error
+  );
+  // missing tile fields.
+  ASSERT_THROW(
+    read(R"({"name":"","theme":"","diff":"Easy","objects":[],)"
+         R"("tiles":[[{"x":0,"y":0},{"type":3,"portal_id":1}]]})"),
+    std::runtime_error
+  );
+  // unknown object type.
+  ASSERT_THROW(
+    read(R"({"name":"","theme":"","diff":"Easy","tiles":[],)"
+         R"("objects":[[{"x":0,"y":0},{"type":9}]]})"),
+    std::runtime_error
+  );
+  // wrongly typed value.
+  ASSERT_THROW(
+    read(R"({"name":"","theme":"","diff":"Easy","tiles":[],)"
+         R"("objects":[[{"x":-1,"y":0},{"type":0}]]})"),
+    std::runtime_error
+  );
+  // position past the range of a cell.
+  ASSERT_THROW(
+    read(R"({"name":"","theme":"","diff":"Easy","tiles":[],)"
+         R"("objects":[[{"x":65535,"y":0},{"type":0}]]})"),
+    std::runtime_error
+  );
+  // malformed json.
+  ASSERT_THROW(read(R"({"name":)"), std::runtime_error);
+}
+
 } // namespace sbokena::level
@@ -1,6 +1,11 @@
 // theme and level loader tests.
 
+#include <algorithm>
 #include <filesystem>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <variant>
 
 #include <gtest/gtest.h>
 #include <raylib.h>
@@ -254,4 +259,171 @@ TEST(common, level_load_dangling_portal_id) {
   FAIL();
 }
 
+TEST(common, level_load_portal_cycle) {
+  // each portal's exit lands on the other pair's entrance
+  const RawLevel raw_level = {
+    .name  = "test level",
+    .theme = "dev",
+    .diff  = level::Difficulty::Unknown,
+    .tiles =
+      {
+        {{.x = 0, .y = 1},
+         {Portal {
+           .portal_id = 1,
+           .in_dir    = Direction::Left,
+         }}},
+        {{.x = 1, .y = 1},
+         {Portal {
+           .portal_id = 0,
+           .in_dir    = Direction::Right,
+         }}},
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 4, .y = 1},
+         {Portal {
+           .portal_id = 1,
+           .in_dir    = Direction::Left,
+         }}},
+        {{.x = 5, .y = 1},
+         {Portal {
+           .portal_id = 0,
+           .in_dir    = Direction::Right,
+         }}},
+      },
+    .objects = {
+      {{.x = 2, .y = 1}, {Player {}}},
+    },
+  };
+
+  const Theme<Image> theme {raw_level.theme};
+  ASSERT_THROW(
+    (Level<Image> {raw_level, theme}), InvalidLevelException
+  );
+}
+
+TEST(common, level_data_arena) {
+  std::optional<LevelData> level;
+  {
+    // the raw level goes with its scratch arena.
+    std::pmr::monotonic_buffer_resource scratch;
+
+    RawLevel raw {
+      .name    = "arena level",
+      .theme   = "dev",
+      .diff    = Difficulty::Easy,
+      .tiles   = RawLevel::Tiles(&scratch),
+      .objects = RawLevel::Objects(&scratch),
+    };
+    raw.tiles.emplace(Position<> {.x = 1, .y = 1}, Floor {});
+    raw.tiles.emplace(Position<> {.x = 2, .y = 1}, Goal {});
+    raw.objects.emplace(Position<> {.x = 1, .y = 1}, Player {});
+    raw.objects.emplace(Position<> {.x = 2, .y = 1}, Box {});
+    level.emplace(raw);
+  }
+
+  const auto *memory = level->tiles().get_allocator().resource();
+  ASSERT_NE(memory, std::pmr::get_default_resource());
+  ASSERT_EQ(level->goals().get_allocator().resource(), memory);
+
+  // a copy has an arena of its own, and outlives the original.
+  const LevelData copy = [&] {
+    const LevelData inner {*level};
+    level.reset();
+    return inner;
+  }();
+  ASSERT_EQ(copy.player(), (Position<> {.x = 1, .y = 1}));
+  ASSERT_EQ(copy.goals().size(), 1);
+  ASSERT_TRUE(copy.tiles().contains({.x = 2, .y = 1}));
+}
+
+TEST(common, level_data_freeze) {
+  const LevelData level {RawLevel {
+    .name    = "frozen level",
+    .theme   = "dev",
+    .diff    = Difficulty::Easy,
+    .tiles   = {
+      {{.x = 2, .y = 1}, {Goal {}}},
+      {{.x = 1, .y = 2}, {Floor {}}},
+      {{.x = 1, .y = 1}, {Floor {}}},
+      {{.x = 3, .y = 2}, {Button {.door_id = 0}}},
+      {{.x = 2, .y = 2}, {Button {.door_id = 0}}},
+      {{.x = 3, .y = 1}, {Door {.door_id = 0}}},
+    },
+    .objects = {
+      {{.x = 1, .y = 1}, {Player {}}},
+      {{.x = 1, .y = 2}, {Box {}}},
+    },
+  }};
+
+  // the same cells, in the same row-major order.
+  std::pmr::monotonic_buffer_resource arena;
+  const auto tiles = level.freeze_tiles(&arena);
+  ASSERT_EQ(tiles.get_allocator().resource(), &arena);
+  const auto same = [](const auto &a, const auto &b) {
+    return a.first == b.first && a.second.index() == b.second.index();
+  };
+  ASSERT_TRUE(std::equal(
+    tiles.begin(),
+    tiles.end(),
+    level.tiles().begin(),
+    level.tiles().end(),
+    same
+  ));
+  ASSERT_EQ(tiles.begin()->first, (Cell {.x = 1, .y = 1}));
+  std::get<Goal>(tiles.at({.x = 2, .y = 1}));
+
+  const auto goals = level.freeze_goals();
+  ASSERT_EQ(goals.size(), 1);
+  ASSERT_TRUE(goals.contains({.x = 2, .y = 1}));
+
+  const auto doors = level.freeze_doors(&arena);
+  ASSERT_EQ(doors.size(), 1);
+  const auto &[door, buttons] = doors.at(0);
+  ASSERT_EQ(door, (Position<> {.x = 3, .y = 1}));
+  ASSERT_EQ(buttons.get_allocator().resource(), &arena);
+  ASSERT_EQ(buttons.size(), 2);
+  ASSERT_EQ(*buttons.begin(), (Cell {.x = 2, .y = 2}));
+  ASSERT_TRUE(buttons.contains({.x = 3, .y = 2}));
+}
+
+TEST(common, level_data_assign) {
+  const RawLevel raw {
+    .name    = "assigned level",
+    .theme   = "dev",
+    .diff    = Difficulty::Easy,
+    .tiles   = {
+      {{.x = 1, .y = 1}, {Floor {}}},
+      {{.x = 2, .y = 1}, {Goal {}}},
+    },
+    .objects = {
+      {{.x = 1, .y = 1}, {Player {}}},
+      {{.x = 2, .y = 1}, {Box {}}},
+    },
+  };
+  LevelData level {raw};
+  LevelData other {raw};
+
+  // a copy gets an arena of its own, in place of the old one.
+  level = other;
+  ASSERT_NE(
+    level.tiles().get_allocator().resource(),
+    other.tiles().get_allocator().resource()
+  );
+  ASSERT_TRUE(level.tiles().contains({.x = 2, .y = 1}));
+
+  // a move takes the arena along with the containers.
+  const auto *moved = other.tiles().get_allocator().resource();
+  level             = std::move(other);
+  ASSERT_EQ(level.tiles().get_allocator().resource(), moved);
+  ASSERT_EQ(level.goals().get_allocator().resource(), moved);
+  ASSERT_EQ(level.player(), (Position<> {.x = 1, .y = 1}));
+
+  // a moved-from level can be assigned to again.
+  other = level;
+  ASSERT_EQ(other.goals().size(), 1);
+  ASSERT_NE(
+    other.goals().get_allocator().resource(),
+    level.goals().get_allocator().resource()
+  );
+}
+
 } // namespace sbokena::loader
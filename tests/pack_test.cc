@@ -0,0 +1,103 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "direction.hh"
+#include "level.hh"
+#include "pack.hh"
+
+using nlohmann::json;
+
+using sbokena::direction::Direction;
+
+namespace sbokena::pack {
+
+using namespace sbokena::level;
+
+namespace {
+std::vector<RawLevel> levels() {
+  return {
+    {
+      .name    = "first",
+      .theme   = "dev",
+      .diff    = Difficulty::Easy,
+      .tiles   = {
+        {{.x = 2, .y = 1}, {Floor {}}},
+        {{.x = 3, .y = 1}, {Goal {}}},
+        {{.x = 4, .y = 3},
+         {Portal {.portal_id = 1, .in_dir = Direction::Up}}},
+      },
+      .objects = {{{.x = 2, .y = 1}, {Player {}}}},
+    },
+    {
+      .name    = "",
+      .theme   = "dev",
+      .diff    = Difficulty::Unknown,
+      .tiles   = {},
+      .objects = {},
+    },
+    {
+      .name    = "third",
+      .theme   = "other",
+      .diff    = Difficulty::Hard,
+      .tiles   = {{{.x = 0, .y = 0}, {Door {.door_id = 4}}}},
+      .objects = {{{.x = 0, .y = 0}, {Box {}}}},
+    },
+  };
+}
+} // namespace
+
+TEST(common, pack_round_trip) {
+  const std::vector<RawLevel> ls = levels();
+  for (const Format format : {Format::Json, Format::Cbor}) {
+    std::stringstream ss;
+    write_pack(ss, ls, format);
+
+    const std::vector<Entry> index = read_index(ss);
+    ASSERT_EQ(index.size(), ls.size());
+    ASSERT_EQ(index[0].name, "first");
+    ASSERT_EQ(index[0].diff, Difficulty::Easy);
+    ASSERT_EQ(index[0].width, 3);
+    ASSERT_EQ(index[0].height, 3);
+    ASSERT_EQ(index[1].width, 0);
+    ASSERT_EQ(index[2].diff, Difficulty::Hard);
+    ASSERT_EQ(index[2].width, 1);
+
+    // levels read out of order, straight from their offsets.
+    for (const usize i : {2, 0, 1}) {
+      ASSERT_EQ(index[i].format, format);
+      ASSERT_EQ(json(read_entry(ss, index[i])), json(ls[i]));
+    }
+  }
+}
+
+TEST(common, pack_invalid) {
+  std::stringstream ss;
+  write_pack(ss, levels(), Format::Cbor);
+  const std::string bytes = ss.str();
+
+  const auto index = [](std::string bytes) {
+    std::stringstream ss {bytes};
+    return read_index(ss);
+  };
+  index(bytes);
+
+  // not a pack.
+  ASSERT_THROW(index("{}"), std::runtime_error);
+  // a truncated index.
+  ASSERT_THROW(index(bytes.substr(0, 40)), std::runtime_error);
+  // a truncated level, which lies past the end.
+  ASSERT_THROW(
+    index(bytes.substr(0, bytes.size() - 1)), std::runtime_error
+  );
+  // an unknown version.
+  std::string version = bytes;
+  version[8]          = 2;
+  ASSERT_THROW(index(version), std::runtime_error);
+}
+
+} // namespace sbokena::pack
@@ -0,0 +1,94 @@
+// editor playtest tests.
+
+#include <map>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "editor_level.hh"
+#include "loader.hh"
+#include "object.hh"
+#include "playtest.hh"
+#include "position.hh"
+#include "tile.hh"
+
+using sbokena::direction::Direction;
+using sbokena::editor::level::Level;
+using sbokena::editor::playtest::Outcome;
+using sbokena::editor::playtest::Playtest;
+using sbokena::editor::playtest::Sprite;
+using sbokena::loader::InvalidLevelException;
+using sbokena::position::CELL_LIMIT;
+using sbokena::position::Position;
+
+namespace sbokena::editor::playtest {
+
+// the sprite of every object, by position.
+std::map<Position<>, Sprite> objects_of(const Playtest &playtest) {
+  std::map<Position<>, Sprite> out;
+  playtest.for_each_object_in(
+    {0, 0}, {9, 9}, [&](Position<> pos, Sprite sprite) {
+      out.emplace(pos, sprite);
+    }
+  );
+  return out;
+}
+
+TEST(editor, playtest) {
+  // ██████
+  // █p☐_.█
+  // █▯████
+  Level level {"playtest"};
+  level.create_tile(TileType::Floor, {0, 0});
+  level.create_tile(TileType::Floor, {1, 0});
+  const u32 button = level.create_tile(TileType::Button, {2, 0});
+  level.create_tile(TileType::Goal, {3, 0});
+  const u32 door = level.create_tile(TileType::Door, {0, 1});
+  ASSERT_TRUE(level.link_door_button(door, button));
+  level.add_object(ObjectType::Player, {0, 0});
+  level.add_object(ObjectType::Box, {1, 0});
+
+  using Theme = sbokena::loader::Theme<Texture>;
+  Playtest playtest {level};
+  const auto start = objects_of(playtest);
+  ASSERT_EQ(start.at({0, 0}), Theme::PLAYER_N);
+  ASSERT_EQ(start.at({1, 0}), Theme::BOX);
+  ASSERT_EQ(playtest.tile_sprite_at({0, 1}), Theme::DOOR_CLOSED);
+  ASSERT_FALSE(playtest.tile_sprite_at({0, 0}));
+
+  // the door opens while the box is on its button.
+  ASSERT_EQ(playtest.step(Direction::Left), Outcome::Blocked);
+  ASSERT_EQ(playtest.step(Direction::Right), Outcome::Moved);
+  ASSERT_EQ(playtest.tile_sprite_at({0, 1}), Theme::DOOR_OPEN);
+  ASSERT_EQ(objects_of(playtest).at({1, 0}), Theme::PLAYER_E);
+
+  // and while the player is, too.
+  ASSERT_EQ(playtest.step(Direction::Right), Outcome::Completed);
+  ASSERT_EQ(playtest.tile_sprite_at({0, 1}), Theme::DOOR_OPEN);
+  ASSERT_TRUE(playtest.completed());
+  ASSERT_EQ(playtest.moves(), 2);
+  ASSERT_EQ(playtest.step(Direction::Left), Outcome::Blocked);
+
+  playtest.restart();
+  ASSERT_FALSE(playtest.completed());
+  ASSERT_EQ(playtest.moves(), 0);
+  ASSERT_EQ(objects_of(playtest), start);
+  ASSERT_EQ(playtest.tile_sprite_at({0, 1}), Theme::DOOR_CLOSED);
+  ASSERT_EQ(playtest.revision(), level.get_revision());
+}
+
+TEST(editor, playtest_invalid) {
+  Level level {"invalid"};
+  level.create_tile(TileType::Floor, {0, 0});
+  level.create_tile(TileType::Goal, {1, 0});
+  level.add_object(ObjectType::Player, {0, 0});
+  ASSERT_THROW(Playtest {level}, std::runtime_error);
+
+  // past the cells a game level can hold.
+  level.create_tile(TileType::Floor, {CELL_LIMIT, 0});
+  level.add_object(ObjectType::Box, {CELL_LIMIT, 0});
+  ASSERT_THROW(Playtest {level}, InvalidLevelException);
+}
+
+} // namespace sbokena::editor::playtest
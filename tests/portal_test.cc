@@ -0,0 +1,75 @@
+// portal exit table tests.
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "level.hh"
+#include "loader.hh"
+#include "portal.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::loader::InvalidLevelException;
+
+namespace sbokena::portal {
+
+TEST(common, portal_chain) {
+  // ████████████
+  // █ ▸██◂▸██◂ █
+  // ████████████
+  Tiles tiles = {
+    {{.x = 1, .y = 1}, {Floor {}}},
+    {{.x = 2, .y = 1},
+     {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+    {{.x = 5, .y = 1},
+     {Portal {.portal_id = 0, .in_dir = Direction::Left}}},
+    {{.x = 6, .y = 1},
+     {Portal {.portal_id = 1, .in_dir = Direction::Right}}},
+    {{.x = 9, .y = 1},
+     {Portal {.portal_id = 1, .in_dir = Direction::Left}}},
+    {{.x = 10, .y = 1}, {Floor {}}},
+  };
+  const Portals portals = {
+    {0, {{.x = 2, .y = 1}, {.x = 5, .y = 1}}},
+    {1, {{.x = 6, .y = 1}, {.x = 9, .y = 1}}},
+  };
+
+  // both hops resolve to the last exit
+  const Exits exits = compile(tiles, portals);
+  ASSERT_EQ(exits.size(), 4);
+  const Exit &exit = exits.at({.x = 2, .y = 1});
+  ASSERT_TRUE(exit.open);
+  ASSERT_EQ(exit.pos, (Position<> {.x = 10, .y = 1}));
+  ASSERT_EQ(exit.dir, Direction::Right);
+  ASSERT_EQ(exit.dirs, static_cast<u8>(Direction::Right));
+
+  // the 2nd portal can't be entered from the 1st one
+  tiles.at({.x = 6, .y = 1}) =
+    Portal {.portal_id = 1, .in_dir = Direction::Up};
+  ASSERT_FALSE(compile(tiles, portals).at({.x = 2, .y = 1}).open);
+}
+
+TEST(common, portal_cycle) {
+  // ███████
+  // ◂▸ █◂▸█
+  // ███████
+  const Tiles tiles = {
+    {{.x = 0, .y = 1},
+     {Portal {.portal_id = 1, .in_dir = Direction::Left}}},
+    {{.x = 1, .y = 1},
+     {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+    {{.x = 2, .y = 1}, {Floor {}}},
+    {{.x = 4, .y = 1},
+     {Portal {.portal_id = 1, .in_dir = Direction::Left}}},
+    {{.x = 5, .y = 1},
+     {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+  };
+  const Portals portals = {
+    {0, {{.x = 1, .y = 1}, {.x = 5, .y = 1}}},
+    {1, {{.x = 0, .y = 1}, {.x = 4, .y = 1}}},
+  };
+
+  ASSERT_THROW(compile(tiles, portals), InvalidLevelException);
+}
+
+} // namespace sbokena::portal
@@ -0,0 +1,56 @@
+#include <set>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "position.hh"
+
+using sbokena::direction::Direction;
+
+namespace sbokena::position {
+
+TEST(common, position_row_major) {
+  const std::set<Cell> cells {
+    {.x = 2, .y = 1},
+    {.x = 0, .y = 2},
+    {.x = 1, .y = 1},
+  };
+
+  // the cells of a row come before the next row.
+  auto iter = cells.begin();
+  ASSERT_EQ(*iter++, (Cell {.x = 1, .y = 1}));
+  ASSERT_EQ(*iter++, (Cell {.x = 2, .y = 1}));
+  ASSERT_EQ(*iter++, (Cell {.x = 0, .y = 2}));
+}
+
+TEST(common, position_cell) {
+  static_assert(sizeof(Cell) == 4);
+
+  const Position<> pos  = {.x = 7, .y = 300};
+  const Cell       cell = pos;
+  ASSERT_EQ(cell, (Cell {.x = 7, .y = 300}));
+  ASSERT_EQ(static_cast<Position<>>(cell), pos);
+
+  // out of range saturates, both ways.
+  ASSERT_EQ(static_cast<Cell>(POS_MAX<>), POS_MAX<u16>);
+  ASSERT_EQ(static_cast<Position<>>(POS_MAX<u16>), POS_MAX<>);
+  const Cell far = Position<> {.x = 0x10001, .y = 1};
+  ASSERT_EQ(far.x, CELL_LIMIT);
+
+  // stepping off the grid's edge lands out of range too.
+  const Position<> edge = Cell {.x = 0, .y = 0}.move(Direction::Up);
+  ASSERT_EQ(edge.y, POS_MAX<>.y);
+}
+
+TEST(common, position_hash) {
+  std::unordered_set<Cell> cells;
+  for (u16 y = 0; y < 64; ++y)
+    for (u16 x = 0; x < 64; ++x)
+      cells.insert({.x = x, .y = y});
+  ASSERT_EQ(cells.size(), 64 * 64);
+  ASSERT_TRUE(cells.contains({.x = 63, .y = 0}));
+  ASSERT_FALSE(cells.contains({.x = 64, .y = 0}));
+}
+
+} // namespace sbokena::position
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "profile.hh"
+
+using namespace std::chrono_literals;
+
+using nlohmann::json;
+
+namespace sbokena::profile {
+
+TEST(common, profile_percentile) {
+  ASSERT_EQ(percentile({}, 0.5f), 0);
+
+  std::vector<f32> samples;
+  for (usize i = 100; i > 0; --i)
+    samples.push_back(i);
+  ASSERT_EQ(percentile(samples, 0.50f), 50);
+  ASSERT_EQ(percentile(samples, 0.99f), 99);
+  ASSERT_EQ(percentile(samples, 1.00f), 100);
+  ASSERT_EQ(percentile(samples, 0.00f), 1);
+}
+
+TEST(common, profile_summary) {
+  // the first frame only ends at the second call.
+  end_frame();
+  const usize before = summary().frames.size();
+
+  const auto start = Clock::now();
+  end_frame();
+  record("profile_test", start, start + 2ms);
+  end_frame();
+
+  const Summary sum = summary();
+  ASSERT_EQ(sum.frames.size(), std::min(before + 2, FRAMES));
+  ASSERT_LE(sum.p50, sum.p95);
+  ASSERT_LE(sum.p99, sum.max);
+
+  // averaged over frames, starting from nothing.
+  bool found = false;
+  for (const Phase &phase : sum.phases)
+    if (phase.name == "profile_test") {
+      found = true;
+      ASSERT_GT(phase.ms, 0);
+      ASSERT_LT(phase.ms, 2);
+    }
+  ASSERT_TRUE(found);
+}
+
+TEST(common, profile_trace) {
+  const auto  epoch = Clock::now();
+  const Event events[] = {
+    {"draw", 0, epoch + 1ms, 500us},
+    {"say \"hi\"", 1, epoch + 2ms, 1ms},
+  };
+
+  std::stringstream ss;
+  write_trace(ss, events, epoch);
+  const json trace = json::parse(ss.str());
+
+  const json &list = trace.at("traceEvents");
+  ASSERT_EQ(list.size(), 2);
+  ASSERT_EQ(list[0].at("name"), "draw");
+  ASSERT_EQ(list[0].at("ph"), "X");
+  ASSERT_EQ(list[0].at("ts"), 1000.0);
+  ASSERT_EQ(list[0].at("dur"), 500.0);
+  ASSERT_EQ(list[1].at("name"), "say \"hi\"");
+  ASSERT_EQ(list[1].at("tid"), 1);
+
+  // an empty trace is still valid.
+  std::stringstream empty;
+  write_trace(empty, {}, epoch);
+  ASSERT_TRUE(json::parse(empty.str()).at("traceEvents").empty());
+}
+
+} // namespace sbokena::profile
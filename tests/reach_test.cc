@@ -0,0 +1,397 @@
+// player reachability tests.
+
+#include <initializer_list>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bitboard.hh"
+#include "direction.hh"
+#include "level.hh"
+#include "reach.hh"
+#include "state.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::game::bitboard::DIRECTIONS;
+using sbokena::game::state::RawState;
+using sbokena::game::state::StepResult;
+using sbokena::game::state::Tiles;
+
+namespace sbokena::game::reach {
+
+// positions of every object but the player.
+std::set<Position<>> boxes_of(const RawState &st) {
+  std::set<Position<>> out;
+  for (const auto &[pos, obj] : st.objects)
+    if (!std::holds_alternative<Player>(obj))
+      out.insert(pos);
+  return out;
+}
+
+// the reachable region, found by stepping copies of the state and
+// discarding every step which moves a box.
+std::set<Position<>> walk(const RawState &st) {
+  const auto           boxes = boxes_of(st);
+  std::set<Position<>> seen {st.find_player()};
+  std::vector          todo {st.find_player()};
+
+  while (!todo.empty()) {
+    const Position<> pos = todo.back();
+    todo.pop_back();
+    for (const Direction dir : DIRECTIONS) {
+      RawState         next   = st;
+      const Position<> player = next.find_player();
+      next.objects.erase(player);
+      next.objects.emplace(pos, Player {});
+
+      const auto res = next.step(dir);
+      if (res != StepResult::Ok && res != StepResult::LevelComplete)
+        continue;
+      if (boxes_of(next) != boxes)
+        continue;
+      if (seen.insert(next.find_player()).second)
+        todo.push_back(next.find_player());
+    }
+  }
+  return seen;
+}
+
+// check a region against `walk`.
+void expect_region(const RawState &st, const Reachability &reach) {
+  const auto seen = walk(st);
+  ASSERT_EQ(reach.count(), seen.size());
+  for (const auto &[pos, _] : st.tiles)
+    ASSERT_EQ(reach.reachable(pos), seen.contains(pos));
+  ASSERT_TRUE(seen.contains(reach.normalized()));
+}
+
+TEST(game, reach_dirfloor) {
+  // ██████
+  // █p>  █
+  // ██████
+  RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {DirFloor {.dir = Direction::Right}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 4, .y = 1}, {Floor {}}},
+      },
+    .objects = {{{.x = 1, .y = 1}, {Player {}}}},
+    .doors   = {},
+    .portals = {},
+  };
+
+  Reachability reach {st};
+  ASSERT_EQ(reach.count(), 4);
+  expect_region(st, reach);
+
+  // the DirFloor can't be crossed the other way
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  ASSERT_EQ(st.step(Direction::Right), StepResult::Ok);
+  reach.flood(st);
+  ASSERT_EQ(reach.count(), 2);
+  ASSERT_FALSE(reach.reachable({.x = 1, .y = 1}));
+  ASSERT_EQ(reach.normalized(), (Position<> {.x = 3, .y = 1}));
+  expect_region(st, reach);
+}
+
+TEST(game, reach_portal) {
+  // ████████
+  // █p▸██◂ █
+  // ████████
+  const RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Right}}},
+        {{.x = 5, .y = 1},
+         {Portal {.portal_id = 0, .in_dir = Direction::Left}}},
+        {{.x = 6, .y = 1}, {Floor {}}},
+      },
+    .objects = {{{.x = 1, .y = 1}, {Player {}}}},
+    .doors   = {},
+    .portals = {{0, {{.x = 2, .y = 1}, {.x = 5, .y = 1}}}},
+  };
+
+  const Reachability reach {st};
+  ASSERT_EQ(reach.count(), 2);
+  ASSERT_TRUE(reach.reachable({.x = 6, .y = 1}));
+  // portals are passed through, never stood on
+  ASSERT_FALSE(reach.reachable({.x = 2, .y = 1}));
+  expect_region(st, reach);
+}
+
+TEST(game, reach_door) {
+  // █████
+  // █pD █
+  // █b ☐█
+  // █████
+  RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Door {.door_id = 3}}},
+        {{.x = 3, .y = 1}, {Floor {}}},
+        {{.x = 1, .y = 2}, {Button {.door_id = 3}}},
+        {{.x = 3, .y = 2}, {Floor {}}},
+      },
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 3, .y = 2}, {Box {}}},
+      },
+    .doors   = {{3, {{.x = 2, .y = 1}, {{.x = 1, .y = 2}}}}},
+    .portals = {},
+  };
+
+  // the door is closed
+  Reachability reach {st};
+  ASSERT_EQ(reach.count(), 2);
+  expect_region(st, reach);
+
+  // a box on the button opens it
+  st.objects.erase({.x = 3, .y = 2});
+  st.objects.emplace(Position<> {.x = 1, .y = 2}, Box {});
+  reach.flood(st);
+  ASSERT_EQ(reach.count(), 4);
+  expect_region(st, reach);
+}
+
+TEST(game, reach_door_button) {
+  // ██████
+  // █pbD █
+  // ██████
+  const RawState st = {
+    .goals = {},
+    .tiles =
+      {
+        {{.x = 1, .y = 1}, {Floor {}}},
+        {{.x = 2, .y = 1}, {Button {.door_id = 0}}},
+        {{.x = 3, .y = 1}, {Door {.door_id = 0}}},
+        {{.x = 4, .y = 1}, {Floor {}}},
+      },
+    .objects = {{{.x = 1, .y = 1}, {Player {}}}},
+    .doors   = {{0, {{.x = 3, .y = 1}, {{.x = 2, .y = 1}}}}},
+    .portals = {},
+  };
+
+  // the player holds the door open while stepping off the button
+  const Reachability reach {st};
+  ASSERT_EQ(reach.count(), 4);
+  expect_region(st, reach);
+}
+
+TEST(game, reach_path) {
+  // ██████
+  // █p █ █
+  // █  ☐ █
+  // █    █
+  // ██████
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 4; ++x)
+      if (x != 3 || y != 1)
+        tiles.insert({{x, y}, {Floor {}}});
+
+  RawState st = {
+    .goals = {},
+    .tiles = tiles,
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 3, .y = 2}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  Reachability reach {st};
+  ASSERT_FALSE(reach.path(st.find_player(), {.x = 3, .y = 1}));
+  ASSERT_FALSE(reach.path(st.find_player(), {.x = 3, .y = 2}));
+
+  // around the box
+  const auto path = reach.path(st.find_player(), {.x = 4, .y = 1});
+  ASSERT_TRUE(path);
+  ASSERT_EQ(path->size(), 7);
+  for (const Direction dir : *path) {
+    const Position<> from = st.find_player();
+    ASSERT_EQ(st.step(dir), StepResult::Ok);
+    reach.update(st, from);
+  }
+  ASSERT_EQ(st.find_player(), (Position<> {.x = 4, .y = 1}));
+  ASSERT_EQ(reach.count(), 10);
+
+  // push the box left, which opens a shorter way back
+  for (const Direction dir : {Direction::Down, Direction::Left}) {
+    const Position<> from = st.find_player();
+    ASSERT_EQ(st.step(dir), StepResult::Ok);
+    reach.update(st, from);
+  }
+  ASSERT_EQ(reach.region(), Reachability {st}.region());
+  const auto back = reach.path(st.find_player(), {.x = 4, .y = 1});
+  ASSERT_TRUE(back);
+  ASSERT_EQ(back->size(), 2);
+}
+
+TEST(game, reach_path_cached) {
+  // ███████
+  // █p    █
+  // █  ☐  █
+  // █     █
+  // ███████
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 5; ++x)
+      tiles.insert({{x, y}, {Floor {}}});
+
+  RawState st = {
+    .goals = {},
+    .tiles = tiles,
+    .objects =
+      {
+        {{.x = 1, .y = 1}, {Player {}}},
+        {{.x = 3, .y = 2}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  Reachability reach {st};
+  const auto   step = [&](std::initializer_list<Direction> dirs) {
+    for (const Direction dir : dirs) {
+      const Position<> from = st.find_player();
+      ASSERT_EQ(st.step(dir), StepResult::Ok);
+      reach.update(st, from);
+    }
+  };
+
+  // the player walking around doesn't search the level again.
+  const Position<> target {.x = 5, .y = 3};
+  ASSERT_EQ(reach.path(st.find_player(), target)->size(), 6);
+  ASSERT_EQ(reach.searches(), 1);
+  step({Direction::Down, Direction::Down, Direction::Right});
+  ASSERT_EQ(reach.path(st.find_player(), target)->size(), 3);
+  step({Direction::Up});
+  const auto path = reach.path(st.find_player(), target);
+  ASSERT_TRUE(path);
+  ASSERT_EQ(path->size(), 4);
+  ASSERT_EQ(reach.searches(), 1);
+  for (const Direction dir : *path)
+    step({dir});
+  ASSERT_EQ(st.find_player(), target);
+  ASSERT_EQ(reach.path(st.find_player(), target)->size(), 0);
+  ASSERT_EQ(reach.searches(), 1);
+
+  // but a push does.
+  step({Direction::Up, Direction::Left, Direction::Left});
+  ASSERT_EQ(st.find_player(), (Position<> {.x = 3, .y = 2}));
+  ASSERT_EQ(reach.path(st.find_player(), target)->size(), 3);
+  ASSERT_EQ(reach.searches(), 2);
+}
+
+TEST(game, reach_update_open) {
+  // ███████
+  // █     █
+  // █ p☐  █
+  // █     █
+  // ███████
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 5; ++x)
+      tiles.insert({{x, y}, {Floor {}}});
+
+  RawState st = {
+    .goals = {},
+    .tiles = tiles,
+    .objects =
+      {
+        {{.x = 2, .y = 2}, {Player {}}},
+        {{.x = 3, .y = 2}, {Box {}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  // pushing onto reachable cells, which the region goes around,
+  // never floods again.
+  Reachability reach {st};
+  const usize  floods = reach.floods();
+  for (const Direction dir : {Direction::Right, Direction::Right}) {
+    const Position<> from = st.find_player();
+    ASSERT_EQ(st.step(dir), StepResult::Ok);
+    reach.update(st, from);
+    ASSERT_EQ(reach.floods(), floods);
+    ASSERT_EQ(reach.region(), Reachability {st}.region());
+  }
+  expect_region(st, reach);
+}
+
+TEST(game, reach_update) {
+  // a 10x10 room with a wall down the middle, a one-way gap, and a
+  // few boxes to push around.
+  Tiles tiles;
+  for (u16 y = 1; y <= 10; ++y)
+    for (u16 x = 1; x <= 10; ++x) {
+      if (x == 5 && y != 3 && y != 8)
+        continue;
+      if (x == 5 && y == 8)
+        tiles.insert({{x, y}, {DirFloor {.dir = Direction::Right}}});
+      else
+        tiles.insert({{x, y}, {Floor {}}});
+    }
+
+  RawState st = {
+    .goals = {},
+    .tiles = tiles,
+    .objects =
+      {
+        {{.x = 2, .y = 2}, {Player {}}},
+        {{.x = 3, .y = 3}, {Box {}}},
+        {{.x = 4, .y = 6}, {Box {}}},
+        {{.x = 7, .y = 4}, {Box {}}},
+        {{.x = 8, .y = 8}, {DirBox {.dir = Direction::Left}}},
+      },
+    .doors   = {},
+    .portals = {},
+  };
+
+  Reachability reach {st};
+  u32          seed   = 12345;
+  usize        pushes = 0;
+  for (usize i = 0; i < 400; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const Direction dir = DIRECTIONS[(seed >> 16) % 4];
+
+    const Position<> player_from = st.find_player();
+    const auto       before      = boxes_of(st);
+    if (st.step(dir) != StepResult::Ok)
+      continue;
+    const auto after = boxes_of(st);
+    if (before == after)
+      continue;
+
+    // a push: find where the box went
+    Position<> box_to {};
+    for (const auto pos : after)
+      if (!before.contains(pos))
+        box_to = pos;
+    reach.update(player_from, st.find_player(), box_to);
+    ++pushes;
+
+    const Reachability fresh {st};
+    ASSERT_EQ(reach.count(), fresh.count());
+    ASSERT_EQ(reach.region(), fresh.region());
+    ASSERT_EQ(reach.normalized(), fresh.normalized());
+  }
+  ASSERT_GT(pushes, 0);
+  expect_region(st, reach);
+}
+
+} // namespace sbokena::game::reach
@@ -0,0 +1,109 @@
+// threaded simulation tests.
+
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "level.hh"
+#include "loader.hh"
+#include "simulation.hh"
+
+using namespace std::chrono_literals;
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::loader::LevelData;
+
+namespace sbokena::game::simulation {
+
+namespace {
+// ███████
+// █p b. █
+// ███████
+LevelData corridor() {
+  return LevelData {RawLevel {
+    .name    = "corridor",
+    .theme   = "dev",
+    .diff    = Difficulty::Easy,
+    .tiles   = {
+      {{.x = 1, .y = 1}, {Floor {}}},
+      {{.x = 2, .y = 1}, {Floor {}}},
+      {{.x = 3, .y = 1}, {Floor {}}},
+      {{.x = 4, .y = 1}, {Goal {}}},
+      {{.x = 5, .y = 1}, {Floor {}}},
+    },
+    .objects = {
+      {{.x = 1, .y = 1}, {Player {}}},
+      {{.x = 3, .y = 1}, {Box {}}},
+    },
+  }};
+}
+
+// wait for a snapshot to be published for which `done` holds.
+void wait_for(
+  const Simulation &sim, std::function<bool(const Snapshot &)> done
+) {
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (!done(*sim.latest())) {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    std::this_thread::sleep_for(1ms);
+  }
+}
+} // namespace
+
+TEST(game, simulation_steps) {
+  Simulation sim {corridor()};
+
+  {
+    const Simulation::View view = sim.latest();
+    ASSERT_EQ(view->objects.size(), 2);
+    ASSERT_EQ(view->steps, 0);
+    ASSERT_EQ(view->points, 0);
+  }
+
+  // into the wall, which moves nothing, then onto the goal.
+  sim.send(Direction::Left);
+  sim.send(Direction::Right);
+  sim.send(Direction::Right);
+  // ignored, since the level is complete.
+  sim.send(Direction::Right);
+  wait_for(sim, [](const Snapshot &snap) { return snap.complete; });
+
+  const Simulation::View view = sim.latest();
+  ASSERT_EQ(view->steps, 2);
+  // the completing push isn't counted, as in the game.
+  ASSERT_EQ(view->moves, 1);
+  ASSERT_EQ(view->points, 1);
+  ASSERT_EQ(view->facing, Direction::Right);
+  ASSERT_EQ(sim.version(), view->version);
+
+  const Move &walk = view->log[0];
+  ASSERT_EQ(walk.count, 1);
+  ASSERT_EQ(walk.motions[0].to, (Position<> {.x = 2, .y = 1}));
+  const Move &push = view->log[1];
+  ASSERT_EQ(push.count, 2);
+  ASSERT_EQ(push.motions[0].to, (Position<> {.x = 4, .y = 1}));
+  ASSERT_EQ(push.motions[1].to, (Position<> {.x = 3, .y = 1}));
+}
+
+TEST(game, simulation_walk_to) {
+  Simulation sim {corridor()};
+
+  // the box is in the way.
+  sim.send(Position<> {.x = 5, .y = 1});
+  // one step, then a snapshot which shows it.
+  sim.send(Position<> {.x = 2, .y = 1});
+  wait_for(sim, [](const Snapshot &snap) { return snap.steps > 0; });
+
+  const Simulation::View view = sim.latest();
+  ASSERT_EQ(view->steps, 1);
+  ASSERT_EQ(view->moves, 1);
+  ASSERT_FALSE(view->complete);
+  const Position<> player = view->objects.front().first;
+  ASSERT_EQ(player, (Position<> {.x = 2, .y = 1}));
+}
+
+} // namespace sbokena::game::simulation
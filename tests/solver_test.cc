@@ -0,0 +1,83 @@
+// breadth-first solver tests.
+
+#include <stop_token>
+
+#include <gtest/gtest.h>
+
+#include "direction.hh"
+#include "level.hh"
+#include "solver.hh"
+#include "state.hh"
+
+using namespace sbokena::level;
+using sbokena::direction::Direction;
+using sbokena::game::state::RawState;
+using sbokena::game::state::Tiles;
+
+namespace sbokena::game::solver {
+
+// ██████
+// █p   █
+// █ b. █
+// █    █
+// ██████
+RawState room() {
+  Tiles tiles;
+  for (u16 y = 1; y <= 3; ++y)
+    for (u16 x = 1; x <= 4; ++x)
+      tiles.insert({{.x = x, .y = y}, {Floor {}}});
+  tiles.insert_or_assign({.x = 3, .y = 2}, Tile {Goal {}});
+
+  return {
+    .goals   = {{.x = 3, .y = 2}},
+    .tiles   = tiles,
+    .objects = {{{.x = 1, .y = 1}, {Player {}}},
+                {{.x = 2, .y = 2}, {Box {}}}},
+    .doors   = {},
+    .portals = {},
+  };
+}
+
+TEST(game, solver_solvable) {
+  // down, then push right
+  const auto res = solve(room());
+  ASSERT_EQ(res.verdict, Verdict::Solvable);
+  ASSERT_EQ(res.moves, 2);
+}
+
+TEST(game, solver_unsolvable) {
+  // █████
+  // █bp.█
+  // █████
+  const RawState st = {
+    .goals = {{.x = 3, .y = 1}},
+    .tiles =
+      {{{.x = 1, .y = 1}, {Floor {}}},
+       {{.x = 2, .y = 1}, {Floor {}}},
+       {{.x = 3, .y = 1}, {Goal {}}}},
+    .objects = {{{.x = 1, .y = 1}, {Box {}}},
+                {{.x = 2, .y = 1}, {Player {}}}},
+    .doors   = {},
+    .portals = {},
+  };
+
+  const auto res = solve(st);
+  ASSERT_EQ(res.verdict, Verdict::Unsolvable);
+  // the player can only stand on its own cell or the goal
+  ASSERT_EQ(res.nodes, 2);
+}
+
+TEST(game, solver_budget) {
+  const auto res = solve(room(), 1);
+  ASSERT_EQ(res.verdict, Verdict::Unknown);
+}
+
+TEST(game, solver_stop) {
+  std::stop_source source;
+  source.request_stop();
+
+  const auto res = solve(room(), NODE_BUDGET, source.get_token());
+  ASSERT_EQ(res.verdict, Verdict::Unknown);
+}
+
+} // namespace sbokena::game::solver